@@ -0,0 +1,192 @@
+/**
+ * @file crash_journal_main.c
+ * @brief Check that the crash journal names the request that took the process down
+ *
+ * Runs twice with CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL. The first run starts a
+ * copy of the program that sends ping, a tools/call of "echo" and a tools/call
+ * of "crash", whose handler calls abort(). Once the copy has died, the first run
+ * opens the journal file it left behind, reads esp32://system/crash_journal and
+ * checks that the "crash" call is listed as interrupted and the requests before
+ * it completed. Exits with status 1 if any check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "esp_mcp_server.h"
+
+static const char *TAG = "crash_journal";
+
+#if !CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL
+#error "Enable CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL (see sdkconfig.defaults)"
+#endif
+
+// Set in the environment of the copy that crashes
+#define CRASH_RUN_ENV "MCP_CRASH_JOURNAL_RUN"
+
+extern char **environ;
+
+static const char *const REQUESTS[] = {
+    "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"ping\"}",
+    "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/call\","
+    "\"params\":{\"name\":\"echo\",\"arguments\":{\"text\":\"hello\"}}}",
+    "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"tools/call\",\"params\":{\"name\":\"crash\",\"arguments\":{}}}",
+};
+
+static int s_failures;
+
+static cJSON* echo_tool(const cJSON *arguments, void *user_data) {
+    cJSON *result = cJSON_CreateObject();
+    cJSON *content_array = cJSON_CreateArray();
+    cJSON *content = cJSON_CreateObject();
+    cJSON_AddStringToObject(content, "type", "text");
+    cJSON_AddStringToObject(content, "text", cJSON_GetStringValue(cJSON_GetObjectItem(arguments, "text")));
+    cJSON_AddItemToArray(content_array, content);
+    cJSON_AddItemToObject(result, "content", content_array);
+    return result;
+}
+
+static cJSON* crash_tool(const cJSON *arguments, void *user_data) {
+    abort();
+}
+
+static void check(const char *name, bool ok) {
+    printf("%-32s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) {
+        s_failures++;
+    }
+}
+
+static esp_mcp_server_handle_t create_server(void) {
+    esp_mcp_server_config_t config = ESP_MCP_SERVER_DEFAULT_CONFIG();
+    config.telemetry_interval_ms = 0;
+
+    esp_mcp_server_handle_t server;
+    ESP_ERROR_CHECK(esp_mcp_server_init(&config, &server));
+    const esp_mcp_tool_config_t tools[] = {
+        { .name = "echo", .description = "Return the text argument", .handler = echo_tool },
+        { .name = "crash", .description = "Abort the process", .handler = crash_tool },
+    };
+    for (size_t i = 0; i < sizeof(tools) / sizeof(tools[0]); i++) {
+        ESP_ERROR_CHECK(esp_mcp_server_register_tool(server, &tools[i]));
+    }
+    return server;
+}
+
+// The copy that crashes: requests go straight to dispatch, like a custom transport would send them
+static void crash_run(void) {
+    esp_mcp_server_handle_t server = create_server();
+    for (size_t i = 0; i < sizeof(REQUESTS) / sizeof(REQUESTS[0]); i++) {
+        char *response = NULL;
+        esp_mcp_server_handle_request(server, REQUESTS[i], strlen(REQUESTS[i]), &response);
+        cJSON_free(response);
+    }
+    // Not reached: the last request aborts
+    ESP_LOGE(TAG, "The crash tool returned");
+    exit(1);
+}
+
+// Start the copy that crashes and wait for it to die of SIGABRT
+static bool run_crashing_copy(void) {
+    setenv(CRASH_RUN_ENV, "1", 1);
+    char *argv[] = { "crash_journal", NULL };
+    pid_t pid;
+    int err = posix_spawn(&pid, "/proc/self/exe", NULL, NULL, argv, environ);
+    unsetenv(CRASH_RUN_ENV);
+    if (err != 0) {
+        ESP_LOGE(TAG, "Failed to start the crashing run: %d", err);
+        return false;
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+
+// Read the journal resource and return its parsed text, NULL on failure
+static cJSON* read_journal(esp_mcp_server_handle_t server) {
+    static const char request[] = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"resources/read\","
+                                  "\"params\":{\"uri\":\"esp32://system/crash_journal\"}}";
+    char *response = NULL;
+    if (esp_mcp_server_handle_request(server, request, sizeof(request) - 1, &response) != ESP_OK || !response) {
+        return NULL;
+    }
+    cJSON *root = cJSON_Parse(response);
+    cJSON_free(response);
+    cJSON *contents = cJSON_GetObjectItem(cJSON_GetObjectItem(root, "result"), "contents");
+    const char *text = cJSON_GetStringValue(cJSON_GetObjectItem(cJSON_GetArrayItem(contents, 0), "text"));
+    cJSON *journal = text ? cJSON_Parse(text) : NULL;
+    cJSON_Delete(root);
+    return journal;
+}
+
+static void check_journal(const cJSON *journal) {
+    cJSON *boot = cJSON_GetObjectItem(journal, "boot");
+    check("journal kept across the crash", cJSON_IsNumber(boot) && boot->valueint == 2);
+
+    // Entries are oldest first. The crashed run is boot 1; this read is journaled as boot 2, still in progress
+    int count = 0;
+    bool earlier_completed = true;
+    const cJSON *last = NULL;
+    const cJSON *entry;
+    cJSON_ArrayForEach(entry, cJSON_GetObjectItem(journal, "entries")) {
+        cJSON *entry_boot = cJSON_GetObjectItem(entry, "boot");
+        if (!cJSON_IsNumber(entry_boot) || entry_boot->valueint != 1) {
+            continue;
+        }
+        if (last) {
+            cJSON *status = cJSON_GetObjectItem(last, "status");
+            earlier_completed = earlier_completed && cJSON_IsNumber(status) && status->valueint == 200;
+        }
+        last = entry;
+        count++;
+    }
+    check("all requests journaled", count == (int)(sizeof(REQUESTS) / sizeof(REQUESTS[0])));
+    check("earlier requests completed", count > 1 && earlier_completed);
+
+    const char *tool = cJSON_GetStringValue(cJSON_GetObjectItem(last, "tool"));
+    const char *outcome = cJSON_GetStringValue(cJSON_GetObjectItem(last, "outcome"));
+    check("crash call is interrupted", tool && strcmp(tool, "crash") == 0 &&
+                                       outcome && strcmp(outcome, "interrupted") == 0);
+}
+
+void app_main(void) {
+    if (getenv(CRASH_RUN_ENV)) {
+        crash_run();
+    }
+
+    // Start from an empty journal, so a file left by an earlier run does not count
+    if (unlink(CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL_FILE) < 0 && errno != ENOENT) {
+        ESP_LOGE(TAG, "Failed to remove %s: %d", CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL_FILE, errno);
+        exit(1);
+    }
+    check("tool call aborted the process", run_crashing_copy());
+
+    // Opening the server maps the journal file the crashed run left behind
+    esp_mcp_server_handle_t server = create_server();
+    cJSON *journal = read_journal(server);
+    if (journal) {
+        char *text = cJSON_PrintUnformatted(journal);
+        printf("%s\n", text ? text : "");
+        cJSON_free(text);
+    }
+    check("journal resource readable", journal != NULL);
+    check_journal(journal);
+    cJSON_Delete(journal);
+    esp_mcp_server_deinit(server);
+
+    printf("%s\n", s_failures == 0 ? "PASS" : "FAIL");
+    exit(s_failures == 0 ? 0 : 1);
+}
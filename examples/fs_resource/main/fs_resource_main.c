@@ -0,0 +1,70 @@
+/**
+ * @file fs_resource_main.c
+ * @brief Serve a host directory through the filesystem resource provider over stdio
+ *
+ * Reads one JSON-RPC message per line from stdin and writes each response as
+ * one line to stdout, so the provider can be tried against a host directory
+ * before the same code runs on a LittleFS, FATFS or SPIFFS mount:
+ *
+ *   MCP_FS_ROOT=/path/to/dir ./build/mcp_example_fs_resource.elf
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_mcp_server.h"
+
+static const char *TAG = "mcp_fs_resource";
+
+void app_main(void) {
+    const char *root = getenv("MCP_FS_ROOT") ? getenv("MCP_FS_ROOT") : ".";
+
+    // stdout carries the protocol
+    esp_log_level_set("*", ESP_LOG_NONE);
+
+    esp_mcp_server_config_t config = ESP_MCP_SERVER_DEFAULT_CONFIG();
+    config.telemetry_interval_ms = 0;
+
+    // The server is never started: requests go straight to the dispatch
+    esp_mcp_server_handle_t server;
+    ESP_ERROR_CHECK(esp_mcp_server_init(&config, &server));
+
+    esp_mcp_fs_resource_config_t fs_config = {
+        .base_path = root,
+        .name = "files",
+        .description = "Files of the served directory",
+    };
+    esp_err_t ret = esp_mcp_server_register_fs_resource(server, &fs_config);
+    if (ret != ESP_OK) {
+        fprintf(stderr, "%s: cannot serve '%s': %s\n", TAG, root, esp_err_to_name(ret));
+        exit(1);
+    }
+
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t len;
+    while ((len = getline(&line, &size, stdin)) > 0) {
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+            line[--len] = '\0';
+        }
+        if (len == 0) {
+            continue;
+        }
+
+        char *response = NULL;
+        if (esp_mcp_server_handle_request(server, line, len, &response) != ESP_OK) {
+            fprintf(stderr, "%s: invalid request\n", TAG);
+            continue;
+        }
+        if (response) {
+            printf("%s\n", response);
+            fflush(stdout);
+            cJSON_free(response);
+        }
+    }
+    free(line);
+
+    esp_mcp_server_deinit(server);
+    exit(0);
+}
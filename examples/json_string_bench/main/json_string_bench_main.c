@@ -0,0 +1,98 @@
+/**
+ * @file json_string_bench_main.c
+ * @brief Throughput of JSON string escaping and unescaping
+ *
+ * Escapes prose-like text of 64 B, 1 KB, 16 KB and 64 KB with esp_mcp_json_escape()
+ * and decodes the result again with esp_mcp_json_unescape(), then prints MB/s of
+ * input text for the target the example was built for.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_mcp_server.h"
+
+static const char *TAG = "json_string_bench";
+
+#define MAX_TEXT_SIZE (64 * 1024)
+// Every size processes the same number of bytes, so small inputs run many rounds
+#define BYTES_PER_RUN (2 * 1024 * 1024)
+
+static const size_t SIZES[] = { 64, 1024, 16 * 1024, 64 * 1024 };
+
+// Text with a newline every 64 bytes and a quoted word now and then, like a tool's log output
+static void fill_text(char *text, size_t len) {
+    static const char words[] = "the quick brown fox jumps over the lazy dog ";
+    for (size_t i = 0; i < len; i++) {
+        if (i % 64 == 63) {
+            text[i] = '\n';
+        } else if (i % 200 == 10 || i % 200 == 16) {
+            text[i] = '"';
+        } else {
+            text[i] = words[i % (sizeof(words) - 1)];
+        }
+    }
+}
+
+// Bytes per microsecond is MB/s
+static double mb_per_s(size_t size, int rounds, int64_t elapsed_us) {
+    return (double)size * rounds / (double)(elapsed_us > 0 ? elapsed_us : 1);
+}
+
+static void run(size_t size, const char *text, char *escaped, size_t escaped_size, char *decoded) {
+    int rounds = BYTES_PER_RUN / size;
+
+    // Warm the caches once before timing, and check the round trip
+    size_t escaped_len = esp_mcp_json_escape(text, size, escaped, escaped_size);
+    size_t decoded_len = 0;
+    if (escaped_len >= escaped_size ||
+        esp_mcp_json_unescape(escaped, escaped_len, decoded, &decoded_len) != ESP_OK ||
+        decoded_len != size || memcmp(decoded, text, size) != 0) {
+        ESP_LOGE(TAG, "Round trip of %u bytes failed", (unsigned)size);
+        return;
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < rounds; i++) {
+        esp_mcp_json_escape(text, size, escaped, escaped_size);
+    }
+    double escape_mb_per_s = mb_per_s(size, rounds, esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < rounds; i++) {
+        esp_mcp_json_unescape(escaped, escaped_len, decoded, &decoded_len);
+    }
+    double unescape_mb_per_s = mb_per_s(size, rounds, esp_timer_get_time() - start);
+
+    printf("%-10s %8u %14.2f %14.2f\n", CONFIG_IDF_TARGET, (unsigned)size, escape_mb_per_s, unescape_mb_per_s);
+}
+
+void app_main(void) {
+    char *text = malloc(MAX_TEXT_SIZE);
+    if (text) {
+        fill_text(text, MAX_TEXT_SIZE);
+    }
+    // Sized for the escaped text rather than the worst case, to fit small heaps
+    size_t escaped_size = text ? esp_mcp_json_escape(text, MAX_TEXT_SIZE, NULL, 0) + 1 : 0;
+    char *escaped = malloc(escaped_size);
+    char *decoded = malloc(MAX_TEXT_SIZE);
+    if (!text || !escaped || !decoded) {
+        ESP_LOGE(TAG, "Out of memory");
+        free(text);
+        free(escaped);
+        free(decoded);
+        return;
+    }
+
+    printf("%-10s %8s %14s %14s\n", "target", "bytes", "escape MB/s", "unescape MB/s");
+    for (size_t i = 0; i < sizeof(SIZES) / sizeof(SIZES[0]); i++) {
+        run(SIZES[i], text, escaped, escaped_size, decoded);
+    }
+
+    free(text);
+    free(escaped);
+    free(decoded);
+}
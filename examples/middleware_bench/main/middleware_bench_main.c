@@ -0,0 +1,123 @@
+/**
+ * @file middleware_bench_main.c
+ * @brief Dispatch overhead of the middleware chain
+ *
+ * Dispatches ping and a trivial tools/call through esp_mcp_server_handle_request()
+ * on servers with 0, 1, 4 and 8 no-op middleware entries (each with a pre- and a
+ * post-dispatch hook), then prints the time per request and the overhead per hook
+ * relative to the server without middleware.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "cJSON.h"
+#include "esp_mcp_server.h"
+
+static const char *TAG = "middleware_bench";
+
+#define ROUNDS 1000
+#define BATCHES 5
+
+static const char PING[] = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"ping\"}";
+static const char CALL[] = "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/call\","
+                           "\"params\":{\"name\":\"noop\",\"arguments\":{}}}";
+
+static cJSON* noop_tool(const cJSON *arguments, void *user_data) {
+    cJSON *result = cJSON_CreateObject();
+    cJSON *content_array = cJSON_CreateArray();
+    cJSON *content = cJSON_CreateObject();
+    cJSON_AddStringToObject(content, "type", "text");
+    cJSON_AddStringToObject(content, "text", "ok");
+    cJSON_AddItemToArray(content_array, content);
+    cJSON_AddItemToObject(result, "content", content_array);
+    return result;
+}
+
+static esp_err_t noop_pre(const esp_mcp_request_info_t *info, esp_mcp_hook_response_t *response, void *user_data) {
+    return ESP_OK;
+}
+
+static void noop_post(const esp_mcp_request_info_t *info, void *user_data) {
+}
+
+// Microseconds per request in the fastest of BATCHES batches, or a negative value if dispatch failed
+static double time_request(esp_mcp_server_handle_t server, const char *request) {
+    size_t len = strlen(request);
+    char *response = NULL;
+
+    // Warm up once before timing
+    if (esp_mcp_server_handle_request(server, request, len, &response) != ESP_OK) {
+        return -1;
+    }
+    cJSON_free(response);
+
+    int64_t best_us = INT64_MAX;
+    for (int batch = 0; batch < BATCHES; batch++) {
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < ROUNDS; i++) {
+            esp_mcp_server_handle_request(server, request, len, &response);
+            cJSON_free(response);
+        }
+        int64_t elapsed_us = esp_timer_get_time() - start;
+        if (elapsed_us < best_us) {
+            best_us = elapsed_us;
+        }
+    }
+    return (double)best_us / ROUNDS;
+}
+
+static esp_err_t run(int hooks, double baseline[2]) {
+    esp_mcp_server_config_t config = ESP_MCP_SERVER_DEFAULT_CONFIG();
+    esp_mcp_server_handle_t server;
+    esp_err_t ret = esp_mcp_server_init(&config, &server);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    esp_mcp_tool_config_t tool = {
+        .name = "noop",
+        .description = "Returns immediately",
+        .handler = noop_tool,
+    };
+    ret = esp_mcp_server_register_tool(server, &tool);
+
+    const esp_mcp_middleware_t middleware = { .pre = noop_pre, .post = noop_post };
+    for (int i = 0; i < hooks && ret == ESP_OK; i++) {
+        ret = esp_mcp_server_register_middleware(server, &middleware);
+    }
+
+    if (ret == ESP_OK) {
+        double us[2] = { time_request(server, PING), time_request(server, CALL) };
+        if (hooks == 0) {
+            baseline[0] = us[0];
+            baseline[1] = us[1];
+        }
+        printf("%-10s %5d %12.2f %12.2f", CONFIG_IDF_TARGET, hooks, us[0], us[1]);
+        if (hooks > 0) {
+            printf(" %14.3f %14.3f", (us[0] - baseline[0]) / hooks, (us[1] - baseline[1]) / hooks);
+        }
+        printf("\n");
+    }
+    esp_mcp_server_deinit(server);
+    return ret;
+}
+
+void app_main(void) {
+    // Per-request log lines would dominate the timings
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    static const int hook_counts[] = { 0, 1, 4, 8 };
+    double baseline[2] = { 0 };
+    printf("%-10s %5s %12s %12s %14s %14s\n", "target", "hooks", "ping us", "call us", "ping us/hook", "call us/hook");
+    for (size_t i = 0; i < sizeof(hook_counts) / sizeof(hook_counts[0]); i++) {
+        esp_err_t ret = run(hook_counts[i], baseline);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "%d hooks: %s", hook_counts[i], esp_err_to_name(ret));
+            return;
+        }
+    }
+}
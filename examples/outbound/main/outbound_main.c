@@ -0,0 +1,313 @@
+/**
+ * @file outbound_main.c
+ * @brief Server-initiated requests against a stand-in client
+ *
+ * Starts the server on the httpd transport and plays the MCP client over
+ * loopback: it opens the GET /mcp event stream, reads each request the server
+ * sends with esp_mcp_server_send_request() and POSTs a response to /mcp. Checks
+ * that a reply completes the request, that an unanswered request times out, and
+ * that a response with a mismatched id or from another client address leaves
+ * the request waiting. Exits with status 1 if any check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "esp_mcp_server.h"
+
+static const char *TAG = "outbound";
+
+#define PORT 8790
+#define REQUEST_TIMEOUT_MS 1000
+// Timeouts are swept every 100 ms
+#define CALLBACK_WAIT_MS (REQUEST_TIMEOUT_MS + 1000)
+
+// Outcome of one server-initiated request, filled in by its completion callback
+typedef struct {
+    SemaphoreHandle_t done;
+    esp_err_t status;
+    bool has_roots;
+} outcome_t;
+
+// Client side of the GET /mcp stream: raw socket bytes and the decoded chunked body, both NUL-terminated
+typedef struct {
+    int fd;
+    char raw[1024];
+    size_t raw_len;
+    char body[2048];
+    size_t body_len;
+} event_stream_t;
+
+static int s_failures;
+
+static void on_response(esp_err_t status, const cJSON *result, const cJSON *error, void *user_data) {
+    outcome_t *outcome = (outcome_t *)user_data;
+    outcome->status = status;
+    outcome->has_roots = cJSON_IsArray(cJSON_GetObjectItem(result, "roots"));
+    xSemaphoreGive(outcome->done);
+}
+
+static void check(const char *name, bool ok) {
+    printf("%-28s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) {
+        s_failures++;
+    }
+}
+
+// Connect to the server, from local_addr if it is not NULL
+static int connect_server(const char *local_addr) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct timeval timeout = { .tv_sec = 5 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    if (local_addr) {
+        struct sockaddr_in local = { .sin_family = AF_INET };
+        inet_pton(AF_INET, local_addr, &local.sin_addr);
+        if (bind(fd, (struct sockaddr *)&local, sizeof(local)) < 0) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool send_text(int fd, const char *text) {
+    size_t len = strlen(text);
+    for (size_t sent = 0; sent < len;) {
+        ssize_t n = send(fd, text + sent, len - sent, 0);
+        if (n < 0 && errno != EINTR) {
+            return false;
+        }
+        sent += n > 0 ? n : 0;
+    }
+    return true;
+}
+
+static bool recv_more(event_stream_t *s) {
+    while (true) {
+        ssize_t n = recv(s->fd, s->raw + s->raw_len, sizeof(s->raw) - 1 - s->raw_len, 0);
+        if (n > 0) {
+            s->raw_len += n;
+            s->raw[s->raw_len] = '\0';
+            return true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        return false;
+    }
+}
+
+static void drop_raw(event_stream_t *s, size_t len) {
+    memmove(s->raw, s->raw + len, s->raw_len - len + 1);
+    s->raw_len -= len;
+}
+
+// Move the next chunk of the chunked response body from raw to body
+static bool read_chunk(event_stream_t *s) {
+    char *eol;
+    while (!(eol = memchr(s->raw, '\n', s->raw_len))) {
+        if (!recv_more(s)) {
+            return false;
+        }
+    }
+    size_t size = strtoul(s->raw, NULL, 16);
+    drop_raw(s, eol + 1 - s->raw);
+    if (size == 0 || size + 2 >= sizeof(s->raw) || s->body_len + size >= sizeof(s->body)) {
+        return false;
+    }
+    while (s->raw_len < size + 2) {
+        if (!recv_more(s)) {
+            return false;
+        }
+    }
+    memcpy(s->body + s->body_len, s->raw, size);
+    s->body_len += size;
+    s->body[s->body_len] = '\0';
+    drop_raw(s, size + 2);
+    return true;
+}
+
+/**
+ * @brief Read the next server-sent event
+ *
+ * @return The event's data (valid until the next call), "" for a comment, or NULL if the stream failed
+ */
+static const char *read_event(event_stream_t *s) {
+    static char data[1024];
+    char *end;
+    while (!(end = strstr(s->body, "\n\n"))) {
+        if (!read_chunk(s)) {
+            return NULL;
+        }
+    }
+    *end = '\0';
+    const char *field = strstr(s->body, "data: ");
+    snprintf(data, sizeof(data), "%s", field ? field + 6 : "");
+
+    size_t used = end + 2 - s->body;
+    memmove(s->body, s->body + used, s->body_len - used + 1);
+    s->body_len -= used;
+    return data;
+}
+
+static bool open_event_stream(event_stream_t *s) {
+    memset(s, 0, sizeof(*s));
+    s->fd = connect_server(NULL);
+    if (s->fd < 0 || !send_text(s->fd, "GET /mcp HTTP/1.1\r\n"
+                                         "Host: localhost\r\n"
+                                         "Accept: text/event-stream\r\n"
+                                         "\r\n")) {
+        return false;
+    }
+
+    // Skip the response header, then wait for the ": stream open" comment
+    char *header_end;
+    while (!(header_end = strstr(s->raw, "\r\n\r\n"))) {
+        if (!recv_more(s)) {
+            return false;
+        }
+    }
+    if (strncmp(s->raw, "HTTP/1.1 200", 12) != 0) {
+        return false;
+    }
+    drop_raw(s, header_end + 4 - s->raw);
+    const char *opened = read_event(s);
+    return opened && opened[0] == '\0';
+}
+
+// Read the next request from the stream and return its id, or -1
+static int next_request_id(event_stream_t *s, const char *expected_method) {
+    const char *data = read_event(s);
+    cJSON *request = data ? cJSON_Parse(data) : NULL;
+    cJSON *method = cJSON_GetObjectItem(request, "method");
+    cJSON *id = cJSON_GetObjectItem(request, "id");
+    int value = cJSON_IsString(method) && strcmp(method->valuestring, expected_method) == 0 &&
+                cJSON_IsNumber(id) ? id->valueint : -1;
+    cJSON_Delete(request);
+    return value;
+}
+
+/**
+ * @brief POST a roots/list result to /mcp on a new connection
+ *
+ * @return true if the server acknowledged it with 200 OK
+ */
+static bool post_response(int id, const char *local_addr) {
+    int fd = connect_server(local_addr);
+    if (fd < 0) {
+        return false;
+    }
+    char body[96];
+    snprintf(body, sizeof(body), "{\"jsonrpc\":\"2.0\",\"id\":%d,\"result\":{\"roots\":[]}}", id);
+    char request[256];
+    snprintf(request, sizeof(request),
+             "POST /mcp HTTP/1.1\r\n"
+             "Host: localhost\r\n"
+             "Content-Type: application/json\r\n"
+             "Content-Length: %u\r\n"
+             "Connection: close\r\n"
+             "\r\n"
+             "%s", (unsigned)strlen(body), body);
+
+    char status[16] = { 0 };
+    bool ok = send_text(fd, request) && recv(fd, status, sizeof(status) - 1, MSG_WAITALL) > 0 &&
+              strncmp(status, "HTTP/1.1 200", 12) == 0;
+    close(fd);
+    return ok;
+}
+
+static bool send_roots_list(esp_mcp_server_handle_t server, outcome_t *outcome) {
+    xSemaphoreTake(outcome->done, 0);
+    outcome->status = ESP_FAIL;
+    outcome->has_roots = false;
+    return esp_mcp_server_send_request(server, "roots/list", NULL, REQUEST_TIMEOUT_MS, on_response, outcome) == ESP_OK;
+}
+
+static bool completed_within(outcome_t *outcome, uint32_t ms) {
+    return xSemaphoreTake(outcome->done, pdMS_TO_TICKS(ms)) == pdTRUE;
+}
+
+static void run_checks(esp_mcp_server_handle_t server, event_stream_t *stream, outcome_t *outcome) {
+    // The client answers: the callback gets the result
+    int id = send_roots_list(server, outcome) ? next_request_id(stream, "roots/list") : -1;
+    bool posted = id > 0 && post_response(id, NULL);
+    check("reply completes the request", posted && completed_within(outcome, CALLBACK_WAIT_MS) &&
+                                         outcome->status == ESP_OK && outcome->has_roots);
+
+    // The client stays silent: the request expires
+    id = send_roots_list(server, outcome) ? next_request_id(stream, "roots/list") : -1;
+    check("silence times out", id > 0 && completed_within(outcome, CALLBACK_WAIT_MS) &&
+                               outcome->status == ESP_ERR_TIMEOUT);
+
+    // A response to an id that was never sent is acknowledged and dropped
+    id = send_roots_list(server, outcome) ? next_request_id(stream, "roots/list") : -1;
+    posted = id > 0 && post_response(id + 1000, NULL);
+    check("mismatched id is dropped", posted && !completed_within(outcome, REQUEST_TIMEOUT_MS / 2));
+    check("...and the request times out", completed_within(outcome, CALLBACK_WAIT_MS) &&
+                                           outcome->status == ESP_ERR_TIMEOUT);
+
+    // The right id from another client address is dropped; the stream's client can still answer
+    id = send_roots_list(server, outcome) ? next_request_id(stream, "roots/list") : -1;
+    int other = connect_server("127.0.0.2");
+    if (other < 0) {
+        printf("%-28s skipped (127.0.0.2 unavailable)\n", "other client is dropped");
+    } else {
+        close(other);
+        posted = id > 0 && post_response(id, "127.0.0.2");
+        check("other client is dropped", posted && !completed_within(outcome, REQUEST_TIMEOUT_MS / 4));
+    }
+    posted = id > 0 && post_response(id, NULL);
+    check("stream's client completes", posted && completed_within(outcome, CALLBACK_WAIT_MS) &&
+                                       outcome->status == ESP_OK);
+}
+
+void app_main(void) {
+    esp_mcp_server_config_t config = ESP_MCP_SERVER_DEFAULT_CONFIG();
+    config.port = PORT;
+    config.transport = ESP_MCP_TRANSPORT_HTTPD;
+    config.telemetry_interval_ms = 0;
+
+    esp_mcp_server_handle_t server;
+    ESP_ERROR_CHECK(esp_mcp_server_init(&config, &server));
+    ESP_ERROR_CHECK(esp_mcp_server_start(server));
+
+    static event_stream_t stream;
+    outcome_t outcome = { .done = xSemaphoreCreateBinary() };
+    if (!outcome.done || !open_event_stream(&stream)) {
+        ESP_LOGE(TAG, "Failed to open the event stream: %d", errno);
+        exit(1);
+    }
+
+    run_checks(server, &stream, &outcome);
+
+    close(stream.fd);
+    esp_mcp_server_deinit(server);
+    vSemaphoreDelete(outcome.done);
+
+    printf("%s\n", s_failures == 0 ? "PASS" : "FAIL");
+    exit(s_failures == 0 ? 0 : 1);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file partition_resource_main.c
+ * @brief Serve ranges of a data partition as resources over stdio
+ *
+ * The "assets" partition holds a JSON manifest followed by a block of weights.
+ * On the Linux target the partition emulation backs esp_partition_mmap() with
+ * a file, so the zero-copy read path runs unchanged on the host:
+ *
+ *   ./build/mcp_example_partition_resource.elf
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_mcp_server.h"
+
+static const char *TAG = "mcp_partition_resource";
+
+#define MANIFEST_OFFSET 0
+#define MANIFEST_SIZE 4096
+#define WEIGHTS_OFFSET MANIFEST_SIZE
+#define WEIGHTS_SIZE (64 * 1024)
+
+static const char MANIFEST[] =
+    "{\"model\":\"keyword_spotting\",\"version\":3,\"weights\":{\"offset\":4096,\"size\":65536}}";
+
+// Emulated flash starts erased; write the demo assets the first time
+static esp_err_t provision_assets(const esp_partition_t *assets) {
+    char head[sizeof(MANIFEST)];
+    esp_err_t ret = esp_partition_read(assets, MANIFEST_OFFSET, head, sizeof(head));
+    if (ret != ESP_OK || memcmp(head, MANIFEST, sizeof(MANIFEST)) == 0) {
+        return ret;
+    }
+
+    ret = esp_partition_erase_range(assets, 0, WEIGHTS_OFFSET + WEIGHTS_SIZE);
+    if (ret == ESP_OK) {
+        ret = esp_partition_write(assets, MANIFEST_OFFSET, MANIFEST, sizeof(MANIFEST));
+    }
+    uint8_t block[256];
+    for (size_t offset = 0; ret == ESP_OK && offset < WEIGHTS_SIZE; offset += sizeof(block)) {
+        for (size_t i = 0; i < sizeof(block); i++) {
+            block[i] = (uint8_t)((offset + i) * 31 + 7);
+        }
+        ret = esp_partition_write(assets, WEIGHTS_OFFSET + offset, block, sizeof(block));
+    }
+    return ret;
+}
+
+void app_main(void) {
+    // stdout carries the protocol
+    esp_log_level_set("*", ESP_LOG_NONE);
+
+    const esp_partition_t *assets = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "assets");
+    if (!assets || provision_assets(assets) != ESP_OK) {
+        fprintf(stderr, "%s: cannot prepare the assets partition\n", TAG);
+        exit(1);
+    }
+
+    esp_mcp_server_config_t config = ESP_MCP_SERVER_DEFAULT_CONFIG();
+    config.telemetry_interval_ms = 0;
+
+    // The server is never started: requests go straight to the dispatch
+    esp_mcp_server_handle_t server;
+    ESP_ERROR_CHECK(esp_mcp_server_init(&config, &server));
+
+    esp_mcp_partition_resource_config_t manifest = {
+        .uri = "flash://assets/manifest",
+        .name = "manifest",
+        .description = "Model manifest",
+        .mime_type = "application/json",
+        .partition_label = "assets",
+        .offset = MANIFEST_OFFSET,
+        .size = sizeof(MANIFEST) - 1,
+    };
+    esp_mcp_partition_resource_config_t weights = {
+        .uri = "flash://assets/weights",
+        .name = "weights",
+        .description = "Model weights",
+        .partition_label = "assets",
+        .offset = WEIGHTS_OFFSET,
+        .size = WEIGHTS_SIZE,
+    };
+    ESP_ERROR_CHECK(esp_mcp_server_register_partition_resource(server, &manifest));
+    ESP_ERROR_CHECK(esp_mcp_server_register_partition_resource(server, &weights));
+
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t len;
+    while ((len = getline(&line, &size, stdin)) > 0) {
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+            line[--len] = '\0';
+        }
+        if (len == 0) {
+            continue;
+        }
+
+        char *response = NULL;
+        if (esp_mcp_server_handle_request(server, line, len, &response) != ESP_OK) {
+            fprintf(stderr, "%s: invalid request\n", TAG);
+            continue;
+        }
+        if (response) {
+            printf("%s\n", response);
+            fflush(stdout);
+            cJSON_free(response);
+        }
+    }
+    free(line);
+
+    esp_mcp_server_deinit(server);
+    exit(0);
+}
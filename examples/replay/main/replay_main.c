@@ -0,0 +1,88 @@
+/**
+ * @file replay_main.c
+ * @brief Replay a device traffic capture through the MCP dispatch on the host
+ *
+ * Register the same tools and resources as the firmware that produced the
+ * capture, then run:
+ *
+ *   MCP_CAPTURE=capture.txt [MCP_REPLAY_REALTIME=1] ./build/mcp_example_replay.elf
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_mcp_server.h"
+#include "schema_validator.h"
+
+static const char *TAG = "mcp_replay";
+
+static cJSON* echo_tool_handler(const cJSON *arguments, void *user_data) {
+    cJSON *message = cJSON_GetObjectItem(arguments, "message");
+
+    cJSON *result = cJSON_CreateObject();
+    cJSON *content_array = cJSON_CreateArray();
+    cJSON *content = cJSON_CreateObject();
+    cJSON_AddStringToObject(content, "type", "text");
+
+    char response[256];
+    snprintf(response, sizeof(response), "Tool echo: %s", message->valuestring);
+    cJSON_AddStringToObject(content, "text", response);
+
+    cJSON_AddItemToArray(content_array, content);
+    cJSON_AddItemToObject(result, "content", content_array);
+    return result;
+}
+
+static void register_workload(esp_mcp_server_handle_t server) {
+    cJSON *echo_schema = schema_builder_create_object();
+    schema_builder_add_string(echo_schema, "message", "Message to echo", true);
+
+    esp_mcp_tool_config_t echo_tool = {
+        .name = "echo",
+        .description = "Echo back the provided message",
+        .input_schema = echo_schema,
+        .handler = echo_tool_handler,
+    };
+    ESP_ERROR_CHECK(esp_mcp_server_register_tool(server, &echo_tool));
+}
+
+void app_main(void) {
+    const char *path = getenv("MCP_CAPTURE") ? getenv("MCP_CAPTURE") : "capture.txt";
+    bool realtime = getenv("MCP_REPLAY_REALTIME") != NULL;
+
+    esp_mcp_server_config_t config = ESP_MCP_SERVER_DEFAULT_CONFIG();
+    config.telemetry_interval_ms = 0;
+
+    // The server is never started: requests go straight to the dispatch
+    esp_mcp_server_handle_t server;
+    ESP_ERROR_CHECK(esp_mcp_server_init(&config, &server));
+    register_workload(server);
+
+    esp_mcp_replay_stats_t stats;
+    esp_err_t ret = esp_mcp_server_replay_capture(server, path, realtime, &stats);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Replay of '%s' failed: %s", path, esp_err_to_name(ret));
+        exit(1);
+    }
+
+    printf("requests:       %" PRIu32 "\n", stats.requests);
+    printf("skipped:        %" PRIu32 "\n", stats.skipped);
+    printf("mismatches:     %" PRIu32 "\n", stats.mismatches);
+    printf("total time:     %" PRIu64 " us (device: %" PRIu64 " us)\n", stats.total_us, stats.captured_total_us);
+    printf("slowest:        %" PRIu32 " us\n", stats.max_us);
+    printf("response bytes: %" PRIu64 "\n", stats.response_bytes);
+
+    // Per-method heap usage, available when the allocation profiler is enabled
+    esp_mcp_alloc_profile_entry_t profile[16];
+    size_t count = 0;
+    if (esp_mcp_server_get_alloc_profile(server, profile, 16, &count) == ESP_OK) {
+        for (size_t i = 0; i < count; i++) {
+            printf("%-5s %-24s calls=%" PRIu32 " allocs=%" PRIu32 " bytes=%" PRIu32 " peak=%" PRIu32 "\n",
+                   profile[i].is_tool ? "tool" : "rpc", profile[i].name, profile[i].calls,
+                   profile[i].alloc_count, profile[i].alloc_bytes, profile[i].peak_live_bytes);
+        }
+    }
+    esp_mcp_server_deinit(server);
+    exit(0);
+}
@@ -197,6 +197,30 @@ static cJSON* adc_read_handler(const cJSON *arguments, void *user_data) {
     return result;
 }
 
+/**
+ * @brief ADC sampling tool handler - streams one line per sample
+ */
+static esp_err_t adc_sample_handler(const cJSON *arguments, esp_mcp_content_writer_t *writer, void *user_data) {
+    cJSON *count_item = cJSON_GetObjectItem(arguments, "count");
+    int count = cJSON_IsNumber(count_item) ? count_item->valueint : 100;
+    ESP_LOGI(TAG, "ADC sample tool called, %d samples", count);
+
+    // Each sample is sent as soon as it is read, so the result never has to fit in RAM
+    esp_err_t ret = esp_mcp_content_begin_text(writer);
+    for (int i = 0; i < count && ret == ESP_OK; i++) {
+        int adc_raw = 0;
+        if (adc_oneshot_read(adc_handle, EXAMPLE_ADC_CHANNEL, &adc_raw) != ESP_OK) {
+            return ESP_FAIL;
+        }
+
+        char line[32];
+        int len = snprintf(line, sizeof(line), "%d,%d\n", i, adc_raw);
+        ret = esp_mcp_content_append_text(writer, line, len);
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return ret;
+}
+
 // Custom resource handlers
 
 /**
@@ -313,6 +337,22 @@ static void register_custom_tools_and_resources(void) {
         ESP_LOGE(TAG, "Failed to register ADC read tool: %s", esp_err_to_name(ret));
     }
 
+    cJSON *sample_schema = schema_builder_create_object();
+    schema_builder_add_integer(sample_schema, "count", "Number of samples (optional)", 1, 10000, false);
+
+    esp_mcp_tool_config_t sample_tool = {
+        .name = "adc_sample",
+        .description = "Stream a series of raw ADC samples as CSV",
+        .input_schema = sample_schema,
+        .stream_handler = adc_sample_handler,
+        .user_data = NULL
+    };
+
+    ret = esp_mcp_server_register_tool(mcp_server, &sample_tool);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register ADC sample tool: %s", esp_err_to_name(ret));
+    }
+
     // Register echo resource
     esp_mcp_resource_config_t echo_resource = {
         .uri_template = "echo://{message}",
@@ -328,6 +368,14 @@ static void register_custom_tools_and_resources(void) {
         ESP_LOGE(TAG, "Failed to register echo resource: %s", esp_err_to_name(ret));
     }
 
+    // Suggest values for the echo resource's {message} variable
+    static const char *const echo_messages[] = {"hello", "hello_world", "ping", "status"};
+    ret = esp_mcp_server_register_completion(mcp_server, "echo://{message}", "message",
+                                             echo_messages, sizeof(echo_messages) / sizeof(echo_messages[0]));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register echo completions: %s", esp_err_to_name(ret));
+    }
+
     // Register sensor data resource
     esp_mcp_resource_config_t sensor_resource = {
         .uri_template = "esp32://sensors/data",
@@ -0,0 +1,212 @@
+/**
+ * @file steady_state_main.c
+ * @brief Check that a warmed-up server answers requests without touching the heap
+ *
+ * Starts the server on the lite transport with CONFIG_ESP_MCP_SERVER_STEADY_STATE,
+ * sends ping, tools/list and tools/call over a loopback keep-alive connection,
+ * and counts every malloc, calloc, realloc and free made by any task once the
+ * warm-up rounds are done. Exits with status 1 if a heap call was counted, the
+ * arena_overflows statistic is non-zero or a request failed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "esp_mcp_server.h"
+
+static const char *TAG = "steady_state";
+
+#define PORT 8765
+#define WARMUP_ROUNDS 10
+#define ROUNDS 1000
+
+#if !CONFIG_ESP_MCP_SERVER_STEADY_STATE
+#error "Enable CONFIG_ESP_MCP_SERVER_STEADY_STATE (see sdkconfig.defaults)"
+#endif
+
+// Every heap call in the process goes through these while counting is on
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static volatile bool s_counting;
+static uint32_t s_heap_calls;
+
+static void count_heap_call(void) {
+    if (s_counting) {
+        __atomic_add_fetch(&s_heap_calls, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void *malloc(size_t size) {
+    count_heap_call();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    count_heap_call();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    count_heap_call();
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+    if (ptr) {
+        count_heap_call();
+    }
+    __libc_free(ptr);
+}
+
+static const char *const REQUESTS[] = {
+    "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"ping\"}",
+    "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/list\"}",
+    "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"tools/call\","
+    "\"params\":{\"name\":\"add\",\"arguments\":{\"a\":2,\"b\":40}}}",
+};
+
+static cJSON* add_tool(const cJSON *arguments, void *user_data) {
+    double a = cJSON_GetObjectItem(arguments, "a")->valuedouble;
+    double b = cJSON_GetObjectItem(arguments, "b")->valuedouble;
+
+    cJSON *result = cJSON_CreateObject();
+    cJSON *content_array = cJSON_CreateArray();
+    cJSON *content = cJSON_CreateObject();
+    char text[32];
+    snprintf(text, sizeof(text), "%g", a + b);
+    cJSON_AddStringToObject(content, "type", "text");
+    cJSON_AddStringToObject(content, "text", text);
+    cJSON_AddItemToArray(content_array, content);
+    cJSON_AddItemToObject(result, "content", content_array);
+    return result;
+}
+
+static int connect_server(void) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct timeval timeout = { .tv_sec = 5 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// POST one request on the keep-alive connection and read the whole response into fixed buffers
+static bool post(int fd, const char *body) {
+    static char buf[4096];
+    int len = snprintf(buf, sizeof(buf),
+                       "POST /mcp HTTP/1.1\r\n"
+                       "Content-Type: application/json\r\n"
+                       "Content-Length: %u\r\n"
+                       "\r\n"
+                       "%s", (unsigned)strlen(body), body);
+    for (int sent = 0; sent < len;) {
+        ssize_t n = send(fd, buf + sent, len - sent, 0);
+        if (n < 0 && errno != EINTR) {
+            return false;
+        }
+        sent += n > 0 ? n : 0;
+    }
+
+    size_t received = 0;
+    const char *body_start = NULL;
+    size_t content_len = 0;
+    while (!body_start || received < (size_t)(body_start - buf) + content_len) {
+        ssize_t n = recv(fd, buf + received, sizeof(buf) - 1 - received, 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        received += n;
+        buf[received] = '\0';
+        if (!body_start && (body_start = strstr(buf, "\r\n\r\n")) != NULL) {
+            body_start += 4;
+            const char *length = strstr(buf, "Content-Length: ");
+            content_len = length ? strtoul(length + 16, NULL, 10) : 0;
+        }
+        if (received == sizeof(buf) - 1) {
+            return false;
+        }
+    }
+    return strncmp(buf, "HTTP/1.1 200", 12) == 0 && !strstr(body_start, "\"error\"");
+}
+
+void app_main(void) {
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    esp_mcp_server_config_t config = ESP_MCP_SERVER_DEFAULT_CONFIG();
+    config.port = PORT;
+    config.transport = ESP_MCP_TRANSPORT_LITE;
+    config.lite_worker_count = 1;
+    // The telemetry task samples on its own schedule; leave it out of the count
+    config.telemetry_interval_ms = 0;
+
+    esp_mcp_server_handle_t server;
+    ESP_ERROR_CHECK(esp_mcp_server_init(&config, &server));
+    esp_mcp_tool_config_t tool = {
+        .name = "add",
+        .description = "Add two numbers",
+        .handler = add_tool,
+    };
+    ESP_ERROR_CHECK(esp_mcp_server_register_tool(server, &tool));
+    ESP_ERROR_CHECK(esp_mcp_server_start(server));
+
+    int fd = connect_server();
+    if (fd < 0) {
+        ESP_LOGE(TAG, "Failed to connect to port %d: %d", PORT, errno);
+        exit(1);
+    }
+
+    uint32_t failed = 0;
+    const size_t request_count = sizeof(REQUESTS) / sizeof(REQUESTS[0]);
+    for (int round = 0; round < WARMUP_ROUNDS + ROUNDS; round++) {
+        s_counting = round >= WARMUP_ROUNDS;
+        for (size_t i = 0; i < request_count; i++) {
+            if (!post(fd, REQUESTS[i])) {
+                failed++;
+            }
+        }
+    }
+    s_counting = false;
+    close(fd);
+
+    esp_mcp_server_stats_t stats;
+    ESP_ERROR_CHECK(esp_mcp_server_get_detailed_stats(server, &stats));
+    esp_mcp_server_stop(server);
+    esp_mcp_server_deinit(server);
+
+    printf("requests:        %u\n", (unsigned)(ROUNDS * request_count));
+    printf("failed:          %" PRIu32 "\n", failed);
+    printf("heap calls:      %" PRIu32 "\n", s_heap_calls);
+    printf("arena overflows: %" PRIu32 "\n", stats.arena_overflows);
+    printf("arena high water: %" PRIu32 " bytes\n", stats.arena_high_water);
+
+    bool ok = failed == 0 && s_heap_calls == 0 && stats.arena_overflows == 0;
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    exit(ok ? 0 : 1);
+}
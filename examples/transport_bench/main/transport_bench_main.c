@@ -0,0 +1,193 @@
+/**
+ * @file transport_bench_main.c
+ * @brief Requests per second and latency of the httpd and lite transports
+ *
+ * Serves the same server (one trivial tool) over ESP_MCP_TRANSPORT_HTTPD and then
+ * ESP_MCP_TRANSPORT_LITE, and drives each with a client loop that POSTs ping and
+ * tools/call on one loopback keep-alive connection. Prints requests per second
+ * and the median, 99th percentile and worst request latency per transport.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "cJSON.h"
+#include "esp_mcp_server.h"
+
+static const char *TAG = "transport_bench";
+
+#define WARMUP_REQUESTS 100
+#define REQUESTS 5000
+
+static const char PING[] = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"ping\"}";
+static const char CALL[] = "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/call\","
+                           "\"params\":{\"name\":\"noop\",\"arguments\":{}}}";
+
+static uint32_t s_latency_us[REQUESTS];
+
+static cJSON* noop_tool(const cJSON *arguments, void *user_data) {
+    cJSON *result = cJSON_CreateObject();
+    cJSON *content_array = cJSON_CreateArray();
+    cJSON *content = cJSON_CreateObject();
+    cJSON_AddStringToObject(content, "type", "text");
+    cJSON_AddStringToObject(content, "text", "ok");
+    cJSON_AddItemToArray(content_array, content);
+    cJSON_AddItemToObject(result, "content", content_array);
+    return result;
+}
+
+static int connect_server(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct timeval timeout = { .tv_sec = 5 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// POST one request on the keep-alive connection and read the whole response
+static bool post(int fd, const char *body) {
+    static char buf[2048];
+    int len = snprintf(buf, sizeof(buf),
+                       "POST /mcp HTTP/1.1\r\n"
+                       "Host: localhost\r\n"
+                       "Content-Type: application/json\r\n"
+                       "Content-Length: %u\r\n"
+                       "\r\n"
+                       "%s", (unsigned)strlen(body), body);
+    for (int sent = 0; sent < len;) {
+        ssize_t n = send(fd, buf + sent, len - sent, 0);
+        if (n < 0 && errno != EINTR) {
+            return false;
+        }
+        sent += n > 0 ? n : 0;
+    }
+
+    size_t received = 0;
+    const char *body_start = NULL;
+    size_t content_len = 0;
+    while (!body_start || received < (size_t)(body_start - buf) + content_len) {
+        ssize_t n = recv(fd, buf + received, sizeof(buf) - 1 - received, 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        received += n;
+        buf[received] = '\0';
+        if (!body_start && (body_start = strstr(buf, "\r\n\r\n")) != NULL) {
+            body_start += 4;
+            const char *length = strstr(buf, "Content-Length: ");
+            content_len = length ? strtoul(length + 16, NULL, 10) : 0;
+        }
+        if (received == sizeof(buf) - 1) {
+            return false;
+        }
+    }
+    return strncmp(buf, "HTTP/1.1 200", 12) == 0;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static esp_err_t run(const char *name, esp_mcp_transport_t transport, uint16_t port) {
+    esp_mcp_server_config_t config = ESP_MCP_SERVER_DEFAULT_CONFIG();
+    config.port = port;
+    config.transport = transport;
+    config.telemetry_interval_ms = 0;
+
+    esp_mcp_server_handle_t server;
+    esp_err_t ret = esp_mcp_server_init(&config, &server);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    esp_mcp_tool_config_t tool = {
+        .name = "noop",
+        .description = "Returns immediately",
+        .handler = noop_tool,
+    };
+    ret = esp_mcp_server_register_tool(server, &tool);
+    if (ret == ESP_OK) {
+        ret = esp_mcp_server_start(server);
+    }
+
+    int fd = ret == ESP_OK ? connect_server(port) : -1;
+    if (ret == ESP_OK && fd < 0) {
+        ESP_LOGE(TAG, "%s: failed to connect to port %u: %d", name, port, errno);
+        ret = ESP_FAIL;
+    }
+
+    // Alternate ping and tools/call; the warm-up requests are not recorded
+    for (int i = 0; ret == ESP_OK && i < WARMUP_REQUESTS + REQUESTS; i++) {
+        int64_t start = esp_timer_get_time();
+        if (!post(fd, i % 2 ? CALL : PING)) {
+            ESP_LOGE(TAG, "%s: request %d failed", name, i);
+            ret = ESP_FAIL;
+            break;
+        }
+        if (i >= WARMUP_REQUESTS) {
+            s_latency_us[i - WARMUP_REQUESTS] = (uint32_t)(esp_timer_get_time() - start);
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    esp_mcp_server_deinit(server);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    uint64_t total_us = 0;
+    for (int i = 0; i < REQUESTS; i++) {
+        total_us += s_latency_us[i];
+    }
+    qsort(s_latency_us, REQUESTS, sizeof(s_latency_us[0]), compare_u32);
+    printf("%-10s %-6s %10.0f %10u %10u %10u\n", CONFIG_IDF_TARGET, name,
+           REQUESTS * 1e6 / (double)(total_us ? total_us : 1),
+           (unsigned)s_latency_us[REQUESTS / 2], (unsigned)s_latency_us[REQUESTS * 99 / 100],
+           (unsigned)s_latency_us[REQUESTS - 1]);
+    return ESP_OK;
+}
+
+void app_main(void) {
+    // Per-request log lines would dominate the timings
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    printf("%-10s %-6s %10s %10s %10s %10s\n", "target", "transp", "req/s", "p50 us", "p99 us", "max us");
+    // A port of its own per transport, so the first server's sockets in TIME_WAIT do not matter
+    esp_err_t ret = run("httpd", ESP_MCP_TRANSPORT_HTTPD, 8780);
+    if (ret == ESP_OK) {
+        ret = run("lite", ESP_MCP_TRANSPORT_LITE, 8781);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Benchmark failed: %s", esp_err_to_name(ret));
+        exit(1);
+    }
+}
@@ -40,6 +40,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 #include "cJSON.h"
 #include "schema_validator.h"
@@ -73,6 +74,85 @@ typedef cJSON* (*esp_mcp_tool_handler_t)(const cJSON *arguments, void *user_data
  */
 typedef char* (*esp_mcp_resource_handler_t)(const char *uri, void *user_data);
 
+/**
+ * @brief Writer that streams the content items of a tool result to the client
+ *
+ * Content is sent to the client in chunks while the tool runs, so the size of a
+ * result is bounded by time rather than RAM. Use the esp_mcp_content_* functions
+ * to emit items.
+ */
+typedef struct esp_mcp_content_writer esp_mcp_content_writer_t;
+
+/**
+ * @brief Streaming tool execution callback function
+ *
+ * @param arguments JSON object containing tool arguments
+ * @param writer Writer for the result's content items
+ * @param user_data User data passed during registration
+ * @return ESP_OK on success; any other value marks the result with isError
+ */
+typedef esp_err_t (*esp_mcp_streaming_tool_handler_t)(const cJSON *arguments, esp_mcp_content_writer_t *writer, void *user_data);
+
+/**
+ * @brief Source of the raw bytes of an image or audio content item
+ *
+ * Called repeatedly while the item is streamed, e.g. to copy a camera frame
+ * buffer by buffer or to read a file.
+ *
+ * @param ctx Context passed along with the callback
+ * @param buf Buffer to fill
+ * @param size Capacity of buf in bytes
+ * @return Number of bytes stored in buf, 0 at the end of the data, negative on error
+ */
+typedef int (*esp_mcp_content_read_fn_t)(void *ctx, uint8_t *buf, size_t size);
+
+/**
+ * @brief Receiver of a tool argument delivered in pieces instead of buffered
+ *
+ * See esp_mcp_tool_config_t::stream_argument. A tool's sink serves one call at a
+ * time; the callbacks receive the tool's user_data.
+ */
+typedef struct {
+    esp_err_t (*begin)(void *user_data);                                  ///< Before the first piece of a call's value, e.g. esp_ota_begin() (optional)
+    esp_err_t (*write)(const uint8_t *data, size_t len, void *user_data); ///< Next piece of the value, e.g. esp_ota_write() (required)
+    void (*abort)(void *user_data);                                       ///< The call failed after begin succeeded; the handler will not run (optional)
+} esp_mcp_argument_sink_t;
+
+/**
+ * @brief Length of the base64 encoding of len bytes, excluding the terminating NUL
+ */
+#define ESP_MCP_BASE64_ENCODED_LEN(len) ((((len) + 2) / 3) * 4)
+
+/**
+ * @brief Bearer token verifier callback
+ *
+ * Called only for tokens that are not in the verified-token cache, so it may
+ * perform expensive work such as checking a signature.
+ *
+ * @param token Token from the Authorization header (not NUL-terminated)
+ * @param token_len Token length in bytes
+ * @param valid_for_s Output: seconds the token may be accepted from cache without
+ *                    verifying it again, e.g. until its expiry (0 = do not cache)
+ * @param user_data User data from the server configuration
+ * @return ESP_OK if the token is valid, error code otherwise
+ */
+typedef esp_err_t (*esp_mcp_auth_verifier_t)(const char *token, size_t token_len, uint32_t *valid_for_s, void *user_data);
+
+/**
+ * @brief Completion callback of a server-initiated request
+ *
+ * Called exactly once, from the task that received the response or from the
+ * esp_timer task on timeout; it must not block.
+ *
+ * @param status ESP_OK with a result, ESP_FAIL if the client answered with an error,
+ *               ESP_ERR_TIMEOUT if no response arrived in time, ESP_ERR_INVALID_STATE
+ *               if the client stream was closed or replaced or the server stopped
+ * @param result Result member of the response (valid only during the call)
+ * @param error Error member of the response (valid only during the call)
+ * @param user_data User data passed to esp_mcp_server_send_request()
+ */
+typedef void (*esp_mcp_response_cb_t)(esp_err_t status, const cJSON *result, const cJSON *error, void *user_data);
+
 /**
  * @brief Tool configuration structure
  */
@@ -81,8 +161,15 @@ typedef struct {
     const char *title;                   ///< Tool title (optional)
     const char *description;             ///< Tool description (optional)
     cJSON *input_schema;                 ///< JSON schema for input validation (optional)
-    esp_mcp_tool_handler_t handler;      ///< Tool execution callback (required)
+    esp_mcp_tool_handler_t handler;      ///< Tool execution callback (required unless stream_handler is set)
+    esp_mcp_streaming_tool_handler_t stream_handler; ///< Streaming execution callback, used instead of handler (optional)
     void *user_data;                     ///< User data passed to callback (optional)
+    bool coalesce;                       ///< Read-only tool: concurrent calls with identical arguments share one
+                                         ///< execution and its result when coalesce_reads is set (optional)
+    const char *stream_argument;         ///< String argument written to stream_sink in pieces as the request arrives;
+                                         ///< the handler then runs with it set to "" (optional)
+    bool stream_base64;                  ///< stream_argument is base64 and stream_sink receives the decoded bytes
+    esp_mcp_argument_sink_t stream_sink; ///< Receiver of stream_argument (required with stream_argument)
 } esp_mcp_tool_config_t;
 
 /**
@@ -98,6 +185,158 @@ typedef struct {
     void *user_data;                     ///< User data passed to callback (optional)
 } esp_mcp_resource_config_t;
 
+/**
+ * @brief Filesystem resource provider configuration
+ */
+typedef struct {
+    const char *base_path;               ///< Mounted VFS directory to serve, e.g. "/littlefs" (required)
+    const char *uri_prefix;              ///< URI prefix mapped onto base_path (default: "file:///")
+    const char *name;                    ///< Resource name (default: "files")
+    const char *description;             ///< Resource description (optional)
+    size_t chunk_size;                   ///< File bytes read per chunk while streaming a read (default: 1024)
+} esp_mcp_fs_resource_config_t;
+
+/**
+ * @brief Configuration of a resource served from a flash partition range
+ */
+typedef struct {
+    const char *uri;                     ///< Resource URI, e.g. "flash://model/weights" (required)
+    const char *name;                    ///< Resource name (required)
+    const char *title;                   ///< Resource title (optional)
+    const char *description;             ///< Resource description (optional)
+    const char *mime_type;               ///< MIME type; text types are sent as text, others as a base64 blob (default: "application/octet-stream")
+    const char *partition_label;         ///< Label of the partition holding the data (required)
+    size_t offset;                       ///< Start of the range within the partition
+    size_t size;                         ///< Length of the range (default: the rest of the partition)
+    size_t chunk_size;                   ///< Response bytes sent per chunk while streaming a read (default: 1024)
+} esp_mcp_partition_resource_config_t;
+
+/**
+ * @brief A request as seen by middleware hooks
+ *
+ * Strings point into the request being dispatched and are valid only during the hook.
+ */
+typedef struct {
+    const char *method;                  ///< JSON-RPC method
+    const char *tool;                    ///< params.name of a tools/call, NULL for other methods
+    const char *uri;                     ///< params.uri of a resources/read, NULL for other methods
+    int session;                         ///< Socket of the client connection, -1 for esp_mcp_server_handle_request() and replay
+    size_t request_len;                  ///< Request body length in bytes
+    bool notification;                   ///< The request expects no response
+    // Set for post-dispatch hooks only
+    bool short_circuited;                ///< A pre-dispatch hook answered the request
+    bool streamed;                       ///< The response was streamed to the client; response is NULL
+    const char *response;                ///< JSON-RPC response body (NULL for notifications and streamed responses)
+    size_t response_len;                 ///< Response body length in bytes, including streamed responses
+    int64_t duration_us;                 ///< Time from the first pre-dispatch hook to the end of dispatch
+} esp_mcp_request_info_t;
+
+/**
+ * @brief Answer of a pre-dispatch hook that stops a request
+ */
+typedef struct {
+    int error_code;                      ///< JSON-RPC error code (e.g. -32001), or 0 to answer with result
+    const char *message;                 ///< Error message (default: the name of the hook's return value)
+    cJSON *result;                       ///< Result to answer with when error_code is 0; the server deletes it
+} esp_mcp_hook_response_t;
+
+/**
+ * @brief Pre-dispatch hook
+ *
+ * @param info Request about to be dispatched
+ * @param response Answer to fill in when stopping the request
+ * @param user_data User data of the middleware
+ * @return ESP_OK to pass the request on, any other value to answer it with *response
+ *         instead of dispatching it
+ */
+typedef esp_err_t (*esp_mcp_pre_hook_t)(const esp_mcp_request_info_t *info, esp_mcp_hook_response_t *response,
+                                        void *user_data);
+
+/**
+ * @brief Post-dispatch hook
+ *
+ * @param info Request and its response
+ * @param user_data User data of the middleware
+ */
+typedef void (*esp_mcp_post_hook_t)(const esp_mcp_request_info_t *info, void *user_data);
+
+/**
+ * @brief Middleware run around the dispatch of every JSON-RPC request and notification
+ */
+typedef struct {
+    esp_mcp_pre_hook_t pre;              ///< Runs before dispatch, in registration order (optional)
+    esp_mcp_post_hook_t post;            ///< Runs after dispatch, in reverse registration order (optional)
+    void *user_data;                     ///< User data passed to both hooks (optional)
+} esp_mcp_middleware_t;
+
+/**
+ * @brief HTTP transport serving the /mcp endpoint
+ */
+typedef enum {
+    ESP_MCP_TRANSPORT_HTTPD = 0,         ///< esp_http_server (default)
+    ESP_MCP_TRANSPORT_LITE,              ///< Minimal select()-based HTTP/1.1 server with a worker pool
+} esp_mcp_transport_t;
+
+/**
+ * @brief Detailed server statistics
+ */
+typedef struct {
+    uint16_t active_sessions;            ///< Number of active sessions
+    uint16_t total_tools;                ///< Number of registered tools
+    uint16_t total_resources;            ///< Number of registered resources
+    uint32_t total_requests;             ///< POST requests received on /mcp
+    uint32_t failed_requests;            ///< Requests rejected before dispatch (receive, memory or parse errors)
+    uint32_t tls_handshakes;             ///< TLS sessions established (HTTPS only)
+    uint32_t auth_rejected;              ///< Requests rejected for a missing or invalid bearer token
+    uint32_t arena_overflows;            ///< Request-path allocations that missed the request arenas (CONFIG_ESP_MCP_SERVER_STEADY_STATE)
+    uint32_t arena_high_water;           ///< Most arena bytes used by one request (CONFIG_ESP_MCP_SERVER_STEADY_STATE)
+    uint32_t stack_min_free;             ///< Least free stack a request left on its task, 0 until one is profiled
+                                         ///< (CONFIG_ESP_MCP_SERVER_STACK_PROFILER)
+    uint32_t coalesced_runs;             ///< Coalescable reads and tool calls that ran their handler
+    uint32_t coalesced_shared;           ///< Coalescable reads and tool calls answered from a concurrent identical
+                                         ///< one; the coalescing ratio is shared / (runs + shared)
+} esp_mcp_server_stats_t;
+
+/**
+ * @brief Allocation profile of one JSON-RPC method or tool
+ *
+ * Collected only when CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER is enabled.
+ */
+typedef struct {
+    char name[32];                       ///< Method or tool name
+    bool is_tool;                        ///< true for a tool, false for a JSON-RPC method
+    uint32_t calls;                      ///< Number of profiled calls
+    uint32_t alloc_count;                ///< Total number of allocations
+    uint32_t alloc_bytes;                ///< Total bytes allocated
+    uint32_t peak_live_bytes;            ///< Highest live bytes reached during a single call
+    uint32_t leaked_bytes;               ///< Bytes still live when the request finished, summed over calls
+} esp_mcp_alloc_profile_entry_t;
+
+/**
+ * @brief Stack profile of one JSON-RPC method or tool
+ *
+ * Collected only when CONFIG_ESP_MCP_SERVER_STACK_PROFILER is enabled.
+ */
+typedef struct {
+    char name[32];                       ///< Method or tool name
+    bool is_tool;                        ///< true for a tool, false for a JSON-RPC method
+    uint32_t calls;                      ///< Number of profiled calls
+    uint32_t min_free_bytes;             ///< Least free stack left on the dispatching task by a single call
+} esp_mcp_stack_profile_entry_t;
+
+/**
+ * @brief Result of replaying a traffic capture
+ */
+typedef struct {
+    uint32_t requests;                   ///< Requests replayed
+    uint32_t skipped;                    ///< Records whose body was truncated at capture time
+    uint32_t mismatches;                 ///< Replayed requests whose status or response size differs from the capture
+    uint32_t max_us;                     ///< Slowest replayed request
+    uint64_t total_us;                   ///< Total processing time of the replayed requests
+    uint64_t captured_total_us;          ///< Total processing time of the same requests when they were captured
+    uint64_t response_bytes;             ///< Total size of the replayed responses
+} esp_mcp_replay_stats_t;
+
 /**
  * @brief MCP Server configuration structure
  */
@@ -107,6 +346,29 @@ typedef struct {
     uint32_t session_timeout_ms;         ///< Session timeout in milliseconds (default: 300000)
     const char *server_name;             ///< Server name in capabilities (optional)
     const char *server_version;          ///< Server version in capabilities (optional)
+    uint32_t telemetry_interval_ms;      ///< Built-in telemetry sampling interval, 0 samples on each request; unused
+                                         ///< without CONFIG_ESP_MCP_SERVER_BUILTINS (default: 1000)
+    size_t conn_buffer_max_size;         ///< Largest per-connection receive buffer kept between requests; the lite
+                                         ///< transport also rejects larger bodies (default: 16384)
+    esp_mcp_transport_t transport;       ///< HTTP transport implementation (default: ESP_MCP_TRANSPORT_HTTPD)
+    uint8_t lite_worker_count;           ///< Dispatch worker tasks for ESP_MCP_TRANSPORT_LITE (default: 2)
+    const char *tls_cert_pem;            ///< Server certificate chain (PEM); with tls_key_pem enables HTTPS on `port`.
+                                         ///< Requires CONFIG_ESP_HTTPS_SERVER_ENABLE; must outlive the server (optional)
+    const char *tls_key_pem;             ///< Server private key (PEM), must outlive the server (optional)
+    bool tls_session_tickets;            ///< Resume returning clients from TLS session tickets; requires
+                                         ///< CONFIG_ESP_TLS_SERVER_SESSION_TICKETS (default: true)
+    esp_mcp_auth_verifier_t auth_verifier; ///< Require `Authorization: Bearer` on /mcp POST requests (optional)
+    void *auth_user_data;                ///< User data passed to auth_verifier (optional)
+    uint8_t auth_cache_entries;          ///< Verified tokens remembered to skip re-verification (default: 8)
+    uint8_t max_pending_requests;        ///< Server-initiated requests awaiting a response, 0 disables them (default: 4)
+    uint32_t task_stack_size;            ///< Stack of the tasks that run handlers: the httpd task, or each lite worker.
+                                         ///< 0 keeps the transport's own size: 4096 for HTTP, 10240 for HTTPS,
+                                         ///< 6144 for lite (default: 0)
+    uint32_t lite_listener_stack_size;   ///< Stack of the lite transport's listener task, 0 for 6144 (default: 0)
+    uint32_t telemetry_stack_size;       ///< Stack of the built-in telemetry sampler task, 0 for 3072 (default: 0)
+    bool coalesce_reads;                 ///< Concurrent resources/read requests for the same URI, and calls to
+                                         ///< coalesce tools with identical arguments, share one handler run
+                                         ///< (default: true)
 } esp_mcp_server_config_t;
 
 /**
@@ -117,7 +379,22 @@ typedef struct {
     .max_sessions = 10, \
     .session_timeout_ms = 300000, \
     .server_name = "ESP32 MCP Server", \
-    .server_version = "1.0.0" \
+    .server_version = "1.0.0", \
+    .telemetry_interval_ms = 1000, \
+    .conn_buffer_max_size = 16384, \
+    .transport = ESP_MCP_TRANSPORT_HTTPD, \
+    .lite_worker_count = 2, \
+    .tls_cert_pem = NULL, \
+    .tls_key_pem = NULL, \
+    .tls_session_tickets = true, \
+    .auth_verifier = NULL, \
+    .auth_user_data = NULL, \
+    .auth_cache_entries = 8, \
+    .max_pending_requests = 4, \
+    .task_stack_size = 0, \
+    .lite_listener_stack_size = 0, \
+    .telemetry_stack_size = 0, \
+    .coalesce_reads = true \
 }
 
 /**
@@ -218,7 +495,8 @@ esp_err_t esp_mcp_server_stop(esp_mcp_server_handle_t server_handle);
  *
  * @param server_handle Server handle
  * @param tool_config Tool configuration
- * @return ESP_OK on success, error code otherwise
+ * @return ESP_OK on success, ESP_ERR_NO_MEM once CONFIG_ESP_MCP_SERVER_MAX_TOOLS tools are
+ *         registered, error code otherwise
  */
 esp_err_t esp_mcp_server_register_tool(esp_mcp_server_handle_t server_handle, const esp_mcp_tool_config_t *tool_config);
 
@@ -255,10 +533,112 @@ esp_err_t esp_mcp_server_register_tool(esp_mcp_server_handle_t server_handle, co
  *
  * @param server_handle Server handle
  * @param resource_config Resource configuration
- * @return ESP_OK on success, error code otherwise
+ * @return ESP_OK on success, ESP_ERR_NO_MEM once CONFIG_ESP_MCP_SERVER_MAX_RESOURCES resources
+ *         are registered, error code otherwise
  */
 esp_err_t esp_mcp_server_register_resource(esp_mcp_server_handle_t server_handle, const esp_mcp_resource_config_t *resource_config);
 
+/**
+ * @brief Serve the files of a mounted VFS directory as resources
+ *
+ * The directory is published as the template `<uri_prefix>{+path}`, e.g.
+ * `file:///{+path}`, and read on demand, whatever filesystem is mounted there
+ * (LittleFS, FATFS, SPIFFS, or a host directory on the Linux target):
+ *
+ * - A file is returned as `text` or, for binary types, as a base64 `blob`,
+ *   with its MIME type chosen by extension. Over a streaming transport its
+ *   contents are read and sent chunk_size bytes at a time instead of being
+ *   loaded into memory.
+ * - A directory (including `<uri_prefix>` itself) is returned as a
+ *   `text/uri-list` of the URIs of its entries, read one at a time.
+ *
+ * Paths are percent-decoded and must stay below base_path; URIs containing a
+ * ".." segment are not served.
+ *
+ * @param server_handle Server handle
+ * @param config Provider configuration
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if CONFIG_ESP_MCP_SERVER_FS_RESOURCES is
+ *         disabled, ESP_ERR_NO_MEM once CONFIG_ESP_MCP_SERVER_MAX_RESOURCES resources are
+ *         registered, error code otherwise
+ */
+esp_err_t esp_mcp_server_register_fs_resource(esp_mcp_server_handle_t server_handle,
+                                              const esp_mcp_fs_resource_config_t *config);
+
+/**
+ * @brief Serve a range of a flash partition as a resource
+ *
+ * Each read maps the range with esp_partition_mmap() in windows of up to 64 KB,
+ * unmapping one before mapping the next, and never copies it to the heap when
+ * streamed: over a streaming transport the response is escaped (text types) or
+ * base64-encoded (everything else) from the mapped windows into the response
+ * chunks. Reads through esp_mcp_server_handle_request() build the whole result
+ * in memory.
+ *
+ * The range is checked against the partition table at registration; a read
+ * needs one free MMU page (two where a window crosses a page boundary)
+ * however large the range is.
+ * On the Linux target the partition emulation backs the same calls.
+ *
+ * @param server_handle Server handle
+ * @param config Resource configuration
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if CONFIG_ESP_MCP_SERVER_PARTITION_RESOURCES
+ *         is disabled, ESP_ERR_NOT_FOUND if no partition has the label,
+ *         ESP_ERR_INVALID_SIZE if the range does not fit in the partition, error code otherwise
+ */
+esp_err_t esp_mcp_server_register_partition_resource(esp_mcp_server_handle_t server_handle,
+                                                     const esp_mcp_partition_resource_config_t *config);
+
+/**
+ * @brief Register completion candidates for a resource template variable
+ *
+ * Candidates are served through the MCP `completion/complete` method so that clients
+ * can discover valid values for a template variable before calling `resources/read`.
+ * The values are copied into a sorted prefix index; looking up completions for a
+ * prefix does not allocate. Registering the same variable again replaces its values.
+ *
+ * Example usage:
+ * @code
+ * static const char *const messages[] = {"hello", "help", "world"};
+ * esp_mcp_server_register_completion(server_handle, "echo://{message}", "message",
+ *                                    messages, sizeof(messages) / sizeof(messages[0]));
+ * @endcode
+ *
+ * @param server_handle Server handle
+ * @param uri_template URI template of a registered resource (e.g., "echo://{message}")
+ * @param argument Template variable name without braces (e.g., "message")
+ * @param values Array of candidate values
+ * @param value_count Number of candidate values
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no registered resource template has
+ *         this variable, ESP_ERR_NOT_SUPPORTED if CONFIG_ESP_MCP_SERVER_COMPLETIONS is
+ *         disabled, error code otherwise
+ */
+esp_err_t esp_mcp_server_register_completion(esp_mcp_server_handle_t server_handle,
+                                             const char *uri_template,
+                                             const char *argument,
+                                             const char *const *values,
+                                             size_t value_count);
+
+/**
+ * @brief Add a middleware to the chain run around method dispatch
+ *
+ * Pre-dispatch hooks run in registration order on the task serving the request,
+ * before streaming or dispatch; the first one that does not return ESP_OK answers
+ * the request and the rest are skipped. Post-dispatch hooks then all run, in
+ * reverse order, with the size of the response and whether a hook answered it.
+ * Responses to server-initiated requests do not pass through the chain.
+ *
+ * The chain is fixed once the server starts, so it is read without locking, and
+ * a server with no middleware skips it entirely.
+ *
+ * @param server_handle Server handle
+ * @param middleware Hooks and their user data (copied)
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the server is running,
+ *         ESP_ERR_NO_MEM beyond CONFIG_ESP_MCP_SERVER_MAX_MIDDLEWARE entries,
+ *         ESP_ERR_NOT_SUPPORTED if CONFIG_ESP_MCP_SERVER_MIDDLEWARE is disabled
+ */
+esp_err_t esp_mcp_server_register_middleware(esp_mcp_server_handle_t server_handle,
+                                             const esp_mcp_middleware_t *middleware);
+
 /**
  * @brief Get server statistics
  *
@@ -273,6 +653,270 @@ esp_err_t esp_mcp_server_get_stats(esp_mcp_server_handle_t server_handle,
                                    uint16_t *total_tools,
                                    uint16_t *total_resources);
 
+/**
+ * @brief Get detailed server statistics including request counters
+ *
+ * @param server_handle Server handle
+ * @param stats Output statistics
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_mcp_server_get_detailed_stats(esp_mcp_server_handle_t server_handle, esp_mcp_server_stats_t *stats);
+
+/**
+ * @brief Get per-method and per-tool heap allocation profile
+ *
+ * Allocations made by cJSON and by the server while handling a request are charged
+ * to the request's JSON-RPC method, and allocations made inside a tool handler are
+ * additionally charged to that tool. The same data is served as JSON by the built-in
+ * `esp32://system/alloc_profile` resource.
+ *
+ * @param server_handle Server handle
+ * @param entries Output array of profile entries
+ * @param max_entries Size of the output array
+ * @param entry_count Output for the number of entries written
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER
+ *         is disabled, error code otherwise
+ */
+esp_err_t esp_mcp_server_get_alloc_profile(esp_mcp_server_handle_t server_handle,
+                                           esp_mcp_alloc_profile_entry_t *entries,
+                                           size_t max_entries,
+                                           size_t *entry_count);
+
+/**
+ * @brief Get the worst-case stack usage of each JSON-RPC method and tool
+ *
+ * The free stack of the dispatching task is sampled with
+ * uxTaskGetStackHighWaterMark() after each request and after each tool handler,
+ * and the lowest value seen is kept per method and per tool. Use it to size
+ * task_stack_size: the task needs its current size minus min_free_bytes, plus
+ * some margin. The same data is served as JSON by the built-in
+ * `esp32://system/stack_profile` resource.
+ *
+ * @param server_handle Server handle
+ * @param entries Output array of profile entries
+ * @param max_entries Size of the output array
+ * @param entry_count Output for the number of entries written
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if CONFIG_ESP_MCP_SERVER_STACK_PROFILER
+ *         is disabled, error code otherwise
+ */
+esp_err_t esp_mcp_server_get_stack_profile(esp_mcp_server_handle_t server_handle,
+                                           esp_mcp_stack_profile_entry_t *entries,
+                                           size_t max_entries,
+                                           size_t *entry_count);
+
+/**
+ * @brief Send a request to the client, e.g. sampling/createMessage, roots/list or elicitation/create
+ *
+ * The request is delivered as a server-sent event on the client's `GET /mcp`
+ * stream, and the client POSTs the response back to `/mcp`, where it is routed
+ * to the callback without blocking any task. The request is bound to that
+ * stream: a response POSTed from another client address is dropped and the
+ * request keeps waiting. Requires the httpd transport.
+ *
+ * @param server_handle Server handle
+ * @param method Method name
+ * @param params Parameters (can be NULL; not taken over)
+ * @param timeout_ms Time to wait for the response
+ * @param callback Completion callback
+ * @param user_data User data passed to the callback
+ * @return ESP_OK once the request was sent, ESP_ERR_INVALID_STATE if no client stream is open,
+ *         ESP_ERR_NO_MEM if too many requests are pending, ESP_ERR_NOT_SUPPORTED if
+ *         server-initiated requests are unavailable, error code otherwise
+ */
+esp_err_t esp_mcp_server_send_request(esp_mcp_server_handle_t server_handle, const char *method, const cJSON *params,
+                                      uint32_t timeout_ms, esp_mcp_response_cb_t callback, void *user_data);
+
+/**
+ * @brief Process one JSON-RPC message without a transport
+ *
+ * Runs the same dispatch as the /mcp endpoint, e.g. for custom transports.
+ * Results of streaming tools cannot be returned this way.
+ *
+ * @param server_handle Server handle
+ * @param request JSON-RPC message
+ * @param len Length of the message in bytes
+ * @param response Output JSON response, NULL for notifications (free with cJSON_free)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the message is not valid JSON-RPC,
+ *         error code otherwise
+ */
+esp_err_t esp_mcp_server_handle_request(esp_mcp_server_handle_t server_handle, const char *request, size_t len,
+                                        char **response);
+
+/**
+ * @brief Write the traffic capture to a file
+ *
+ * Requires CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE. The same data is served by the
+ * built-in `esp32://system/traffic_capture` resource.
+ *
+ * @param server_handle Server handle
+ * @param path Output file path (e.g. on SPIFFS, FATFS or the host filesystem)
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if capture is disabled, error code otherwise
+ */
+esp_err_t esp_mcp_server_export_capture(esp_mcp_server_handle_t server_handle, const char *path);
+
+/**
+ * @brief Replay a traffic capture through the server's request dispatch
+ *
+ * Intended for profiling recorded field traffic on a host build (linux target)
+ * with the same tools and resources registered as on the device. Responses are
+ * discarded and replayed requests are not captured again.
+ *
+ * @param server_handle Server handle
+ * @param path Capture file written by esp_mcp_server_export_capture()
+ * @param realtime true to keep the captured request timing, false to replay as fast as possible
+ * @param stats Output replay statistics
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the file cannot be opened,
+ *         ESP_ERR_INVALID_RESPONSE if it is not a capture, error code otherwise
+ */
+esp_err_t esp_mcp_server_replay_capture(esp_mcp_server_handle_t server_handle, const char *path, bool realtime,
+                                        esp_mcp_replay_stats_t *stats);
+
+/**
+ * @brief Emit a complete text content item from a streaming tool
+ *
+ * @param writer Content writer passed to the streaming tool handler
+ * @param text NUL-terminated text
+ * @return ESP_OK on success, ESP_FAIL once the client connection is lost
+ */
+esp_err_t esp_mcp_content_add_text(esp_mcp_content_writer_t *writer, const char *text);
+
+/**
+ * @brief Start a text content item whose text is appended incrementally
+ *
+ * The item is closed by esp_mcp_content_end_text(), by the next item, or when
+ * the handler returns.
+ *
+ * @param writer Content writer passed to the streaming tool handler
+ * @return ESP_OK on success, ESP_FAIL once the client connection is lost
+ */
+esp_err_t esp_mcp_content_begin_text(esp_mcp_content_writer_t *writer);
+
+/**
+ * @brief Append text to the item started with esp_mcp_content_begin_text()
+ *
+ * @param writer Content writer passed to the streaming tool handler
+ * @param data Text to append (need not be NUL-terminated)
+ * @param len Length of data in bytes
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no text item is open,
+ *         ESP_FAIL once the client connection is lost
+ */
+esp_err_t esp_mcp_content_append_text(esp_mcp_content_writer_t *writer, const char *data, size_t len);
+
+/**
+ * @brief Close the text item started with esp_mcp_content_begin_text()
+ *
+ * @param writer Content writer passed to the streaming tool handler
+ * @return ESP_OK on success, ESP_FAIL once the client connection is lost
+ */
+esp_err_t esp_mcp_content_end_text(esp_mcp_content_writer_t *writer);
+
+/**
+ * @brief Emit an arbitrary content item (e.g. an image or resource link)
+ *
+ * @param writer Content writer passed to the streaming tool handler
+ * @param item Content object, serialized immediately and not taken over
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if it could not be serialized,
+ *         ESP_FAIL once the client connection is lost
+ */
+esp_err_t esp_mcp_content_add_item(esp_mcp_content_writer_t *writer, const cJSON *item);
+
+/**
+ * @brief Emit an image content item from raw bytes in memory
+ *
+ * The bytes are base64-encoded straight into the response stream, so no encoded
+ * copy of the image is ever held in RAM.
+ *
+ * @param writer Content writer passed to the streaming tool handler
+ * @param mime_type MIME type of the image, e.g. "image/jpeg"
+ * @param data Raw image bytes
+ * @param len Length of data in bytes
+ * @return ESP_OK on success, ESP_FAIL once the client connection is lost
+ */
+esp_err_t esp_mcp_content_add_image(esp_mcp_content_writer_t *writer, const char *mime_type,
+                                    const void *data, size_t len);
+
+/**
+ * @brief Emit an audio content item from raw bytes in memory
+ *
+ * @param writer Content writer passed to the streaming tool handler
+ * @param mime_type MIME type of the audio, e.g. "audio/wav"
+ * @param data Raw audio bytes
+ * @param len Length of data in bytes
+ * @return ESP_OK on success, ESP_FAIL once the client connection is lost
+ */
+esp_err_t esp_mcp_content_add_audio(esp_mcp_content_writer_t *writer, const char *mime_type,
+                                    const void *data, size_t len);
+
+/**
+ * @brief Emit an image content item whose bytes are pulled from a read callback
+ *
+ * The callback reads into the writer's own staging buffer, where the bytes are
+ * encoded in place, so the image never has to be in memory as a whole.
+ *
+ * @param writer Content writer passed to the streaming tool handler
+ * @param mime_type MIME type of the image, e.g. "image/jpeg"
+ * @param read Callback supplying the raw bytes
+ * @param ctx Context passed to read
+ * @return ESP_OK on success, ESP_FAIL if read failed or the client connection is lost
+ */
+esp_err_t esp_mcp_content_add_image_from(esp_mcp_content_writer_t *writer, const char *mime_type,
+                                         esp_mcp_content_read_fn_t read, void *ctx);
+
+/**
+ * @brief Emit an audio content item whose bytes are pulled from a read callback
+ *
+ * @param writer Content writer passed to the streaming tool handler
+ * @param mime_type MIME type of the audio, e.g. "audio/wav"
+ * @param read Callback supplying the raw bytes
+ * @param ctx Context passed to read
+ * @return ESP_OK on success, ESP_FAIL if read failed or the client connection is lost
+ */
+esp_err_t esp_mcp_content_add_audio_from(esp_mcp_content_writer_t *writer, const char *mime_type,
+                                         esp_mcp_content_read_fn_t read, void *ctx);
+
+/**
+ * @brief Base64-encode a buffer with the encoder used for image and audio items
+ *
+ * For tools that build their result as cJSON rather than streaming it.
+ *
+ * @param data Input bytes
+ * @param len Length of data in bytes
+ * @param out Output buffer, at least ESP_MCP_BASE64_ENCODED_LEN(len) + 1 bytes
+ * @param out_size Size of out in bytes
+ * @return Length of the NUL-terminated encoding, or 0 if out is too small
+ */
+size_t esp_mcp_base64_encode(const void *data, size_t len, char *out, size_t out_size);
+
+/**
+ * @brief Escape text for use inside a JSON string literal
+ *
+ * Uses the word-at-a-time scanner behind the server's own serializer. Quotes,
+ * backslashes and control characters are escaped; other bytes, including
+ * UTF-8 sequences, are copied as they are.
+ *
+ * @param str Input text (need not be NUL-terminated)
+ * @param len Length of str in bytes
+ * @param out Output buffer, or NULL to only measure
+ * @param out_size Size of out in bytes
+ * @return Escaped length, excluding the terminating NUL. Nothing is written
+ *         unless out_size is larger than that
+ */
+size_t esp_mcp_json_escape(const char *str, size_t len, char *out, size_t out_size);
+
+/**
+ * @brief Decode the body of a JSON string literal, as the request parser does
+ *
+ * \\u escapes, including surrogate pairs, are converted to UTF-8. The output
+ * is never longer than the input, so out may equal in.
+ *
+ * @param in Body of the literal, without the quotes
+ * @param len Length of in in bytes
+ * @param out Output buffer of at least len bytes (not NUL-terminated)
+ * @param out_len Output: decoded length
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if the literal is malformed
+ */
+esp_err_t esp_mcp_json_unescape(const char *in, size_t len, char *out, size_t *out_len);
+
 #ifdef __cplusplus
 }
 #endif
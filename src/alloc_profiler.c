@@ -0,0 +1,275 @@
+/**
+ * @file alloc_profiler.c
+ * @brief Heap allocation profiler attributing request-path allocations to methods and tools
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "alloc_profiler.h"
+
+static const char *TAG = "MCP_ALLOC_PROF";
+
+// Counters of one open attribution scope (a request or a tool call)
+typedef struct {
+    bool active;
+    uint32_t alloc_count;
+    uint32_t alloc_bytes;
+    int32_t live_bytes;
+    uint32_t peak_live_bytes;
+} profiler_scope_t;
+
+// Request in progress on one dispatching task
+typedef struct {
+    TaskHandle_t owner;                  // Task whose allocations are attributed, NULL while unused
+    profiler_scope_t request;
+    profiler_scope_t tool;
+    int tool_entry;                      // Tool entry called by the request, -1 if none
+    char method[32];                     // Method the request is charged to
+} profiler_task_t;
+
+static struct {
+    portMUX_TYPE lock;
+    profiler_task_t tasks[CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER_TASKS];
+    esp_mcp_alloc_profile_entry_t entries[CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER_ENTRIES];
+    size_t entry_count;
+} s_profiler = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+// Slots are only ever bound and released by their own task, so lookups need no lock
+static profiler_task_t* current_task(void) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (size_t i = 0; i < CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER_TASKS; i++) {
+        if (s_profiler.tasks[i].owner == self) {
+            return &s_profiler.tasks[i];
+        }
+    }
+    return NULL;
+}
+
+static void scope_record(profiler_scope_t *scope, int32_t delta) {
+    if (!scope->active) {
+        return;
+    }
+    if (delta > 0) {
+        scope->alloc_count++;
+        scope->alloc_bytes += delta;
+    }
+    scope->live_bytes += delta;
+    if (scope->live_bytes > 0 && (uint32_t)scope->live_bytes > scope->peak_live_bytes) {
+        scope->peak_live_bytes = scope->live_bytes;
+    }
+}
+
+static void record(const void *ptr, bool is_alloc) {
+    profiler_task_t *task = ptr ? current_task() : NULL;
+    if (!task) {
+        return;
+    }
+
+    // Block size comes from the heap itself, so blocks allocated before the
+    // hooks were installed are still accounted for correctly when freed
+    int32_t size = (int32_t)heap_caps_get_allocated_size((void *)ptr);
+    int32_t delta = is_alloc ? size : -size;
+
+    // The scopes belong to the calling task, so they are updated without the lock
+    scope_record(&task->request, delta);
+    scope_record(&task->tool, delta);
+}
+
+void* alloc_profiler_malloc(size_t size) {
+    void *ptr = malloc(size);
+    record(ptr, true);
+    return ptr;
+}
+
+void alloc_profiler_free(void *ptr) {
+    record(ptr, false);
+    free(ptr);
+}
+
+char* alloc_profiler_strdup(const char *str) {
+    size_t len = strlen(str) + 1;
+    char *copy = alloc_profiler_malloc(len);
+    if (copy) {
+        memcpy(copy, str, len);
+    }
+    return copy;
+}
+
+// Must be called with the lock held
+static int find_or_add_entry(const char *name, bool is_tool) {
+    for (size_t i = 0; i < s_profiler.entry_count; i++) {
+        if (s_profiler.entries[i].is_tool == is_tool &&
+            strncmp(s_profiler.entries[i].name, name, sizeof(s_profiler.entries[i].name) - 1) == 0) {
+            return (int)i;
+        }
+    }
+    if (s_profiler.entry_count >= CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER_ENTRIES) {
+        return -1;
+    }
+
+    esp_mcp_alloc_profile_entry_t *entry = &s_profiler.entries[s_profiler.entry_count];
+    memset(entry, 0, sizeof(*entry));
+    strncpy(entry->name, name, sizeof(entry->name) - 1);
+    entry->is_tool = is_tool;
+    return (int)s_profiler.entry_count++;
+}
+
+static void charge_entry(int idx, const profiler_scope_t *scope) {
+    if (idx < 0) {
+        return;
+    }
+
+    esp_mcp_alloc_profile_entry_t *entry = &s_profiler.entries[idx];
+    entry->calls++;
+    entry->alloc_count += scope->alloc_count;
+    entry->alloc_bytes += scope->alloc_bytes;
+    if (scope->peak_live_bytes > entry->peak_live_bytes) {
+        entry->peak_live_bytes = scope->peak_live_bytes;
+    }
+}
+
+void alloc_profiler_init(void) {
+    portENTER_CRITICAL(&s_profiler.lock);
+    memset(s_profiler.entries, 0, sizeof(s_profiler.entries));
+    s_profiler.entry_count = 0;
+    memset(s_profiler.tasks, 0, sizeof(s_profiler.tasks));
+    portEXIT_CRITICAL(&s_profiler.lock);
+
+    cJSON_Hooks hooks = {
+        .malloc_fn = alloc_profiler_malloc,
+        .free_fn = alloc_profiler_free,
+    };
+    cJSON_InitHooks(&hooks);
+    ESP_LOGI(TAG, "Allocation profiler enabled");
+}
+
+void alloc_profiler_deinit(void) {
+    cJSON_InitHooks(NULL);
+    portENTER_CRITICAL(&s_profiler.lock);
+    memset(s_profiler.tasks, 0, sizeof(s_profiler.tasks));
+    portEXIT_CRITICAL(&s_profiler.lock);
+}
+
+void alloc_profiler_request_begin(void) {
+    portENTER_CRITICAL(&s_profiler.lock);
+    profiler_task_t *task = current_task();
+    for (size_t i = 0; !task && i < CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER_TASKS; i++) {
+        if (!s_profiler.tasks[i].owner) {
+            task = &s_profiler.tasks[i];
+        }
+    }
+    if (task) {
+        memset(task, 0, sizeof(*task));
+        task->request.active = true;
+        task->tool_entry = -1;
+        task->owner = xTaskGetCurrentTaskHandle();
+    }
+    portEXIT_CRITICAL(&s_profiler.lock);
+    if (!task) {
+        ESP_LOGW(TAG, "More than %d tasks dispatching at once; request not profiled",
+                 CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER_TASKS);
+    }
+}
+
+void alloc_profiler_request_method(const char *method) {
+    profiler_task_t *task = current_task();
+    if (task && method) {
+        strncpy(task->method, method, sizeof(task->method) - 1);
+    }
+}
+
+void alloc_profiler_hand_over(const void *ptr) {
+    record(ptr, false);
+}
+
+void alloc_profiler_request_end(void) {
+    profiler_task_t *task = current_task();
+    if (!task) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_profiler.lock);
+    uint32_t leaked = task->request.live_bytes > 0 ? (uint32_t)task->request.live_bytes : 0;
+    int idx = find_or_add_entry(task->method[0] ? task->method : "(invalid)", false);
+    charge_entry(idx, &task->request);
+    if (idx >= 0) {
+        s_profiler.entries[idx].leaked_bytes += leaked;
+    }
+    if (task->tool_entry >= 0) {
+        s_profiler.entries[task->tool_entry].leaked_bytes += leaked;
+    }
+    task->request.active = false;
+    task->owner = NULL;
+    portEXIT_CRITICAL(&s_profiler.lock);
+}
+
+void alloc_profiler_tool_begin(void) {
+    profiler_task_t *task = current_task();
+    if (task) {
+        memset(&task->tool, 0, sizeof(task->tool));
+        task->tool.active = task->request.active;
+    }
+}
+
+void alloc_profiler_tool_end(const char *tool) {
+    profiler_task_t *task = current_task();
+    if (!task || !task->tool.active || !tool) {
+        return;
+    }
+
+    task->tool.active = false;
+    portENTER_CRITICAL(&s_profiler.lock);
+    int idx = find_or_add_entry(tool, true);
+    charge_entry(idx, &task->tool);
+    portEXIT_CRITICAL(&s_profiler.lock);
+    task->tool_entry = idx;
+}
+
+size_t alloc_profiler_snapshot(esp_mcp_alloc_profile_entry_t *entries, size_t max_entries) {
+    portENTER_CRITICAL(&s_profiler.lock);
+    size_t count = s_profiler.entry_count < max_entries ? s_profiler.entry_count : max_entries;
+    memcpy(entries, s_profiler.entries, count * sizeof(entries[0]));
+    portEXIT_CRITICAL(&s_profiler.lock);
+    return count;
+}
+
+char* alloc_profiler_render_json(void) {
+    esp_mcp_alloc_profile_entry_t *entries = malloc(sizeof(s_profiler.entries));
+    if (!entries) {
+        return NULL;
+    }
+    size_t count = alloc_profiler_snapshot(entries, CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER_ENTRIES);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON *methods = cJSON_AddArrayToObject(root, "methods");
+    cJSON *tools = cJSON_AddArrayToObject(root, "tools");
+    for (size_t i = 0; i < count; i++) {
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", entries[i].name);
+        cJSON_AddNumberToObject(item, "calls", entries[i].calls);
+        cJSON_AddNumberToObject(item, "allocations", entries[i].alloc_count);
+        cJSON_AddNumberToObject(item, "bytesAllocated", entries[i].alloc_bytes);
+        cJSON_AddNumberToObject(item, "peakLiveBytes", entries[i].peak_live_bytes);
+        cJSON_AddNumberToObject(item, "leakedBytes", entries[i].leaked_bytes);
+        cJSON_AddItemToArray(entries[i].is_tool ? tools : methods, item);
+    }
+    free(entries);
+
+    char *text = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return text;
+}
+
+#endif // CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER
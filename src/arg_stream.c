@@ -0,0 +1,284 @@
+/**
+ * @file arg_stream.c
+ * @brief Delivery of a large tool argument to a sink while the request body arrives
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_ESP_MCP_SERVER_STREAM_ARGUMENTS
+
+#include <string.h>
+#include <sys/param.h>
+#include "json_string.h"
+#include "arg_stream.h"
+
+void arg_stream_begin(arg_stream_t *split, char *body, arg_stream_claim_fn_t claim, void *arg) {
+    memset(split, 0, sizeof(*split));
+    split->body = body;
+    split->claim = claim;
+    split->claim_arg = arg;
+}
+
+static void write_piece(arg_stream_t *split) {
+    if (split->piece_len > 0 && split->error == ESP_OK) {
+        split->error = split->sink->write(split->piece, split->piece_len, split->user_data);
+    }
+    split->piece_len = 0;
+}
+
+// Pass unescaped characters of the diverted value on, base64-decoding them if needed
+static void divert(arg_stream_t *split, const char *data, size_t len) {
+    while (len > 0 && split->error == ESP_OK) {
+        size_t space = sizeof(split->piece) - split->piece_len;
+        size_t n;
+        if (!split->base64) {
+            n = MIN(len, space);
+            memcpy(split->piece + split->piece_len, data, n);
+            split->piece_len += n;
+        } else {
+            // n characters decode to at most (n / 4 + 1) * 3 bytes
+            if (space < 6) {
+                write_piece(split);
+                continue;
+            }
+            n = MIN(len, (space / 3 - 1) * 4);
+            ssize_t out = base64_decode_feed(&split->decoder, data, n, split->piece + split->piece_len);
+            if (out < 0) {
+                split->error = ESP_ERR_INVALID_ARG;
+                return;
+            }
+            split->piece_len += out;
+        }
+        data += n;
+        len -= n;
+        if (split->piece_len == sizeof(split->piece)) {
+            write_piece(split);
+        }
+    }
+}
+
+// Whether a pending escape sequence is complete (or malformed, which unescaping reports)
+static bool escape_complete(const char *esc, size_t len) {
+    if (len < 2) {
+        return false;
+    }
+    if (esc[1] != 'u') {
+        return true;
+    }
+    if (len < 6) {
+        return false;
+    }
+    // A high surrogate is only valid when a \u low surrogate follows
+    char c = esc[3];
+    bool high = (esc[2] == 'd' || esc[2] == 'D') &&
+                (c == '8' || c == '9' || c == 'a' || c == 'b' || c == 'A' || c == 'B');
+    if (!high || (len == 7 && esc[6] != '\\') || (len == 8 && esc[7] != 'u')) {
+        return true;
+    }
+    return len == sizeof(((arg_stream_t *)0)->escape);
+}
+
+static void end_divert(arg_stream_t *split) {
+    split->diverting = false;
+    if (split->base64 && split->error == ESP_OK) {
+        if (sizeof(split->piece) - split->piece_len < 2) {
+            write_piece(split);
+        }
+        ssize_t out = base64_decode_finish(&split->decoder, split->piece + split->piece_len);
+        if (out < 0) {
+            split->error = ESP_ERR_INVALID_ARG;
+        } else {
+            split->piece_len += out;
+        }
+    }
+    write_piece(split);
+    split->body[split->len++] = '"';
+}
+
+// One character of the diverted value that is not part of a plain run
+static void divert_char(arg_stream_t *split, char c) {
+    if (split->escape_len > 0) {
+        split->escape[split->escape_len++] = c;
+        if (escape_complete(split->escape, split->escape_len)) {
+            char out[sizeof(split->escape)];
+            ssize_t n = json_string_unescape(split->escape, split->escape_len, out);
+            split->escape_len = 0;
+            if (n < 0) {
+                split->error = ESP_ERR_INVALID_ARG;
+            } else {
+                divert(split, out, n);
+            }
+        }
+    } else if (c == '\\') {
+        split->escape[split->escape_len++] = c;
+    } else if (c == '"') {
+        end_divert(split);
+    } else {
+        divert(split, &c, 1);
+    }
+}
+
+static bool is_array(const arg_stream_t *split, uint16_t depth) {
+    return depth > 32 || (split->arrays & (1u << (depth - 1)));
+}
+
+// Decide where the string that just started is recorded, or whether it is the streamed value
+static void begin_string(arg_stream_t *split) {
+    bool in_object = split->depth > 0 && !is_array(split, split->depth);
+    bool is_key = in_object && split->expect_key;
+    split->in_string = true;
+    split->escaped = false;
+    split->capture = NULL;
+    split->capture_len = 0;
+    split->capture_overflow = false;
+
+    if (is_key) {
+        if (split->depth <= 3) {
+            split->capture = split->keys[split->depth - 1];
+        }
+        return;
+    }
+
+    // Values on the path params.arguments.<key> are only looked at below objects
+    if (!in_object || (split->arrays & ((1u << MIN(split->depth, 3)) - 1)) != 0) {
+        return;
+    }
+    if (split->depth == 1 && strcmp(split->keys[0], "method") == 0) {
+        split->capture = split->method;
+    } else if (split->depth == 2 && strcmp(split->keys[0], "params") == 0 && strcmp(split->keys[1], "name") == 0) {
+        split->capture = split->tool;
+    } else if (split->depth == 3 && !split->diverted && split->tool[0] &&
+               strcmp(split->method, "tools/call") == 0 &&
+               strcmp(split->keys[0], "params") == 0 && strcmp(split->keys[1], "arguments") == 0) {
+        esp_err_t ret = split->claim(split->claim_arg, split->tool, split->keys[2],
+                                     &split->sink, &split->user_data, &split->base64);
+        if (ret != ESP_ERR_NOT_FOUND) {
+            split->in_string = false;
+            split->diverting = true;
+            split->diverted = true;
+            split->error = ret;
+        }
+    }
+}
+
+static void end_string(arg_stream_t *split) {
+    split->in_string = false;
+    if (split->capture) {
+        // A truncated name must not match anything
+        split->capture[split->capture_overflow ? 0 : split->capture_len] = '\0';
+    }
+    split->expect_key = false;
+}
+
+static void string_char(arg_stream_t *split, char c) {
+    if (split->escaped) {
+        split->escaped = false;
+    } else if (c == '\\') {
+        split->escaped = true;
+    } else if (c == '"') {
+        end_string(split);
+        return;
+    }
+    if (split->capture) {
+        if (split->capture_len + 1 < ARG_STREAM_NAME_MAX) {
+            split->capture[split->capture_len++] = c;
+        } else {
+            split->capture_overflow = true;
+        }
+    }
+}
+
+static void structural_char(arg_stream_t *split, char c) {
+    switch (c) {
+    case '{':
+    case '[':
+        split->depth++;
+        if (split->depth <= 32) {
+            if (c == '[') {
+                split->arrays |= 1u << (split->depth - 1);
+            } else {
+                split->arrays &= ~(1u << (split->depth - 1));
+            }
+        }
+        split->expect_key = c == '{';
+        break;
+    case '}':
+    case ']':
+        if (split->depth > 0) {
+            split->depth--;
+        }
+        split->expect_key = false;
+        break;
+    case ',':
+        split->expect_key = split->depth > 0 && !is_array(split, split->depth);
+        break;
+    case ':':
+        split->expect_key = false;
+        break;
+    case '"':
+        begin_string(split);
+        break;
+    default:
+        break;
+    }
+}
+
+void arg_stream_feed(arg_stream_t *split, const char *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (split->diverting) {
+            if (split->escape_len == 0) {
+                // Most of a large value is a plain run, handed on in bulk
+                size_t run = 0;
+                while (i + run < len && data[i + run] != '"' && data[i + run] != '\\') {
+                    run++;
+                }
+                if (run > 0) {
+                    divert(split, data + i, run);
+                    i += run - 1;
+                    continue;
+                }
+            }
+            divert_char(split, c);
+            continue;
+        }
+
+        // The output index never passes i, so data may alias the output
+        split->body[split->len++] = c;
+        if (split->in_string) {
+            string_char(split, c);
+        } else {
+            structural_char(split, c);
+        }
+    }
+}
+
+esp_err_t arg_stream_end(arg_stream_t *split) {
+    if (split->diverting) {
+        // The body ended inside the value
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return split->error;
+}
+
+esp_err_t arg_stream_deliver(const esp_mcp_argument_sink_t *sink, void *user_data, bool base64, char *value, size_t len) {
+    if (base64) {
+        base64_decoder_t decoder = { 0 };
+        ssize_t n = base64_decode_feed(&decoder, value, len, (uint8_t *)value);
+        ssize_t tail = n < 0 ? -1 : base64_decode_finish(&decoder, (uint8_t *)value + n);
+        if (tail < 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        len = n + tail;
+    }
+
+    for (size_t offset = 0; offset < len; offset += ARG_STREAM_PIECE_SIZE) {
+        esp_err_t ret = sink->write((const uint8_t *)value + offset, MIN(len - offset, ARG_STREAM_PIECE_SIZE), user_data);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+#endif // CONFIG_ESP_MCP_SERVER_STREAM_ARGUMENTS
@@ -0,0 +1,164 @@
+/**
+ * @file base64.c
+ * @brief Word-at-a-time base64 encoder for binary content items
+ */
+
+#include <string.h>
+#include "base64.h"
+#include "esp_mcp_server.h"
+
+static const char BASE64_ALPHABET[64] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Four output characters of a 24-bit group, in memory order when stored as a word
+static inline uint32_t encode_group_word(uint32_t group) {
+    uint32_t c0 = (uint8_t)BASE64_ALPHABET[(group >> 18) & 0x3f];
+    uint32_t c1 = (uint8_t)BASE64_ALPHABET[(group >> 12) & 0x3f];
+    uint32_t c2 = (uint8_t)BASE64_ALPHABET[(group >> 6) & 0x3f];
+    uint32_t c3 = (uint8_t)BASE64_ALPHABET[group & 0x3f];
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return c0 | (c1 << 8) | (c2 << 16) | (c3 << 24);
+#else
+    return (c0 << 24) | (c1 << 16) | (c2 << 8) | c3;
+#endif
+}
+
+// Aligned 32-bit load of four input bytes as a big-endian value
+static inline uint32_t load_be32(const uint8_t *p) {
+    uint32_t word;
+    memcpy(&word, __builtin_assume_aligned(p, 4), sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap32(word);
+#endif
+    return word;
+}
+
+static inline void encode_group_bytes(const uint8_t *src, char *dst) {
+    uint32_t group = ((uint32_t)src[0] << 16) | ((uint32_t)src[1] << 8) | src[2];
+    dst[0] = BASE64_ALPHABET[group >> 18];
+    dst[1] = BASE64_ALPHABET[(group >> 12) & 0x3f];
+    dst[2] = BASE64_ALPHABET[(group >> 6) & 0x3f];
+    dst[3] = BASE64_ALPHABET[group & 0x3f];
+}
+
+size_t base64_encode_blocks(const uint8_t *src, size_t len, char *dst) {
+    size_t groups = len / 3;
+    char *out = dst;
+
+    // Xtensa faults on unaligned word access, so words are only used when both sides allow it
+    if ((((uintptr_t)src | (uintptr_t)dst) & 3) == 0) {
+        for (; groups >= 4; groups -= 4) {
+            uint32_t w0 = load_be32(src);
+            uint32_t w1 = load_be32(src + 4);
+            uint32_t w2 = load_be32(src + 8);
+            src += 12;
+            uint32_t words[4] = {
+                encode_group_word(w0 >> 8),
+                encode_group_word(((w0 & 0xff) << 16) | (w1 >> 16)),
+                encode_group_word(((w1 & 0xffff) << 8) | (w2 >> 24)),
+                encode_group_word(w2 & 0xffffff),
+            };
+            memcpy(__builtin_assume_aligned(out, 4), words, sizeof(words));
+            out += sizeof(words);
+        }
+    }
+
+    for (; groups > 0; groups--) {
+        encode_group_bytes(src, out);
+        src += 3;
+        out += 4;
+    }
+    return out - dst;
+}
+
+size_t base64_encode_tail(const uint8_t *src, size_t len, char *dst) {
+    if (len == 0) {
+        return 0;
+    }
+    uint32_t group = (uint32_t)src[0] << 16;
+    if (len > 1) {
+        group |= (uint32_t)src[1] << 8;
+    }
+    dst[0] = BASE64_ALPHABET[group >> 18];
+    dst[1] = BASE64_ALPHABET[(group >> 12) & 0x3f];
+    dst[2] = len > 1 ? BASE64_ALPHABET[(group >> 6) & 0x3f] : '=';
+    dst[3] = '=';
+    return 4;
+}
+
+// Sextet of each input byte; 0x40 marks whitespace, 0x41 padding and 0xff anything else
+static const uint8_t BASE64_DECODE[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x40, 0x40, 0xff, 0xff, 0x40, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x40, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0x41, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+ssize_t base64_decode_feed(base64_decoder_t *dec, const char *src, size_t len, uint8_t *dst) {
+    uint8_t *out = dst;
+    uint32_t bits = dec->bits;
+    uint8_t count = dec->count;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t v = BASE64_DECODE[(uint8_t)src[i]];
+        if (v < 0x40 && !dec->padded) {
+            bits = (bits << 6) | v;
+            if (++count == 4) {
+                out[0] = bits >> 16;
+                out[1] = bits >> 8;
+                out[2] = bits;
+                out += 3;
+                count = 0;
+            }
+        } else if (v == 0x41) {
+            dec->padded = true;
+        } else if (v != 0x40) {
+            return -1;
+        }
+    }
+    dec->bits = bits;
+    dec->count = count;
+    return out - dst;
+}
+
+ssize_t base64_decode_finish(base64_decoder_t *dec, uint8_t *dst) {
+    // One leftover sextet cannot form a byte
+    uint8_t count = dec->count;
+    dec->count = 0;
+    switch (count) {
+    case 0:
+        return 0;
+    case 2:
+        dst[0] = dec->bits >> 4;
+        return 1;
+    case 3:
+        dst[0] = dec->bits >> 10;
+        dst[1] = dec->bits >> 2;
+        return 2;
+    default:
+        return -1;
+    }
+}
+
+size_t esp_mcp_base64_encode(const void *data, size_t len, char *out, size_t out_size) {
+    if ((!data && len > 0) || !out || out_size < ESP_MCP_BASE64_ENCODED_LEN(len) + 1) {
+        return 0;
+    }
+
+    size_t whole = len - len % 3;
+    size_t n = base64_encode_blocks(data, whole, out);
+    n += base64_encode_tail((const uint8_t *)data + whole, len - whole, out + n);
+    out[n] = '\0';
+    return n;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file completion_index.c
+ * @brief Sorted prefix index for completion/complete candidates
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "completion_index.h"
+
+static int compare_strings(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+esp_err_t completion_index_build(completion_index_t *index, const char *const *values, size_t count) {
+    if (!index || (!values && count > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(index, 0, sizeof(*index));
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    size_t arena_size = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!values[i]) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        arena_size += strlen(values[i]) + 1;
+    }
+
+    index->arena = malloc(arena_size);
+    index->sorted = malloc(count * sizeof(index->sorted[0]));
+    if (!index->arena || !index->sorted) {
+        completion_index_free(index);
+        return ESP_ERR_NO_MEM;
+    }
+
+    char *p = index->arena;
+    for (size_t i = 0; i < count; i++) {
+        size_t len = strlen(values[i]) + 1;
+        memcpy(p, values[i], len);
+        index->sorted[i] = p;
+        p += len;
+    }
+
+    qsort(index->sorted, count, sizeof(index->sorted[0]), compare_strings);
+
+    // Drop duplicates so a run never reports the same value twice
+    size_t unique = 1;
+    for (size_t i = 1; i < count; i++) {
+        if (strcmp(index->sorted[i], index->sorted[unique - 1]) != 0) {
+            index->sorted[unique++] = index->sorted[i];
+        }
+    }
+    index->count = unique;
+
+    return ESP_OK;
+}
+
+size_t completion_index_lookup(const completion_index_t *index, const char *prefix, size_t *first) {
+    if (first) {
+        *first = 0;
+    }
+    if (!index || index->count == 0) {
+        return 0;
+    }
+    if (!prefix || prefix[0] == '\0') {
+        return index->count;
+    }
+
+    size_t prefix_len = strlen(prefix);
+
+    // Lower bound: first entry not less than the prefix
+    size_t lo = 0;
+    size_t hi = index->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (strcmp(index->sorted[mid], prefix) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    size_t begin = lo;
+
+    // Upper bound: first entry whose leading bytes sort after the prefix
+    hi = index->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (strncmp(index->sorted[mid], prefix, prefix_len) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (first) {
+        *first = begin;
+    }
+    return lo - begin;
+}
+
+void completion_index_free(completion_index_t *index) {
+    if (!index) {
+        return;
+    }
+
+    free(index->sorted);
+    free(index->arena);
+    memset(index, 0, sizeof(*index));
+}
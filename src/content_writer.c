@@ -0,0 +1,343 @@
+/**
+ * @file content_writer.c
+ * @brief Incremental serialization of streamed tool results and resource contents
+ */
+
+#include <string.h>
+#include <sys/param.h>
+#include "base64.h"
+#include "json_string.h"
+#include "json_writer.h"
+#include "content_writer.h"
+
+// Free staging space below which base64 output is flushed rather than encoded in slivers
+#define BASE64_MIN_SPACE 16
+
+static esp_err_t flush(esp_mcp_content_writer_t *writer) {
+    if (writer->error == ESP_OK && writer->len > 0) {
+        writer->error = writer->stream->send_chunk(writer->stream->ctx, writer->buf, writer->len);
+        writer->sent += writer->len;
+    }
+    writer->len = 0;
+    return writer->error;
+}
+
+static esp_err_t write_raw(esp_mcp_content_writer_t *writer, const char *data, size_t len) {
+    while (len > 0 && writer->error == ESP_OK) {
+        if (writer->len == writer->size) {
+            flush(writer);
+            continue;
+        }
+        size_t n = writer->size - writer->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(writer->buf + writer->len, data, n);
+        writer->len += n;
+        data += n;
+        len -= n;
+    }
+    return writer->error;
+}
+
+// Append data as the body of a JSON string literal; clean runs are copied whole
+static esp_err_t write_escaped(esp_mcp_content_writer_t *writer, const char *data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        size_t run = json_string_scan(data + i, len - i);
+        write_raw(writer, data + i, run);
+        i += run;
+        if (i < len) {
+            char esc[JSON_STRING_ESCAPE_MAX];
+            write_raw(writer, esc, json_string_escape_char((unsigned char)data[i], esc));
+            i++;
+        }
+    }
+    return writer->error;
+}
+
+static esp_err_t begin_item(esp_mcp_content_writer_t *writer) {
+    if (writer->in_text) {
+        esp_mcp_content_end_text(writer);
+    }
+    if (writer->item_count++ > 0) {
+        write_raw(writer, ",", 1);
+    }
+    return writer->error;
+}
+
+// Write the response envelope up to the opening bracket of the result's array
+static esp_err_t begin_result(esp_mcp_content_writer_t *writer, const mcp_transport_stream_t *stream,
+                              const cJSON *id, char *buf, size_t size, bool contents) {
+    if (!writer || !stream || !id || !buf || size < CONTENT_WRITER_MIN_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(writer, 0, sizeof(*writer));
+    writer->stream = stream;
+    writer->buf = buf;
+    writer->size = size;
+    writer->contents = contents;
+
+    write_raw(writer, "{\"jsonrpc\":\"2.0\",\"id\":", 22);
+    if (cJSON_IsString(id)) {
+        write_raw(writer, "\"", 1);
+        write_escaped(writer, id->valuestring, strlen(id->valuestring));
+        write_raw(writer, "\"", 1);
+    } else {
+        char *id_str = json_writer_print(id);
+        if (!id_str) {
+            return ESP_ERR_NO_MEM;
+        }
+        write_raw(writer, id_str, strlen(id_str));
+        cJSON_free(id_str);
+    }
+    const char *head = contents ? ",\"result\":{\"contents\":[" : ",\"result\":{\"content\":[";
+    return write_raw(writer, head, strlen(head));
+}
+
+esp_err_t content_writer_begin(esp_mcp_content_writer_t *writer, const mcp_transport_stream_t *stream,
+                               const cJSON *id, char *buf, size_t size) {
+    return begin_result(writer, stream, id, buf, size, false);
+}
+
+esp_err_t content_writer_begin_contents(esp_mcp_content_writer_t *writer, const mcp_transport_stream_t *stream,
+                                        const cJSON *id, char *buf, size_t size) {
+    return begin_result(writer, stream, id, buf, size, true);
+}
+
+esp_err_t content_writer_finish(esp_mcp_content_writer_t *writer, bool is_error) {
+    if (writer->in_text) {
+        esp_mcp_content_end_text(writer);
+    }
+    if (writer->contents) {
+        write_raw(writer, "]}}", 3);
+        return flush(writer);
+    }
+    if (is_error && writer->item_count == 0) {
+        esp_mcp_content_add_text(writer, "Tool execution failed");
+    }
+    const char *tail = is_error ? "],\"isError\":true}}" : "],\"isError\":false}}";
+    write_raw(writer, tail, strlen(tail));
+    return flush(writer);
+}
+
+esp_err_t esp_mcp_content_begin_text(esp_mcp_content_writer_t *writer) {
+    if (!writer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    begin_item(writer);
+    write_raw(writer, "{\"type\":\"text\",\"text\":\"", 23);
+    writer->in_text = true;
+    return writer->error;
+}
+
+esp_err_t esp_mcp_content_append_text(esp_mcp_content_writer_t *writer, const char *data, size_t len) {
+    if (!writer || (!data && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!writer->in_text) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return write_escaped(writer, data, len);
+}
+
+esp_err_t esp_mcp_content_end_text(esp_mcp_content_writer_t *writer) {
+    if (!writer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!writer->in_text) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    writer->in_text = false;
+    return write_raw(writer, "\"}", 2);
+}
+
+esp_err_t esp_mcp_content_add_text(esp_mcp_content_writer_t *writer, const char *text) {
+    if (!writer || !text) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_mcp_content_begin_text(writer);
+    write_escaped(writer, text, strlen(text));
+    return esp_mcp_content_end_text(writer);
+}
+
+esp_err_t esp_mcp_content_add_item(esp_mcp_content_writer_t *writer, const cJSON *item) {
+    if (!writer || !cJSON_IsObject(item)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (begin_item(writer) != ESP_OK) {
+        return writer->error;
+    }
+
+    char *item_str = json_writer_print(item);
+    if (!item_str) {
+        // Keep the array well-formed; the item is replaced by an empty object
+        write_raw(writer, "{}", 2);
+        return ESP_ERR_NO_MEM;
+    }
+    write_raw(writer, item_str, strlen(item_str));
+    cJSON_free(item_str);
+    return writer->error;
+}
+
+// Open a base64 string value whose key has just been written
+static esp_err_t begin_base64_value(esp_mcp_content_writer_t *writer) {
+    // Whitespace before the value is valid JSON; it word-aligns the data so the
+    // encoder can store whole words. Flushing first keeps the alignment stable.
+    if (writer->size - writer->len < BASE64_MIN_SPACE) {
+        flush(writer);
+    }
+    size_t pad = (4 - (((uintptr_t)(writer->buf + writer->len) + 1) & 3)) & 3;
+    write_raw(writer, "   ", pad);
+    return write_raw(writer, "\"", 1);
+}
+
+// Open an image or audio item up to the first character of its base64 data
+static esp_err_t begin_binary_item(esp_mcp_content_writer_t *writer, const char *type, const char *mime_type) {
+    begin_item(writer);
+    write_raw(writer, "{\"type\":\"", 9);
+    write_raw(writer, type, strlen(type));
+    write_raw(writer, "\",\"mimeType\":\"", 14);
+    write_escaped(writer, mime_type, strlen(mime_type));
+    write_raw(writer, "\",\"data\":", 9);
+    return begin_base64_value(writer);
+}
+
+// Open a resources/read entry up to its text or blob member
+static esp_err_t begin_resource_item(esp_mcp_content_writer_t *writer, const char *uri, const char *mime_type) {
+    begin_item(writer);
+    write_raw(writer, "{\"uri\":\"", 8);
+    write_escaped(writer, uri, strlen(uri));
+    write_raw(writer, "\",\"mimeType\":\"", 14);
+    return write_escaped(writer, mime_type, strlen(mime_type));
+}
+
+// Encode a buffer straight into the staging buffer, 12-byte multiples at a time
+static esp_err_t write_base64(esp_mcp_content_writer_t *writer, const uint8_t *data, size_t len) {
+    size_t whole = len - len % 3;
+    while (whole > 0 && writer->error == ESP_OK) {
+        size_t space = writer->size - writer->len;
+        if (space < BASE64_MIN_SPACE) {
+            flush(writer);
+            continue;
+        }
+        // Whole words in and out keep both sides aligned for the next call
+        size_t n = MIN(whole, space / 16 * 12);
+        writer->len += base64_encode_blocks(data, n, writer->buf + writer->len);
+        data += n;
+        whole -= n;
+    }
+
+    char tail[4];
+    return write_raw(writer, tail, base64_encode_tail(data, len % 3, tail));
+}
+
+// Read input into the end of the free staging space and encode it in place towards the front
+static esp_err_t write_base64_from(esp_mcp_content_writer_t *writer, esp_mcp_content_read_fn_t read, void *ctx) {
+    uint8_t carry[2];
+    size_t carried = 0;
+    while (writer->error == ESP_OK) {
+        size_t space = (writer->size - writer->len) & ~(size_t)15;
+        if (space < BASE64_MIN_SPACE) {
+            flush(writer);
+            continue;
+        }
+
+        // The input starts a quarter of the way in, so the output never overtakes it
+        char *out = writer->buf + writer->len;
+        size_t capacity = space / 4 * 3;
+        uint8_t *in = (uint8_t *)out + (space - capacity);
+        memcpy(in, carry, carried);
+        int ret = read(ctx, in + carried, capacity - carried);
+        if (ret < 0) {
+            return ESP_FAIL;
+        }
+        if (ret == 0) {
+            break;
+        }
+
+        size_t total = carried + (size_t)ret;
+        size_t whole = total - total % 3;
+        carried = total - whole;
+        memcpy(carry, in + whole, carried);
+        writer->len += base64_encode_blocks(in, whole, out);
+    }
+
+    char tail[4];
+    return write_raw(writer, tail, base64_encode_tail(carry, carried, tail));
+}
+
+static esp_err_t add_binary(esp_mcp_content_writer_t *writer, const char *type, const char *mime_type,
+                            const void *data, size_t len, esp_mcp_content_read_fn_t read, void *ctx) {
+    if (!writer || !mime_type || (!read && !data && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (begin_binary_item(writer, type, mime_type) != ESP_OK) {
+        return writer->error;
+    }
+
+    esp_err_t ret = read ? write_base64_from(writer, read, ctx) : write_base64(writer, data, len);
+    // Close the item even if the source failed, so the result stays well-formed
+    write_raw(writer, "\"}", 2);
+    return ret != ESP_OK ? ret : writer->error;
+}
+
+esp_err_t esp_mcp_content_add_image(esp_mcp_content_writer_t *writer, const char *mime_type,
+                                    const void *data, size_t len) {
+    return add_binary(writer, "image", mime_type, data, len, NULL, NULL);
+}
+
+esp_err_t esp_mcp_content_add_audio(esp_mcp_content_writer_t *writer, const char *mime_type,
+                                    const void *data, size_t len) {
+    return add_binary(writer, "audio", mime_type, data, len, NULL, NULL);
+}
+
+esp_err_t esp_mcp_content_add_image_from(esp_mcp_content_writer_t *writer, const char *mime_type,
+                                         esp_mcp_content_read_fn_t read, void *ctx) {
+    if (!read) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return add_binary(writer, "image", mime_type, NULL, 0, read, ctx);
+}
+
+esp_err_t esp_mcp_content_add_audio_from(esp_mcp_content_writer_t *writer, const char *mime_type,
+                                         esp_mcp_content_read_fn_t read, void *ctx) {
+    if (!read) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return add_binary(writer, "audio", mime_type, NULL, 0, read, ctx);
+}
+
+esp_err_t content_writer_begin_resource_text(esp_mcp_content_writer_t *writer, const char *uri, const char *mime_type) {
+    if (!writer || !uri || !mime_type) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    begin_resource_item(writer, uri, mime_type);
+    write_raw(writer, "\",\"text\":\"", 10);
+    writer->in_text = true;
+    return writer->error;
+}
+
+esp_err_t content_writer_add_resource_blob(esp_mcp_content_writer_t *writer, const char *uri, const char *mime_type,
+                                           const void *data, size_t len, esp_mcp_content_read_fn_t read, void *ctx) {
+    if (!writer || !uri || !mime_type || (!read && !data && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    begin_resource_item(writer, uri, mime_type);
+    write_raw(writer, "\",\"blob\":", 9);
+    if (begin_base64_value(writer) != ESP_OK) {
+        return writer->error;
+    }
+
+    esp_err_t ret = read ? write_base64_from(writer, read, ctx) : write_base64(writer, data, len);
+    write_raw(writer, "\"}", 2);
+    return ret != ESP_OK ? ret : writer->error;
+}
+
+bool content_writer_is_text_type(const char *mime_type) {
+    return strncmp(mime_type, "text/", 5) == 0 ||
+           strcmp(mime_type, "application/json") == 0 ||
+           strcmp(mime_type, "application/xml") == 0 ||
+           strcmp(mime_type, "application/yaml") == 0;
+}
@@ -0,0 +1,260 @@
+/**
+ * @file crash_journal.c
+ * @brief Journal of the last requests in memory that survives a reset
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL
+
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "cJSON.h"
+#include "crash_journal.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#else
+#include "esp_attr.h"
+#include "soc/soc_caps.h"
+#endif
+
+static const char *TAG = "MCP_JOURNAL";
+
+#define CRASH_JOURNAL_MAGIC 0x4a50434d   // "MCPJ"
+
+// Wall-clock times before this are taken as an unset clock
+#define CRASH_JOURNAL_MIN_WALL_TIME 1600000000
+
+enum {
+    ID_NONE,
+    ID_NUMBER,
+    ID_STRING,
+};
+
+typedef struct {
+    uint32_t seq;                        // Request number; 0 while the slot is unused or being written
+    uint16_t boot;                       // Boot the request arrived in
+    int16_t status;                      // HTTP status of the response, 0 while in progress
+    uint32_t uptime_ms;                  // Time since boot when dispatch began
+    uint32_t duration_ms;
+    uint32_t wall_time;                  // Unix time when dispatch began, 0 if the clock was not set
+    uint8_t id_kind;
+    char method[31];
+    char tool[24];
+    union {
+        int64_t number;
+        char text[16];
+    } id;
+} journal_entry_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t size;                       // sizeof(journal_t), so a layout change starts a new journal
+    uint32_t next_seq;
+    uint16_t boot;                       // Boots since the journal was started
+    uint16_t reserved;
+    journal_entry_t entries[CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL_ENTRIES];
+    uint32_t magic_end;                  // ~magic
+} journal_t;
+
+#if CONFIG_IDF_TARGET_LINUX
+// Emulated with a file mapped into memory, which outlives a crashed process
+static journal_t s_fallback;
+#elif SOC_RTC_MEM_SUPPORTED
+static RTC_NOINIT_ATTR journal_t s_region;
+#else
+static __NOINIT_ATTR journal_t s_region;
+#endif
+
+static journal_t *s_journal;
+
+static journal_t* map_region(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    int fd = open(CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL_FILE, O_RDWR | O_CREAT, 0644);
+    if (fd >= 0 && ftruncate(fd, sizeof(journal_t)) == 0) {
+        void *region = mmap(NULL, sizeof(journal_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (region != MAP_FAILED) {
+            return region;
+        }
+    } else if (fd >= 0) {
+        close(fd);
+    }
+    ESP_LOGW(TAG, "Cannot map '%s'; the journal will not survive a restart", CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL_FILE);
+    return &s_fallback;
+#else
+    return &s_region;
+#endif
+}
+
+void crash_journal_init(void) {
+    if (s_journal) {
+        return;
+    }
+
+    journal_t *journal = map_region();
+    if (journal->magic == CRASH_JOURNAL_MAGIC && journal->magic_end == ~(uint32_t)CRASH_JOURNAL_MAGIC &&
+        journal->size == sizeof(journal_t)) {
+        journal->boot++;
+        ESP_LOGI(TAG, "Journal kept from earlier boots, now boot %u", journal->boot);
+    } else {
+        memset(journal, 0, sizeof(*journal));
+        journal->magic = CRASH_JOURNAL_MAGIC;
+        journal->size = sizeof(journal_t);
+        journal->magic_end = ~(uint32_t)CRASH_JOURNAL_MAGIC;
+        journal->boot = 1;
+    }
+    s_journal = journal;
+}
+
+// Bounded copy that always terminates, unlike strncpy
+static void copy_name(char *dst, size_t size, const char *src) {
+    size_t i = 0;
+    if (src) {
+        for (; i + 1 < size && src[i]; i++) {
+            dst[i] = src[i];
+        }
+    }
+    dst[i] = '\0';
+}
+
+uint32_t crash_journal_begin(const char *method, const char *tool, const cJSON *id) {
+    journal_t *journal = s_journal;
+    if (!journal) {
+        return 0;
+    }
+
+    uint32_t seq = __atomic_add_fetch(&journal->next_seq, 1, __ATOMIC_RELAXED);
+    if (seq == 0) {
+        // 0 marks an unused slot
+        seq = __atomic_add_fetch(&journal->next_seq, 1, __ATOMIC_RELAXED);
+    }
+    journal_entry_t *entry = &journal->entries[seq % CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL_ENTRIES];
+
+    // Published last, so a reset in between leaves the slot unused rather than half written
+    __atomic_store_n(&entry->seq, 0, __ATOMIC_RELAXED);
+    entry->boot = journal->boot;
+    entry->status = 0;
+    entry->uptime_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    entry->duration_ms = 0;
+    time_t now = time(NULL);
+    entry->wall_time = now >= CRASH_JOURNAL_MIN_WALL_TIME ? (uint32_t)now : 0;
+    copy_name(entry->method, sizeof(entry->method), method);
+    copy_name(entry->tool, sizeof(entry->tool), tool);
+    if (cJSON_IsNumber(id)) {
+        entry->id_kind = ID_NUMBER;
+        entry->id.number = (int64_t)id->valuedouble;
+    } else if (cJSON_IsString(id)) {
+        entry->id_kind = ID_STRING;
+        copy_name(entry->id.text, sizeof(entry->id.text), id->valuestring);
+    } else {
+        entry->id_kind = ID_NONE;
+    }
+    __atomic_store_n(&entry->seq, seq, __ATOMIC_RELEASE);
+    return seq;
+}
+
+void crash_journal_end(uint32_t seq, int status) {
+    journal_t *journal = s_journal;
+    if (!journal || seq == 0) {
+        return;
+    }
+
+    journal_entry_t *entry = &journal->entries[seq % CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL_ENTRIES];
+    if (__atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE) != seq) {
+        return;
+    }
+    entry->duration_ms = (uint32_t)(esp_timer_get_time() / 1000) - entry->uptime_ms;
+    // A status of 0 would read as still in progress
+    entry->status = status > 0 ? status : -1;
+}
+
+static const char* reset_reason_name(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    return "unknown";
+#else
+    switch (esp_reset_reason()) {
+        case ESP_RST_POWERON:   return "poweron";
+        case ESP_RST_EXT:       return "external";
+        case ESP_RST_SW:        return "software";
+        case ESP_RST_PANIC:     return "panic";
+        case ESP_RST_INT_WDT:   return "int_wdt";
+        case ESP_RST_TASK_WDT:  return "task_wdt";
+        case ESP_RST_WDT:       return "wdt";
+        case ESP_RST_DEEPSLEEP: return "deepsleep";
+        case ESP_RST_BROWNOUT:  return "brownout";
+        case ESP_RST_SDIO:      return "sdio";
+        default:                return "unknown";
+    }
+#endif
+}
+
+// Strings read back after a reset are bounded by their slot, whatever they hold
+static void add_name(cJSON *item, const char *key, const char *name, size_t size) {
+    char text[32];
+    size_t len = strnlen(name, size - 1);
+    memcpy(text, name, len);
+    text[len] = '\0';
+    cJSON_AddStringToObject(item, key, text);
+}
+
+char* crash_journal_render_json(void) {
+    journal_t *journal = s_journal;
+    if (!journal) {
+        return NULL;
+    }
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "boot", journal->boot);
+    cJSON_AddStringToObject(root, "resetReason", reset_reason_name());
+    cJSON *entries = cJSON_AddArrayToObject(root, "entries");
+
+    // Oldest first: the slot after the newest one is the oldest
+    uint32_t newest = __atomic_load_n(&journal->next_seq, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 1; i <= CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL_ENTRIES; i++) {
+        const journal_entry_t *entry = &journal->entries[(newest + i) % CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL_ENTRIES];
+        uint32_t seq = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0) {
+            continue;
+        }
+
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "seq", seq);
+        cJSON_AddNumberToObject(item, "boot", entry->boot);
+        add_name(item, "method", entry->method, sizeof(entry->method));
+        if (entry->tool[0]) {
+            add_name(item, "tool", entry->tool, sizeof(entry->tool));
+        }
+        if (entry->id_kind == ID_NUMBER) {
+            cJSON_AddNumberToObject(item, "id", (double)entry->id.number);
+        } else if (entry->id_kind == ID_STRING) {
+            add_name(item, "id", entry->id.text, sizeof(entry->id.text));
+        }
+        cJSON_AddNumberToObject(item, "uptimeMs", entry->uptime_ms);
+        if (entry->wall_time) {
+            cJSON_AddNumberToObject(item, "wallTime", entry->wall_time);
+        }
+
+        if (entry->status != 0) {
+            cJSON_AddNumberToObject(item, "status", entry->status);
+            cJSON_AddNumberToObject(item, "durationMs", entry->duration_ms);
+        } else {
+            // Still running in this boot, or cut short by the reset that ended its boot
+            cJSON_AddStringToObject(item, "outcome", entry->boot == journal->boot ? "in_progress" : "interrupted");
+        }
+        cJSON_AddItemToArray(entries, item);
+    }
+
+    char *text = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return text;
+}
+
+#endif // CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL
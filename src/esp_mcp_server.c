@@ -3,64 +3,176 @@
  * @brief ESP32 MCP Server Component - Unified Implementation
  */
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <sys/param.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
 #include "esp_log.h"
 #include "esp_http_server.h"
+#if CONFIG_ESP_HTTPS_SERVER_ENABLE
+#include "esp_https_server.h"
+#endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "esp_timer.h"
 #include "esp_chip_info.h"
 #include "esp_system.h"
 #include "esp_idf_version.h"
 #include "cJSON.h"
 #include "json_rpc.h"
+#include "json_writer.h"
 #include "uri_template.h"
+#include "completion_index.h"
+#include "telemetry.h"
+#include "alloc_profiler.h"
+#include "stack_profiler.h"
+#include "request_arena.h"
+#include "mcp_transport.h"
+#include "mcp_auth.h"
+#include "content_writer.h"
+#include "traffic_capture.h"
+#include "crash_journal.h"
+#include "log_tail.h"
+#include "mcp_outbound.h"
+#include "single_flight.h"
+#include "fs_resource.h"
+#include "partition_resource.h"
+#include "arg_stream.h"
 #include "esp_mcp_server.h"
 
 static const char *TAG = "ESP_MCP_SERVER";
 
+// The GET /mcp event stream outlives its handler, which needs the httpd async request API
+#define MCP_EVENT_STREAM_SUPPORTED (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0))
+
+// Per-request progress messages, compiled out (format strings included) without verbose logging
+#if CONFIG_ESP_MCP_SERVER_VERBOSE_LOG
+#define MCP_LOG_REQUEST(format, ...) ESP_LOGI(TAG, format, ##__VA_ARGS__)
+#else
+#define MCP_LOG_REQUEST(format, ...) do { } while (0)
+#endif
+
+// Registered tool
+typedef struct {
+    char *name;
+    char *title;
+    char *description;
+    cJSON *input_schema;
+    esp_mcp_tool_handler_t handler;
+    esp_mcp_streaming_tool_handler_t stream_handler;
+    void *user_data;
+    bool coalesce;
+#if CONFIG_ESP_MCP_SERVER_STREAM_ARGUMENTS
+    char *stream_argument;               // Argument written to stream_sink instead of passed to the handler
+    bool stream_base64;
+    esp_mcp_argument_sink_t stream_sink;
+    TaskHandle_t stream_owner;           // Task whose call holds stream_sink (NULL when idle)
+    bool stream_begun;                   // stream_sink.begin succeeded, so a failed call must abort
+    bool stream_received;                // The value reached the sink, possibly while the body arrived
+    esp_err_t stream_error;              // First error of the sink or the decoder
+#endif
+} mcp_tool_entry_t;
+
+// Registered resource
+typedef struct {
+    char *uri_template;
+    char *name;
+    char *title;
+    char *description;
+    char *mime_type;
+    esp_mcp_resource_handler_t handler;
+    void *user_data;
+#if CONFIG_ESP_MCP_SERVER_FS_RESOURCES
+    fs_resource_t *fs;                   // Set instead of handler for a filesystem provider
+#endif
+#if CONFIG_ESP_MCP_SERVER_PARTITION_RESOURCES
+    partition_resource_t *partition;     // Set instead of handler for a flash partition range
+#endif
+} mcp_resource_entry_t;
+
 // Internal server context structure
 typedef struct {
     httpd_handle_t http_server;
+    mcp_lite_transport_t *lite_transport; // Set instead of http_server for ESP_MCP_TRANSPORT_LITE
     esp_mcp_server_config_t config;
     bool is_running;                     // Server running state
+#if CONFIG_ESP_MCP_SERVER_BUILTINS
+    telemetry_sampler_t *telemetry;      // Background sampler for built-ins (NULL if disabled)
+#endif
+    mcp_auth_t *auth;                    // Bearer-token authenticator (NULL if auth is disabled)
+#if CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+    traffic_capture_t *capture;          // Ring buffer of recent requests
+#endif
+    mcp_outbound_t *outbound;            // Server-initiated requests awaiting a response (NULL if disabled)
+    single_flight_t *flights;            // Coalescing of identical concurrent reads (NULL if disabled)
+    httpd_req_t *event_stream;           // Open GET /mcp event stream, if any
+    SemaphoreHandle_t event_stream_lock; // Serializes writes to and replacement of event_stream
+#if CONFIG_ESP_MCP_SERVER_MIDDLEWARE
+    esp_mcp_middleware_t middleware[CONFIG_ESP_MCP_SERVER_MAX_MIDDLEWARE];
+    uint8_t middleware_count;            // Fixed once the server starts, so dispatch reads it unlocked
+#endif
+#if CONFIG_ESP_MCP_SERVER_STREAM_ARGUMENTS
+    SemaphoreHandle_t stream_lock;       // Guards the stream_owner of tools (created with the first such tool)
+    uint32_t stream_claims;              // Tools whose sink is held by a call
+#endif
 
     // Registered tools and resources
-    struct {
-        char *name;
-        char *title;
-        char *description;
-        cJSON *input_schema;
-        esp_mcp_tool_handler_t handler;
-        void *user_data;
-    } *tools;
+#if CONFIG_ESP_MCP_SERVER_STATIC_REGISTRY
+    mcp_tool_entry_t tools[CONFIG_ESP_MCP_SERVER_MAX_TOOLS];
+    mcp_resource_entry_t resources[CONFIG_ESP_MCP_SERVER_MAX_RESOURCES];
+#else
+    mcp_tool_entry_t *tools;
+    mcp_resource_entry_t *resources;
+#endif
     size_t tool_count;
     size_t tool_capacity;
+    size_t resource_count;
+    size_t resource_capacity;
 
+    // Content hash of what tools/list and resources/list return, updated on registration
+    uint32_t tools_hash;
+    uint32_t resources_hash;
+    char catalog_hash[9];
+
+#if CONFIG_ESP_MCP_SERVER_COMPLETIONS
+    // Completion candidates for resource template variables
     struct {
         char *uri_template;
-        char *name;
-        char *title;
-        char *description;
-        char *mime_type;
-        esp_mcp_resource_handler_t handler;
-        void *user_data;
-    } *resources;
-    size_t resource_count;
-    size_t resource_capacity;
+        char *argument;
+        completion_index_t index;
+    } *completions;
+    size_t completion_count;
+    size_t completion_capacity;
+#endif
 
     // Session management
     uint16_t active_sessions;
+#if CONFIG_ESP_MCP_SERVER_STEADY_STATE
+    struct mcp_conn_ctx *conn_slots;     // max_sessions connection states reserved at start
+#endif
+
+    // Request counters
+    uint32_t total_requests;
+    uint32_t failed_requests;
+    uint32_t tls_handshakes;
+    uint32_t auth_rejected;
 } mcp_server_ctx_t;
 
 // Forward declarations for MCP protocol handlers
-static cJSON* handle_initialize(const cJSON *params, const cJSON *id, void *user_data);
-static cJSON* handle_initialized(const cJSON *params, const cJSON *id, void *user_data);
-static cJSON* handle_ping(const cJSON *params, const cJSON *id, void *user_data);
-static cJSON* handle_list_tools(const cJSON *params, const cJSON *id, void *user_data);
-static cJSON* handle_call_tool(const cJSON *params, const cJSON *id, void *user_data);
-static cJSON* handle_list_resources(const cJSON *params, const cJSON *id, void *user_data);
-static cJSON* handle_read_resource(const cJSON *params, const cJSON *id, void *user_data);
+static cJSON* handle_initialize(jsonrpc_msg_t *msg, void *user_data);
+static cJSON* handle_initialized(jsonrpc_msg_t *msg, void *user_data);
+static cJSON* handle_ping(jsonrpc_msg_t *msg, void *user_data);
+static cJSON* handle_list_tools(jsonrpc_msg_t *msg, void *user_data);
+static cJSON* handle_call_tool(jsonrpc_msg_t *msg, void *user_data);
+static cJSON* handle_list_resources(jsonrpc_msg_t *msg, void *user_data);
+static cJSON* handle_read_resource(jsonrpc_msg_t *msg, void *user_data);
+#if CONFIG_ESP_MCP_SERVER_COMPLETIONS
+static cJSON* handle_complete(jsonrpc_msg_t *msg, void *user_data);
+#endif
 
 // JSON-RPC method table
 static const jsonrpc_method_t mcp_methods[] = {
@@ -71,10 +183,80 @@ static const jsonrpc_method_t mcp_methods[] = {
     {"tools/call", handle_call_tool},
     {"resources/list", handle_list_resources},
     {"resources/read", handle_read_resource},
+#if CONFIG_ESP_MCP_SERVER_COMPLETIONS
+    {"completion/complete", handle_complete},
+#endif
 };
 
+// Initial number of tool and resource slots when the registry grows on demand
+#define MCP_REGISTRY_INITIAL_CAPACITY 8
+
+// Initial size of a connection's receive buffer, doubled on demand up to conn_buffer_max_size
+#define MCP_CONN_BUFFER_INITIAL_SIZE 512
+
+// Per-connection state attached to the httpd session context
+typedef struct mcp_conn_ctx {
+    void *server;                        // Owning mcp_server_ctx_t
+    char *recv_buf;                      // Reused request body buffer
+    size_t recv_capacity;
+} mcp_conn_ctx_t;
+
+// Task settings of the lite transport's listener and workers, unless set in the config
+#define MCP_LITE_TASK_STACK_SIZE 6144
+#define MCP_LITE_TASK_PRIORITY 5
+
+// TCP keep-alive probing for HTTPS sessions, so dead peers release their TLS context
+#define MCP_TLS_KEEP_ALIVE_IDLE_SEC 30
+#define MCP_TLS_KEEP_ALIVE_INTERVAL_SEC 5
+#define MCP_TLS_KEEP_ALIVE_COUNT 3
+
+// Streamed tool results are sent in chunks of up to this size
+#define MCP_STREAM_CHUNK_SIZE 1024
+
+// Maximum number of values returned by completion/complete (MCP limit)
+#define MCP_COMPLETION_MAX_VALUES 100
+
 static const size_t mcp_methods_count = sizeof(mcp_methods) / sizeof(mcp_methods[0]);
 
+// Connections currently attached to the server, for either transport
+static uint16_t current_active_sessions(mcp_server_ctx_t *ctx) {
+    if (ctx->lite_transport) {
+        return mcp_lite_transport_open_connections(ctx->lite_transport);
+    }
+    return ctx->active_sessions;
+}
+
+#if CONFIG_ESP_MCP_SERVER_BUILTINS
+// Counter source for the telemetry sampler
+static void read_server_counters(telemetry_server_counters_t *counters, void *arg) {
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)arg;
+    if (!ctx) {
+        return;
+    }
+
+    counters->active_sessions = current_active_sessions(ctx);
+    counters->total_requests = ctx->total_requests;
+    counters->failed_requests = ctx->failed_requests;
+
+    if (ctx->lite_transport) {
+        counters->open_sockets = mcp_lite_transport_open_connections(ctx->lite_transport);
+    } else if (ctx->http_server) {
+        int client_fds[CONFIG_LWIP_MAX_SOCKETS];
+        size_t fds = sizeof(client_fds) / sizeof(client_fds[0]);
+        if (httpd_get_client_list(ctx->http_server, &fds, client_fds) == ESP_OK) {
+            counters->open_sockets = fds;
+        }
+    }
+}
+
+// Copy the latest telemetry snapshot, or sample on demand if no sampler is running
+static void render_system_view(mcp_server_ctx_t *ctx, telemetry_view_t view, char *buf, size_t buf_len) {
+    if (ctx && ctx->telemetry && telemetry_sampler_copy(ctx->telemetry, view, buf, buf_len) > 0) {
+        return;
+    }
+    telemetry_render_now(view, read_server_counters, ctx, buf, buf_len);
+}
+
 // Built-in system info tool
 static cJSON* builtin_system_info_tool(const cJSON *arguments, void *user_data) {
     cJSON *result = cJSON_CreateObject();
@@ -86,17 +268,8 @@ static cJSON* builtin_system_info_tool(const cJSON *arguments, void *user_data)
     cJSON *content = cJSON_CreateObject();
     cJSON_AddStringToObject(content, "type", "text");
 
-    char info_text[512];
-    snprintf(info_text, sizeof(info_text),
-            "ESP32 System Information:\n"
-            "- Free heap: %" PRIu32 " bytes\n"
-            "- Minimum free heap: %" PRIu32 " bytes\n"
-            "- Uptime: %" PRId64 " ms\n"
-            "- IDF Version: %s\n",
-            esp_get_free_heap_size(),
-            esp_get_minimum_free_heap_size(),
-            esp_timer_get_time() / 1000,
-            esp_get_idf_version());
+    char info_text[TELEMETRY_SYSTEM_INFO_LEN];
+    render_system_view((mcp_server_ctx_t *)user_data, TELEMETRY_VIEW_SYSTEM_INFO, info_text, sizeof(info_text));
 
     cJSON_AddStringToObject(content, "text", info_text);
     cJSON_AddItemToArray(content_array, content);
@@ -107,39 +280,100 @@ static cJSON* builtin_system_info_tool(const cJSON *arguments, void *user_data)
 
 // Built-in system status resource
 static char* builtin_system_status_resource(const char *uri, void *user_data) {
-    char *status_text = malloc(1024);
+    char *status_text = MCP_MALLOC(TELEMETRY_SYSTEM_STATUS_LEN);
     if (!status_text) {
         return NULL;
     }
 
-    esp_chip_info_t chip_info;
-    esp_chip_info(&chip_info);
-    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)user_data;
+    render_system_view((mcp_server_ctx_t *)user_data, TELEMETRY_VIEW_SYSTEM_STATUS, status_text, TELEMETRY_SYSTEM_STATUS_LEN);
+    return status_text;
+}
+#endif
 
-    snprintf(status_text, 1024,
-            "ESP32 System Status Report\n"
-            "==========================\n"
-            "Free Heap: %" PRIu32 " bytes\n"
-            "Min Free Heap: %" PRIu32 " bytes\n"
-            "Uptime: %" PRId64 " ms\n"
-            "IDF Version: %s\n"
-            "Active Sessions: %d\n"
-            "Chip Model: %s\n"
-            "Chip Revision: %d\n",
-            esp_get_free_heap_size(),
-            esp_get_minimum_free_heap_size(),
-            esp_timer_get_time() / 1000,
-            esp_get_idf_version(),
-            ctx ? ctx->active_sessions : 0,
-            CONFIG_IDF_TARGET,
-            chip_info.revision);
+#define CATALOG_HASH_BASIS 2166136261u
 
-    return status_text;
+// FNV-1a over a field and its terminator, so that ("ab", "c") and ("a", "bc") differ
+static uint32_t catalog_hash_string(uint32_t hash, const char *str) {
+    if (str) {
+        while (*str) {
+            hash = (hash ^ (uint8_t)*str++) * 16777619u;
+        }
+    }
+    return (hash ^ (str ? 0 : 1)) * 16777619u;
+}
+
+static uint32_t catalog_hash_word(uint32_t hash, uint32_t word) {
+    for (int i = 0; i < 4; i++) {
+        hash = (hash ^ (uint8_t)(word >> (8 * i))) * 16777619u;
+    }
+    return hash;
+}
+
+static void update_catalog_hash(mcp_server_ctx_t *ctx) {
+    uint32_t hash = CATALOG_HASH_BASIS;
+    // Built-in entries are part of the lists depending on the configuration alone
+#if CONFIG_ESP_MCP_SERVER_BUILTINS
+    hash = catalog_hash_string(hash, "builtins");
+#endif
+#if CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER
+    hash = catalog_hash_string(hash, "alloc_profile");
+#endif
+#if CONFIG_ESP_MCP_SERVER_STACK_PROFILER
+    hash = catalog_hash_string(hash, "stack_profile");
+#endif
+#if CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+    hash = catalog_hash_string(hash, "traffic_capture");
+#endif
+#if CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL
+    hash = catalog_hash_string(hash, "crash_journal");
+#endif
+#if CONFIG_ESP_MCP_SERVER_LOG_TAIL
+    hash = catalog_hash_string(hash, "log_tail");
+#endif
+    hash = catalog_hash_word(hash, ctx->tools_hash);
+    hash = catalog_hash_word(hash, ctx->resources_hash);
+    snprintf(ctx->catalog_hash, sizeof(ctx->catalog_hash), "%08" PRIx32, hash);
+}
+
+// String member of params._meta, read from the tokens
+static const char* get_meta_string(const jsonrpc_msg_t *msg, const char *key) {
+    int meta = json_token_find(msg->buf, msg->tokens, msg->params_token, "_meta");
+    return json_token_string(msg->buf, msg->tokens, json_token_find(msg->buf, msg->tokens, meta, key));
+}
+
+static void add_catalog_meta(mcp_server_ctx_t *ctx, cJSON *result, bool unchanged) {
+    cJSON *meta = cJSON_CreateObject();
+    cJSON_AddStringToObject(meta, "catalogHash", ctx->catalog_hash);
+    if (unchanged) {
+        cJSON_AddBoolToObject(meta, "unchanged", true);
+    }
+    cJSON_AddItemToObject(result, "_meta", meta);
+}
+
+/**
+ * @brief Short-circuit a list request whose client already holds the current catalog
+ *
+ * Clients that remember the catalogHash of an earlier initialize or list
+ * result send it back in params._meta; if it still matches, the reply carries
+ * an empty list flagged as unchanged instead of the whole catalog.
+ */
+static cJSON* create_unchanged_list_result(mcp_server_ctx_t *ctx, jsonrpc_msg_t *msg, const char *list) {
+    const char *known = get_meta_string(msg, "catalogHash");
+    if (!ctx || !known || strcmp(known, ctx->catalog_hash) != 0) {
+        return NULL;
+    }
+
+    cJSON *result = cJSON_CreateObject();
+    if (result) {
+        cJSON_AddItemToObject(result, list, cJSON_CreateArray());
+        add_catalog_meta(ctx, result, true);
+    }
+    return result;
 }
 
 // MCP protocol handlers implementation
-static cJSON* handle_initialize(const cJSON *params, const cJSON *id, void *user_data) {
-    ESP_LOGI(TAG, "Initialize request");
+static cJSON* handle_initialize(jsonrpc_msg_t *msg, void *user_data) {
+    MCP_LOG_REQUEST("Initialize request");
 
     cJSON *result = cJSON_CreateObject();
     if (!result) {
@@ -157,6 +391,10 @@ static cJSON* handle_initialize(const cJSON *params, const cJSON *id, void *user
     cJSON_AddBoolToObject(resources, "listChanged", false);
     cJSON_AddItemToObject(capabilities, "resources", resources);
 
+#if CONFIG_ESP_MCP_SERVER_COMPLETIONS
+    cJSON_AddItemToObject(capabilities, "completions", cJSON_CreateObject());
+#endif
+
     cJSON_AddItemToObject(result, "capabilities", capabilities);
 
     // Server info
@@ -169,27 +407,36 @@ static cJSON* handle_initialize(const cJSON *params, const cJSON *id, void *user
     // Protocol version
     cJSON_AddStringToObject(result, "protocolVersion", "2025-06-18");
 
+    if (ctx) {
+        add_catalog_meta(ctx, result, false);
+    }
+
     return result;
 }
 
-static cJSON* handle_initialized(const cJSON *params, const cJSON *id, void *user_data) {
-    ESP_LOGI(TAG, "Initialized notification");
+static cJSON* handle_initialized(jsonrpc_msg_t *msg, void *user_data) {
+    MCP_LOG_REQUEST("Initialized notification");
     return NULL; // Notifications don't return responses
 }
 
-static cJSON* handle_ping(const cJSON *params, const cJSON *id, void *user_data) {
-    ESP_LOGI(TAG, "Ping request");
+static cJSON* handle_ping(jsonrpc_msg_t *msg, void *user_data) {
+    MCP_LOG_REQUEST("Ping request");
 
     // According to MCP specification, ping should return an empty object
     cJSON *result = cJSON_CreateObject();
     return result;
 }
 
-static cJSON* handle_list_tools(const cJSON *params, const cJSON *id, void *user_data) {
-    ESP_LOGI(TAG, "Listing tools");
+static cJSON* handle_list_tools(jsonrpc_msg_t *msg, void *user_data) {
+    MCP_LOG_REQUEST("Listing tools");
 
     mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)user_data;
-    cJSON *result = cJSON_CreateObject();
+    cJSON *result = create_unchanged_list_result(ctx, msg, "tools");
+    if (result) {
+        return result;
+    }
+
+    result = cJSON_CreateObject();
     if (!result) {
         return NULL;
     }
@@ -214,6 +461,7 @@ static cJSON* handle_list_tools(const cJSON *params, const cJSON *id, void *user
         }
     }
 
+#if CONFIG_ESP_MCP_SERVER_BUILTINS
     // Add built-in system info tool if no custom tools registered
     if (cJSON_GetArraySize(tools_array) == 0) {
         cJSON *tool = cJSON_CreateObject();
@@ -228,73 +476,325 @@ static cJSON* handle_list_tools(const cJSON *params, const cJSON *id, void *user
 
         cJSON_AddItemToArray(tools_array, tool);
     }
+#endif
 
     cJSON_AddItemToObject(result, "tools", tools_array);
+    if (ctx) {
+        add_catalog_meta(ctx, result, false);
+    }
+    return result;
+}
+
+static cJSON* create_invalid_params_result(const char *message) {
+    cJSON *error_result = cJSON_CreateObject();
+    if (error_result) {
+        cJSON_AddStringToObject(error_result, "_jsonrpc_error", "invalid_params");
+        cJSON_AddStringToObject(error_result, "message", message);
+    }
+    return error_result;
+}
+
+// Validate tool arguments against the tool's input schema, returning an error result on failure
+static cJSON* validate_tool_arguments(mcp_server_ctx_t *ctx, size_t tool_idx, const cJSON *arguments) {
+#if CONFIG_ESP_MCP_SERVER_SCHEMA_VALIDATION
+    if (!ctx->tools[tool_idx].input_schema) {
+        return NULL;
+    }
+
+    schema_validation_result_t validation_result;
+    esp_err_t ret = schema_validate_tool_arguments(arguments, ctx->tools[tool_idx].input_schema, &validation_result);
+    if (ret == ESP_OK && validation_result.error == SCHEMA_VALIDATION_OK) {
+        return NULL;
+    }
+
+    ESP_LOGW(TAG, "Tool '%s' argument validation failed: %s",
+            ctx->tools[tool_idx].name, validation_result.error_message);
+
+    // Create error data with validation details
+    cJSON *error_data = cJSON_CreateObject();
+    if (error_data) {
+        cJSON_AddStringToObject(error_data, "tool", ctx->tools[tool_idx].name);
+        cJSON_AddStringToObject(error_data, "details", validation_result.error_message);
+        if (validation_result.error_path) {
+            cJSON_AddStringToObject(error_data, "path", validation_result.error_path);
+        }
+    }
+
+    // This will be handled by JSON-RPC layer with proper error code
+    cJSON *error_result = create_invalid_params_result("Invalid tool arguments");
+    if (error_result && error_data) {
+        cJSON_AddItemToObject(error_result, "data", error_data);
+    } else {
+        cJSON_Delete(error_data);
+    }
+    return error_result;
+#else
+    return NULL;
+#endif
+}
+
+static cJSON* run_tool_handler(mcp_server_ctx_t *ctx, size_t tool_idx, const cJSON *arguments) {
+    alloc_profiler_tool_begin();
+    cJSON *tool_result = ctx->tools[tool_idx].handler(arguments, ctx->tools[tool_idx].user_data);
+    alloc_profiler_tool_end(ctx->tools[tool_idx].name);
+    stack_profiler_tool_end(ctx->tools[tool_idx].name);
+    return tool_result;
+}
+
+typedef struct {
+    mcp_server_ctx_t *ctx;
+    size_t tool_idx;
+    const cJSON *arguments;
+} coalesced_tool_call_t;
+
+// Leader of a coalesced call: run the handler and render its result for every caller
+static void* render_tool_call(void *arg) {
+    coalesced_tool_call_t *call = (coalesced_tool_call_t *)arg;
+    cJSON *tool_result = run_tool_handler(call->ctx, call->tool_idx, call->arguments);
+    if (!tool_result) {
+        return NULL;
+    }
+    char *text = json_writer_print(tool_result);
+    cJSON_Delete(tool_result);
+    return text;
+}
+
+// Calls are identical when the tool name and the serialized arguments match
+static cJSON* call_tool_coalesced(mcp_server_ctx_t *ctx, size_t tool_idx, const cJSON *arguments) {
+    char *args_text = arguments ? json_writer_print(arguments) : NULL;
+    size_t key_len = strlen(ctx->tools[tool_idx].name) + (args_text ? strlen(args_text) : 0) + 2;
+    char *key = MCP_MALLOC(key_len);
+    if (!key) {
+        cJSON_free(args_text);
+        return run_tool_handler(ctx, tool_idx, arguments);
+    }
+    snprintf(key, key_len, "%s\n%s", ctx->tools[tool_idx].name, args_text ? args_text : "");
+    cJSON_free(args_text);
+
+    coalesced_tool_call_t call = {ctx, tool_idx, arguments};
+    single_flight_call_t *flight;
+    char *text = single_flight_do(ctx->flights, key, render_tool_call, &call, &flight);
+
+    // Each caller embeds its own copy, so the shared text can be released independently
+    cJSON *tool_result = text ? cJSON_CreateRaw(text) : NULL;
+    if (single_flight_done(ctx->flights, flight)) {
+        cJSON_free(text);
+    }
+    MCP_FREE(key);
+    return tool_result;
+}
+
+#if CONFIG_ESP_MCP_SERVER_STREAM_ARGUMENTS
+// Tool result reporting a failure to the model rather than a protocol error
+static cJSON* create_tool_error_result(const char *text) {
+    cJSON *result = cJSON_CreateObject();
+    if (result) {
+        cJSON *content_array = cJSON_CreateArray();
+        cJSON *content = cJSON_CreateObject();
+        cJSON_AddStringToObject(content, "type", "text");
+        cJSON_AddStringToObject(content, "text", text);
+        cJSON_AddItemToArray(content_array, content);
+        cJSON_AddItemToObject(result, "content", content_array);
+        cJSON_AddBoolToObject(result, "isError", true);
+    }
     return result;
 }
 
-static cJSON* handle_call_tool(const cJSON *params, const cJSON *id, void *user_data) {
-    ESP_LOGI(TAG, "Tool call request");
+// Make the calling task the one call feeding a tool's sink; false if another call holds it
+static bool claim_stream_sink(mcp_server_ctx_t *ctx, mcp_tool_entry_t *tool) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    xSemaphoreTake(ctx->stream_lock, portMAX_DELAY);
+    bool claimed = !tool->stream_owner || tool->stream_owner == self;
+    if (!tool->stream_owner) {
+        tool->stream_owner = self;
+        tool->stream_begun = false;
+        tool->stream_received = false;
+        tool->stream_error = ESP_OK;
+        ctx->stream_claims++;
+    }
+    xSemaphoreGive(ctx->stream_lock);
+    return claimed;
+}
+
+static esp_err_t begin_stream_sink(mcp_tool_entry_t *tool) {
+    esp_err_t ret = tool->stream_sink.begin ? tool->stream_sink.begin(tool->user_data) : ESP_OK;
+    tool->stream_begun = ret == ESP_OK;
+    tool->stream_received = true;
+    return ret;
+}
+
+// Give a sink up; a call that did not get to run its handler aborts what it began
+static void release_stream_sink(mcp_server_ctx_t *ctx, mcp_tool_entry_t *tool, bool aborted) {
+    if (aborted && tool->stream_begun && tool->stream_sink.abort) {
+        tool->stream_sink.abort(tool->user_data);
+    }
+    xSemaphoreTake(ctx->stream_lock, portMAX_DELAY);
+    tool->stream_owner = NULL;
+    ctx->stream_claims--;
+    xSemaphoreGive(ctx->stream_lock);
+}
+
+// Run once a request is done: sinks the calling task still holds belong to calls that failed
+static void release_stream_sinks(mcp_server_ctx_t *ctx) {
+    if (ctx->stream_claims == 0) {
+        return;
+    }
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (size_t i = 0; i < ctx->tool_count; i++) {
+        if (ctx->tools[i].stream_owner == self) {
+            release_stream_sink(ctx, &ctx->tools[i], true);
+        }
+    }
+}
+
+// Body splitter callback: divert the value if it is the stream argument of the tool being called
+static esp_err_t claim_body_argument(void *arg, const char *tool_name, const char *argument,
+                                     const esp_mcp_argument_sink_t **sink, void **user_data, bool *base64) {
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)arg;
+    for (size_t i = 0; i < ctx->tool_count; i++) {
+        mcp_tool_entry_t *tool = &ctx->tools[i];
+        if (!tool->stream_argument || strcmp(tool->name, tool_name) != 0 || strcmp(tool->stream_argument, argument) != 0) {
+            continue;
+        }
+        // A busy sink leaves the value in the body, and the call then reports it
+        if (!claim_stream_sink(ctx, tool)) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        *sink = &tool->stream_sink;
+        *user_data = tool->user_data;
+        *base64 = tool->stream_base64;
+        return begin_stream_sink(tool);
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+// Record the outcome of a value diverted while the body arrived, for the call to report
+static void end_body_argument(mcp_server_ctx_t *ctx, esp_err_t error) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (size_t i = 0; i < ctx->tool_count; i++) {
+        if (ctx->tools[i].stream_owner == self && ctx->tools[i].stream_error == ESP_OK) {
+            ctx->tools[i].stream_error = error;
+        }
+    }
+}
+
+// Detach a tool's stream argument from its arguments, leaving "" for validation and the handler
+static cJSON* take_stream_argument(mcp_server_ctx_t *ctx, size_t tool_idx, cJSON *arguments) {
+    const char *name = ctx->tools[tool_idx].stream_argument;
+    if (!name || !cJSON_IsString(cJSON_GetObjectItem(arguments, name))) {
+        return NULL;
+    }
+    cJSON *value = cJSON_DetachItemFromObject(arguments, name);
+    cJSON_AddStringToObject(arguments, name, "");
+    return value;
+}
 
-    if (!params) {
+/**
+ * @brief Write a tool's stream argument to its sink, unless it got there while the body arrived
+ *
+ * @return NULL when the handler may run, otherwise the error result of the call
+ */
+static cJSON* deliver_stream_argument(mcp_server_ctx_t *ctx, size_t tool_idx, cJSON *value) {
+    mcp_tool_entry_t *tool = &ctx->tools[tool_idx];
+    if (!tool->stream_argument) {
         return NULL;
     }
+    if (!claim_stream_sink(ctx, tool)) {
+        return create_tool_error_result("Tool is busy receiving another streamed argument");
+    }
+
+    if (!tool->stream_received) {
+        esp_err_t ret = begin_stream_sink(tool);
+        if (ret == ESP_OK && value) {
+            ret = arg_stream_deliver(&tool->stream_sink, tool->user_data, tool->stream_base64,
+                                     value->valuestring, strlen(value->valuestring));
+        }
+        tool->stream_error = ret;
+    }
+
+    if (tool->stream_error != ESP_OK) {
+        // The sink is aborted once the request is done
+        char text[128];
+        snprintf(text, sizeof(text), "Streamed argument '%s' failed: %s", tool->stream_argument,
+                 esp_err_to_name(tool->stream_error));
+        return create_tool_error_result(text);
+    }
+    return NULL;
+}
 
-    cJSON *name = cJSON_GetObjectItem(params, "name");
-    if (!name || !cJSON_IsString(name)) {
+// The handler ran, so the sink's data was taken over
+static void finish_stream_argument(mcp_server_ctx_t *ctx, size_t tool_idx) {
+    if (ctx->tools[tool_idx].stream_argument) {
+        release_stream_sink(ctx, &ctx->tools[tool_idx], false);
+    }
+}
+#else
+#define take_stream_argument(ctx, tool_idx, arguments) ((cJSON *)NULL)
+#define deliver_stream_argument(ctx, tool_idx, value) ((cJSON *)NULL)
+#define finish_stream_argument(ctx, tool_idx)
+#define release_stream_sinks(ctx) ((void)(ctx))
+#endif
+
+static cJSON* handle_call_tool(jsonrpc_msg_t *msg, void *user_data) {
+    MCP_LOG_REQUEST("Tool call request");
+
+    const char *name = jsonrpc_get_param_string(msg, "name");
+    if (!name) {
         return NULL;
     }
 
-    cJSON *arguments = cJSON_GetObjectItem(params, "arguments");
     mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)user_data;
 
     // First, try registered tools
     if (ctx) {
         for (size_t i = 0; i < ctx->tool_count; i++) {
-            if (strcmp(ctx->tools[i].name, name->valuestring) == 0) {
+            if (strcmp(ctx->tools[i].name, name) == 0) {
                 if (ctx->tools[i].handler) {
+                    // Only the arguments are converted to cJSON, for the handler
+                    cJSON *arguments = jsonrpc_build_param(msg, "arguments");
+                    cJSON *streamed_value = take_stream_argument(ctx, i, arguments);
+
                     // Validate arguments against input schema if provided
-                    if (ctx->tools[i].input_schema) {
-                        schema_validation_result_t validation_result;
-                        esp_err_t ret = schema_validate_tool_arguments(arguments, ctx->tools[i].input_schema, &validation_result);
-
-                        if (ret != ESP_OK || validation_result.error != SCHEMA_VALIDATION_OK) {
-                            ESP_LOGW(TAG, "Tool '%s' argument validation failed: %s",
-                                    ctx->tools[i].name, validation_result.error_message);
-
-                            // Create error data with validation details
-                            cJSON *error_data = cJSON_CreateObject();
-                            if (error_data) {
-                                cJSON_AddStringToObject(error_data, "tool", ctx->tools[i].name);
-                                cJSON_AddStringToObject(error_data, "details", validation_result.error_message);
-                                if (validation_result.error_path) {
-                                    cJSON_AddStringToObject(error_data, "path", validation_result.error_path);
-                                }
-                            }
-
-                            // This will be handled by JSON-RPC layer with proper error code
-                            cJSON *error_result = cJSON_CreateObject();
-                            if (error_result) {
-                                cJSON_AddStringToObject(error_result, "_jsonrpc_error", "invalid_params");
-                                cJSON_AddStringToObject(error_result, "message", "Invalid tool arguments");
-                                if (error_data) {
-                                    cJSON_AddItemToObject(error_result, "data", error_data);
-                                }
-                            }
-                            return error_result;
-                        }
+                    cJSON *error_result = validate_tool_arguments(ctx, i, arguments);
+                    if (!error_result) {
+                        error_result = deliver_stream_argument(ctx, i, streamed_value);
+                    }
+                    cJSON_Delete(streamed_value);
+                    if (error_result) {
+                        cJSON_Delete(arguments);
+                        return error_result;
+                    }
+
+                    if (ctx->tools[i].coalesce && ctx->flights) {
+                        cJSON *tool_result = call_tool_coalesced(ctx, i, arguments);
+                        cJSON_Delete(arguments);
+                        return tool_result;
                     }
 
-                    return ctx->tools[i].handler(arguments, ctx->tools[i].user_data);
+                    cJSON *tool_result = run_tool_handler(ctx, i, arguments);
+                    finish_stream_argument(ctx, i);
+                    cJSON_Delete(arguments);
+                    return tool_result;
+                }
+                if (ctx->tools[i].stream_handler) {
+                    // Streaming tools are served by dispatch_request; this is only
+                    // reached for requests that cannot carry a streamed response
+                    cJSON *arguments = jsonrpc_build_param(msg, "arguments");
+                    cJSON *error_result = validate_tool_arguments(ctx, i, arguments);
+                    cJSON_Delete(arguments);
+                    return error_result ? error_result :
+                           create_invalid_params_result("Streaming tool requires a request id and a streaming transport");
                 }
             }
         }
     }
 
+#if CONFIG_ESP_MCP_SERVER_BUILTINS
     // Fallback to built-in tools
-    if (strcmp(name->valuestring, "get_system_info") == 0) {
-        return builtin_system_info_tool(arguments, user_data);
+    if (strcmp(name, "get_system_info") == 0) {
+        return builtin_system_info_tool(NULL, user_data);
     }
+#endif
 
     // Tool not found
     cJSON *result = cJSON_CreateObject();
@@ -304,11 +804,16 @@ static cJSON* handle_call_tool(const cJSON *params, const cJSON *id, void *user_
     return result;
 }
 
-static cJSON* handle_list_resources(const cJSON *params, const cJSON *id, void *user_data) {
-    ESP_LOGI(TAG, "Listing resources");
+static cJSON* handle_list_resources(jsonrpc_msg_t *msg, void *user_data) {
+    MCP_LOG_REQUEST("Listing resources");
 
     mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)user_data;
-    cJSON *result = cJSON_CreateObject();
+    cJSON *result = create_unchanged_list_result(ctx, msg, "resources");
+    if (result) {
+        return result;
+    }
+
+    result = cJSON_CreateObject();
     if (!result) {
         return NULL;
     }
@@ -334,6 +839,7 @@ static cJSON* handle_list_resources(const cJSON *params, const cJSON *id, void *
         }
     }
 
+#if CONFIG_ESP_MCP_SERVER_BUILTINS
     // Add built-in system status resource if no custom resources registered
     if (cJSON_GetArraySize(resources_array) == 0) {
         cJSON *resource = cJSON_CreateObject();
@@ -345,20 +851,111 @@ static cJSON* handle_list_resources(const cJSON *params, const cJSON *id, void *
 
         cJSON_AddItemToArray(resources_array, resource);
     }
+#endif
+
+#if CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER
+    cJSON *profile_resource = cJSON_CreateObject();
+    cJSON_AddStringToObject(profile_resource, "uri", "esp32://system/alloc_profile");
+    cJSON_AddStringToObject(profile_resource, "name", "alloc_profile");
+    cJSON_AddStringToObject(profile_resource, "title", "Allocation Profile");
+    cJSON_AddStringToObject(profile_resource, "description", "Heap allocations per JSON-RPC method and tool");
+    cJSON_AddStringToObject(profile_resource, "mimeType", "application/json");
+    cJSON_AddItemToArray(resources_array, profile_resource);
+#endif
+
+#if CONFIG_ESP_MCP_SERVER_STACK_PROFILER
+    cJSON *stack_resource = cJSON_CreateObject();
+    cJSON_AddStringToObject(stack_resource, "uri", "esp32://system/stack_profile");
+    cJSON_AddStringToObject(stack_resource, "name", "stack_profile");
+    cJSON_AddStringToObject(stack_resource, "title", "Stack Profile");
+    cJSON_AddStringToObject(stack_resource, "description", "Worst-case free stack per JSON-RPC method and tool");
+    cJSON_AddStringToObject(stack_resource, "mimeType", "application/json");
+    cJSON_AddItemToArray(resources_array, stack_resource);
+#endif
+
+#if CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+    cJSON *capture_resource = cJSON_CreateObject();
+    cJSON_AddStringToObject(capture_resource, "uri", "esp32://system/traffic_capture");
+    cJSON_AddStringToObject(capture_resource, "name", "traffic_capture");
+    cJSON_AddStringToObject(capture_resource, "title", "Traffic Capture");
+    cJSON_AddStringToObject(capture_resource, "description", "Recent /mcp requests with timing, for offline replay");
+    cJSON_AddStringToObject(capture_resource, "mimeType", "text/plain");
+    cJSON_AddItemToArray(resources_array, capture_resource);
+#endif
+
+#if CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL
+    cJSON *journal_resource = cJSON_CreateObject();
+    cJSON_AddStringToObject(journal_resource, "uri", "esp32://system/crash_journal");
+    cJSON_AddStringToObject(journal_resource, "name", "crash_journal");
+    cJSON_AddStringToObject(journal_resource, "title", "Crash Journal");
+    cJSON_AddStringToObject(journal_resource, "description", "Last requests, kept across resets, with the one a crash interrupted");
+    cJSON_AddStringToObject(journal_resource, "mimeType", "application/json");
+    cJSON_AddItemToArray(resources_array, journal_resource);
+#endif
+
+#if CONFIG_ESP_MCP_SERVER_LOG_TAIL
+    cJSON *log_resource = cJSON_CreateObject();
+    cJSON_AddStringToObject(log_resource, "uri", LOG_TAIL_URI_PREFIX "{offset}");
+    cJSON_AddStringToObject(log_resource, "name", "log_tail");
+    cJSON_AddStringToObject(log_resource, "title", "Log Tail");
+    cJSON_AddStringToObject(log_resource, "description", "Log output written since {offset}; _meta.nextOffset is the offset to read next");
+    cJSON_AddStringToObject(log_resource, "mimeType", "text/plain");
+    cJSON_AddItemToArray(resources_array, log_resource);
+#endif
 
     cJSON_AddItemToObject(result, "resources", resources_array);
+    if (ctx) {
+        add_catalog_meta(ctx, result, false);
+    }
     return result;
 }
 
-static cJSON* handle_read_resource(const cJSON *params, const cJSON *id, void *user_data) {
-    ESP_LOGI(TAG, "Reading resource");
+// Whether a registered resource serves a URI; without URI templates only its own URI matches
+static bool resource_matches(const char *uri_template, const char *uri) {
+#if CONFIG_ESP_MCP_SERVER_URI_TEMPLATES
+    cJSON *params = NULL;
+    bool match = esp_mcp_uri_match_template(uri_template, uri, &params);
+    cJSON_Delete(params);
+    return match;
+#else
+    return strcmp(uri_template, uri) == 0;
+#endif
+}
+
+typedef struct {
+    const mcp_resource_entry_t *resource;
+    const char *uri;
+} resource_read_t;
+
+static void* read_resource_handler(void *arg) {
+    resource_read_t *read = (resource_read_t *)arg;
+    return read->resource->handler(read->uri, read->resource->user_data);
+}
 
-    if (!params) {
+static cJSON* create_read_result(const char *uri, const char *mime_type, const char *content_text) {
+    if (!content_text) {
         return NULL;
     }
+    cJSON *result = cJSON_CreateObject();
+    if (result) {
+        cJSON *contents_array = cJSON_CreateArray();
+        cJSON *content = cJSON_CreateObject();
+
+        cJSON_AddStringToObject(content, "uri", uri);
+        cJSON_AddStringToObject(content, "mimeType", mime_type ? mime_type : "text/plain");
+        cJSON_AddStringToObject(content, "text", content_text);
+
+        cJSON_AddItemToArray(contents_array, content);
+        cJSON_AddItemToObject(result, "contents", contents_array);
+    }
+    return result;
+}
 
-    cJSON *uri = cJSON_GetObjectItem(params, "uri");
-    if (!uri || !cJSON_IsString(uri)) {
+static cJSON* handle_read_resource(jsonrpc_msg_t *msg, void *user_data) {
+    MCP_LOG_REQUEST("Reading resource");
+
+    const char *uri = jsonrpc_get_param_string(msg, "uri");
+    if (!uri) {
         return NULL;
     }
 
@@ -367,56 +964,90 @@ static cJSON* handle_read_resource(const cJSON *params, const cJSON *id, void *u
     // First, try registered resources
     if (ctx) {
         for (size_t i = 0; i < ctx->resource_count; i++) {
-            cJSON *params_obj = NULL;
-            if (esp_mcp_uri_match_template(ctx->resources[i].uri_template, uri->valuestring, &params_obj)) {
+#if CONFIG_ESP_MCP_SERVER_FS_RESOURCES
+            if (ctx->resources[i].fs) {
+                char path[FS_RESOURCE_PATH_MAX];
+                if (fs_resource_resolve(ctx->resources[i].fs, uri, path)) {
+                    cJSON *result = fs_resource_read(ctx->resources[i].fs, uri, path);
+                    if (result) {
+                        return result;
+                    }
+                }
+                continue;
+            }
+#endif
+#if CONFIG_ESP_MCP_SERVER_PARTITION_RESOURCES
+            if (ctx->resources[i].partition) {
+                if (strcmp(ctx->resources[i].uri_template, uri) == 0) {
+                    cJSON *result = partition_resource_read(ctx->resources[i].partition, uri);
+                    if (result) {
+                        return result;
+                    }
+                }
+                continue;
+            }
+#endif
+            if (resource_matches(ctx->resources[i].uri_template, uri)) {
                 if (ctx->resources[i].handler) {
-                    char *content_text = ctx->resources[i].handler(uri->valuestring, ctx->resources[i].user_data);
-                    if (content_text) {
-                        cJSON *result = cJSON_CreateObject();
-                        if (result) {
-                            cJSON *contents_array = cJSON_CreateArray();
-                            cJSON *content = cJSON_CreateObject();
-
-                            cJSON_AddStringToObject(content, "uri", uri->valuestring);
-                            cJSON_AddStringToObject(content, "mimeType",
-                                ctx->resources[i].mime_type ? ctx->resources[i].mime_type : "text/plain");
-                            cJSON_AddStringToObject(content, "text", content_text);
-
-                            cJSON_AddItemToArray(contents_array, content);
-                            cJSON_AddItemToObject(result, "contents", contents_array);
-
-                            free(content_text);
-                            if (params_obj) cJSON_Delete(params_obj);
-                            return result;
-                        }
+                    // Identical concurrent reads share the first one's text
+                    resource_read_t read = {&ctx->resources[i], uri};
+                    single_flight_call_t *flight;
+                    char *content_text = single_flight_do(ctx->flights, uri, read_resource_handler, &read, &flight);
+                    cJSON *result = create_read_result(uri, ctx->resources[i].mime_type, content_text);
+                    if (single_flight_done(ctx->flights, flight)) {
                         free(content_text);
                     }
+                    if (result) {
+                        return result;
+                    }
                 }
-                if (params_obj) cJSON_Delete(params_obj);
             }
         }
     }
 
-    // Fallback to built-in resources
-    if (strcmp(uri->valuestring, "esp32://system/status") == 0) {
-        char *content_text = builtin_system_status_resource(uri->valuestring, user_data);
-        if (content_text) {
-            cJSON *result = cJSON_CreateObject();
-            if (result) {
-                cJSON *contents_array = cJSON_CreateArray();
-                cJSON *content = cJSON_CreateObject();
-
-                cJSON_AddStringToObject(content, "uri", uri->valuestring);
-                cJSON_AddStringToObject(content, "mimeType", "text/plain");
-                cJSON_AddStringToObject(content, "text", content_text);
-
-                cJSON_AddItemToArray(contents_array, content);
-                cJSON_AddItemToObject(result, "contents", contents_array);
-
-                free(content_text);
-                return result;
-            }
-            free(content_text);
+#if CONFIG_ESP_MCP_SERVER_LOG_TAIL
+    cJSON *log_result = log_tail_read(uri);
+    if (log_result) {
+        return log_result;
+    }
+#endif
+
+    // Fallback to built-in resources, each compiled in by its own option
+    char *content_text = NULL;
+    const char *mime_type = "text/plain";
+#if CONFIG_ESP_MCP_SERVER_BUILTINS
+    if (strcmp(uri, "esp32://system/status") == 0) {
+        content_text = builtin_system_status_resource(uri, user_data);
+    }
+#endif
+#if CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER
+    if (strcmp(uri, "esp32://system/alloc_profile") == 0) {
+        content_text = alloc_profiler_render_json();
+        mime_type = "application/json";
+    }
+#endif
+#if CONFIG_ESP_MCP_SERVER_STACK_PROFILER
+    if (strcmp(uri, "esp32://system/stack_profile") == 0) {
+        content_text = stack_profiler_render_json();
+        mime_type = "application/json";
+    }
+#endif
+#if CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+    if (strcmp(uri, "esp32://system/traffic_capture") == 0 && ctx && ctx->capture) {
+        content_text = traffic_capture_render(ctx->capture);
+    }
+#endif
+#if CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL
+    if (strcmp(uri, "esp32://system/crash_journal") == 0) {
+        content_text = crash_journal_render_json();
+        mime_type = "application/json";
+    }
+#endif
+    if (content_text) {
+        cJSON *result = create_read_result(uri, mime_type, content_text);
+        MCP_FREE(content_text);
+        if (result) {
+            return result;
         }
     }
 
@@ -428,109 +1059,941 @@ static cJSON* handle_read_resource(const cJSON *params, const cJSON *id, void *u
     return result;
 }
 
-// HTTP handlers
-static esp_err_t mcp_post_handler(httpd_req_t *req) {
-    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)req->user_ctx;
+#if CONFIG_ESP_MCP_SERVER_COMPLETIONS
+static cJSON* handle_complete(jsonrpc_msg_t *msg, void *user_data) {
+    MCP_LOG_REQUEST("Completion request");
 
-    // Set CORS headers
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "POST, GET, OPTIONS");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type, MCP-Protocol-Version");
+    const cJSON *params = jsonrpc_get_params(msg);
+    cJSON *ref = cJSON_GetObjectItem(params, "ref");
+    cJSON *ref_type = cJSON_GetObjectItem(ref, "type");
+    cJSON *argument = cJSON_GetObjectItem(params, "argument");
+    cJSON *arg_name = cJSON_GetObjectItem(argument, "name");
+    cJSON *arg_value = cJSON_GetObjectItem(argument, "value");
 
-    char *content = malloc(req->content_len + 1);
-    if (!content) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
-        return ESP_ERR_NO_MEM;
+    if (!cJSON_IsString(ref_type) || !cJSON_IsString(arg_name)) {
+        return create_invalid_params_result("Missing completion reference or argument name");
+    }
+    if (strcmp(ref_type->valuestring, "ref/resource") != 0) {
+        return create_invalid_params_result("Unsupported completion reference type");
     }
 
-    int ret = httpd_req_recv(req, content, req->content_len);
-    if (ret <= 0) {
-        free(content);
-        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
-            httpd_resp_send_err(req, HTTPD_408_REQ_TIMEOUT, "Request timeout");
+    cJSON *ref_uri = cJSON_GetObjectItem(ref, "uri");
+    if (!cJSON_IsString(ref_uri)) {
+        return create_invalid_params_result("Missing resource reference URI");
+    }
+
+    // Look up the candidate index for this template variable
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)user_data;
+    const completion_index_t *index = NULL;
+    if (ctx) {
+        for (size_t i = 0; i < ctx->completion_count; i++) {
+            if (strcmp(ctx->completions[i].uri_template, ref_uri->valuestring) == 0 &&
+                strcmp(ctx->completions[i].argument, arg_name->valuestring) == 0) {
+                index = &ctx->completions[i].index;
+                break;
+            }
         }
-        return ESP_FAIL;
     }
-    content[req->content_len] = '\0';
 
-    ESP_LOGI(TAG, "Received MCP request: %s", content);
+    size_t first = 0;
+    size_t total = completion_index_lookup(index, cJSON_IsString(arg_value) ? arg_value->valuestring : NULL, &first);
+    size_t count = total > MCP_COMPLETION_MAX_VALUES ? MCP_COMPLETION_MAX_VALUES : total;
 
-    // Parse and validate JSON-RPC message
-    jsonrpc_msg_t msg;
-    bool parse_success = jsonrpc_parse_message(content, &msg);
+    cJSON *result = cJSON_CreateObject();
+    if (!result) {
+        return NULL;
+    }
 
-    if (!parse_success) {
-        free(content);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON-RPC request");
-        return ESP_FAIL;
+    cJSON *completion = cJSON_CreateObject();
+    cJSON *values = cJSON_CreateArray();
+    for (size_t i = 0; i < count; i++) {
+        // Candidates outlive the response, so reference them instead of copying
+        cJSON_AddItemToArray(values, cJSON_CreateStringReference(index->sorted[first + i]));
     }
+    cJSON_AddItemToObject(completion, "values", values);
+    cJSON_AddNumberToObject(completion, "total", total);
+    cJSON_AddBoolToObject(completion, "hasMore", total > count);
+    cJSON_AddItemToObject(result, "completion", completion);
 
-    // Process JSON-RPC request
-    char *response = jsonrpc_process_request(content, mcp_methods, mcp_methods_count, ctx);
-    free(content);
+    return result;
+}
+#endif
 
-    if (response) {
-        // We have a response (for requests)
-        httpd_resp_set_type(req, "application/json");
-        httpd_resp_send(req, response, strlen(response));
-        free(response);
-    } else {
-        // No response (for notifications) - send empty 200 OK
-        httpd_resp_set_type(req, "application/json");
-        httpd_resp_send(req, NULL, 0);
+// HTTP handlers
+static void conn_ctx_free(void *arg) {
+    mcp_conn_ctx_t *conn = (mcp_conn_ctx_t *)arg;
+    if (!conn) {
+        return;
     }
 
-    jsonrpc_free_message(&msg);
-    return ESP_OK;
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)conn->server;
+    if (ctx && ctx->active_sessions > 0) {
+        ctx->active_sessions--;
+    }
+#if CONFIG_ESP_MCP_SERVER_STEADY_STATE
+    // Reserved slot: the receive buffer lives in the request arena
+    conn->server = NULL;
+#else
+    free(conn->recv_buf);
+    free(conn);
+#endif
 }
 
-static esp_err_t mcp_options_handler(httpd_req_t *req) {
-    // Handle CORS preflight
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "POST, GET, OPTIONS");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type, MCP-Protocol-Version");
-    httpd_resp_send(req, NULL, 0);
-    return ESP_OK;
-}
+// Return the connection's state, attaching it on the first request of the socket
+static mcp_conn_ctx_t* get_conn_ctx(httpd_req_t *req, mcp_server_ctx_t *ctx) {
+    if (req->sess_ctx) {
+        return (mcp_conn_ctx_t *)req->sess_ctx;
+    }
 
-// Helper functions for resource management
-static esp_err_t expand_tool_array(mcp_server_ctx_t *ctx) {
-    if (ctx->tool_count >= ctx->tool_capacity) {
-        size_t new_capacity = ctx->tool_capacity * 2;
-        void *new_tools = realloc(ctx->tools, new_capacity * sizeof(ctx->tools[0]));
-        if (!new_tools) {
-            return ESP_ERR_NO_MEM;
+#if CONFIG_ESP_MCP_SERVER_STEADY_STATE
+    mcp_conn_ctx_t *conn = NULL;
+    for (uint16_t i = 0; i < ctx->config.max_sessions; i++) {
+        if (!ctx->conn_slots[i].server) {
+            conn = &ctx->conn_slots[i];
+            break;
         }
-        ctx->tools = new_tools;
-        ctx->tool_capacity = new_capacity;
     }
-    return ESP_OK;
+#else
+    mcp_conn_ctx_t *conn = calloc(1, sizeof(mcp_conn_ctx_t));
+#endif
+    if (!conn) {
+        return NULL;
+    }
+    conn->server = ctx;
+    req->sess_ctx = conn;
+    req->free_ctx = conn_ctx_free;
+    ctx->active_sessions++;
+    return conn;
 }
 
-static esp_err_t expand_resource_array(mcp_server_ctx_t *ctx) {
-    if (ctx->resource_count >= ctx->resource_capacity) {
-        size_t new_capacity = ctx->resource_capacity * 2;
-        void *new_resources = realloc(ctx->resources, new_capacity * sizeof(ctx->resources[0]));
-        if (!new_resources) {
-            return ESP_ERR_NO_MEM;
+// Get a buffer for the request body, reusing the connection's buffer whenever it fits
+static char* acquire_recv_buffer(mcp_server_ctx_t *ctx, mcp_conn_ctx_t *conn, size_t needed) {
+#if CONFIG_ESP_MCP_SERVER_STEADY_STATE
+    // The request arena is already reused across requests
+    return MCP_MALLOC(needed);
+#else
+    size_t max_size = ctx->config.conn_buffer_max_size;
+    if (!conn || needed > max_size) {
+        // Oversized bodies (or no connection state) get a one-off buffer
+        return MCP_MALLOC(needed);
+    }
+
+    if (conn->recv_capacity < needed) {
+        size_t new_capacity = conn->recv_capacity ? conn->recv_capacity : MCP_CONN_BUFFER_INITIAL_SIZE;
+        while (new_capacity < needed) {
+            new_capacity *= 2;
         }
-        ctx->resources = new_resources;
-        ctx->resource_capacity = new_capacity;
+        if (new_capacity > max_size) {
+            new_capacity = max_size;
+        }
+
+        // Contents need not survive, so free first rather than realloc
+        free(conn->recv_buf);
+        conn->recv_buf = malloc(new_capacity);
+        conn->recv_capacity = conn->recv_buf ? new_capacity : 0;
     }
-    return ESP_OK;
+    return conn->recv_buf;
+#endif
 }
 
-// Public API implementations
-esp_err_t esp_mcp_server_init(const esp_mcp_server_config_t *config, esp_mcp_server_handle_t *server_handle) {
-    if (!config || !server_handle) {
-        ESP_LOGE(TAG, "Invalid arguments");
-        return ESP_ERR_INVALID_ARG;
+static void release_recv_buffer(mcp_conn_ctx_t *conn, char *buf) {
+    if (!conn || buf != conn->recv_buf) {
+        MCP_FREE(buf);
     }
+}
 
-    // Validate configuration
-    if (config->port == 0 || config->max_sessions == 0) {
-        ESP_LOGE(TAG, "Invalid configuration: port and max_sessions must be > 0");
-        return ESP_ERR_INVALID_ARG;
+// Index of the streaming tool targeted by a tools/call request, -1 if it targets none
+static int find_streaming_tool(mcp_server_ctx_t *ctx, const jsonrpc_msg_t *msg) {
+    if (msg->type != JSONRPC_REQUEST || strcmp(msg->method, "tools/call") != 0) {
+        return -1;
+    }
+
+    const char *name = jsonrpc_get_param_string(msg, "name");
+    if (!name) {
+        return -1;
+    }
+    for (size_t i = 0; i < ctx->tool_count; i++) {
+        if (ctx->tools[i].stream_handler && strcmp(ctx->tools[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Run a streaming tool, sending its result through the transport stream
+ *
+ * @return true once resp holds the answer: the streamed result, or an error
+ *         response for invalid arguments or a failed allocation
+ */
+static bool stream_tool_call(mcp_server_ctx_t *ctx, size_t tool_idx, const jsonrpc_msg_t *msg,
+                             const mcp_transport_stream_t *stream, mcp_transport_response_t *resp) {
+    cJSON *arguments = jsonrpc_build_param(msg, "arguments");
+    cJSON *streamed_value = take_stream_argument(ctx, tool_idx, arguments);
+    cJSON *error_result = validate_tool_arguments(ctx, tool_idx, arguments);
+    char *chunk = error_result ? NULL : MCP_MALLOC(MCP_STREAM_CHUNK_SIZE);
+    if (!chunk) {
+        // Answered here rather than by handle_call_tool, which only knows that the tool needs a stream
+        resp->status = 200;
+        resp->error = NULL;
+        resp->body = error_result ? jsonrpc_create_result(msg->id, error_result) :
+                                    jsonrpc_create_error(msg->id, JSONRPC_INTERNAL_ERROR, "Out of memory", NULL);
+        cJSON_Delete(error_result);
+        cJSON_Delete(streamed_value);
+        cJSON_Delete(arguments);
+        return true;
+    }
+
+    // Fed after the checks above, so a rejected call leaves the sink untouched
+    error_result = deliver_stream_argument(ctx, tool_idx, streamed_value);
+    cJSON_Delete(streamed_value);
+
+    MCP_LOG_REQUEST("Streaming result of tool '%s'", ctx->tools[tool_idx].name);
+
+    esp_mcp_content_writer_t writer = { 0 };
+    esp_err_t ret = content_writer_begin(&writer, stream, msg->id, chunk, MCP_STREAM_CHUNK_SIZE);
+    if (ret == ESP_OK && error_result) {
+        // The sink failed; report it the way handle_call_tool would, without running the handler
+        ret = esp_mcp_content_add_item(&writer, cJSON_GetArrayItem(cJSON_GetObjectItem(error_result, "content"), 0));
+        if (ret == ESP_OK) {
+            ret = content_writer_finish(&writer, true);
+        }
+    } else if (ret == ESP_OK) {
+        alloc_profiler_tool_begin();
+        esp_err_t tool_ret = ctx->tools[tool_idx].stream_handler(arguments, &writer, ctx->tools[tool_idx].user_data);
+        alloc_profiler_tool_end(ctx->tools[tool_idx].name);
+        stack_profiler_tool_end(ctx->tools[tool_idx].name);
+        finish_stream_argument(ctx, tool_idx);
+        ret = content_writer_finish(&writer, tool_ret != ESP_OK);
+    }
+    cJSON_Delete(error_result);
+    MCP_FREE(chunk);
+    cJSON_Delete(arguments);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Streamed result of tool '%s' aborted: %s", ctx->tools[tool_idx].name, esp_err_to_name(ret));
+    }
+    resp->streamed = true;
+    resp->streamed_len = writer.sent;
+    resp->body = NULL;
+    resp->status = ret == ESP_OK ? 200 : 500;
+    resp->error = ret == ESP_OK ? NULL : "Streamed response aborted";
+    return true;
+}
+
+#if CONFIG_ESP_MCP_SERVER_FS_RESOURCES || CONFIG_ESP_MCP_SERVER_PARTITION_RESOURCES
+/**
+ * @brief Stream a resources/read of a filesystem provider or partition range through the transport stream
+ *
+ * @return false if nothing was sent and the request should be processed normally
+ *         (e.g. the URI is not served by a provider or does not exist)
+ */
+static bool stream_resource_read(mcp_server_ctx_t *ctx, const jsonrpc_msg_t *msg,
+                                 const mcp_transport_stream_t *stream, mcp_transport_response_t *resp) {
+    if (msg->type != JSONRPC_REQUEST || strcmp(msg->method, "resources/read") != 0) {
+        return false;
+    }
+    const char *uri = jsonrpc_get_param_string(msg, "uri");
+    if (!uri) {
+        return false;
+    }
+
+    for (size_t i = 0; i < ctx->resource_count; i++) {
+        size_t sent = 0;
+        esp_err_t ret;
+#if CONFIG_ESP_MCP_SERVER_FS_RESOURCES
+        char path[FS_RESOURCE_PATH_MAX];
+        if (ctx->resources[i].fs && fs_resource_resolve(ctx->resources[i].fs, uri, path)) {
+            MCP_LOG_REQUEST("Streaming resource '%s'", uri);
+            ret = fs_resource_stream(ctx->resources[i].fs, uri, path, stream, msg->id, &sent);
+        } else
+#endif
+#if CONFIG_ESP_MCP_SERVER_PARTITION_RESOURCES
+        if (ctx->resources[i].partition && strcmp(ctx->resources[i].uri_template, uri) == 0) {
+            MCP_LOG_REQUEST("Streaming resource '%s'", uri);
+            ret = partition_resource_stream(ctx->resources[i].partition, uri, stream, msg->id, &sent);
+        } else
+#endif
+        {
+            continue;
+        }
+
+        if (ret != ESP_OK && sent == 0) {
+            return false;
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Streamed resource '%s' aborted: %s", uri, esp_err_to_name(ret));
+        }
+        resp->streamed = true;
+        resp->streamed_len = sent;
+        resp->body = NULL;
+        resp->status = ret == ESP_OK ? 200 : 500;
+        resp->error = ret == ESP_OK ? NULL : "Streamed response aborted";
+        return true;
+    }
+    return false;
+}
+#else
+#define stream_resource_read(ctx, msg, stream, resp) (false)
+#endif
+
+#if CONFIG_ESP_MCP_SERVER_MIDDLEWARE
+/**
+ * @brief Run the pre-dispatch hooks of the middleware chain
+ *
+ * @return true if a hook answered the request into resp, so it must not be dispatched
+ */
+static bool middleware_pre_dispatch(mcp_server_ctx_t *ctx, const jsonrpc_msg_t *msg, size_t len,
+                                    const mcp_transport_stream_t *stream, esp_mcp_request_info_t *info,
+                                    mcp_transport_response_t *resp) {
+    if (ctx->middleware_count == 0) {
+        return false;
+    }
+
+    memset(info, 0, sizeof(*info));
+    info->method = msg->method;
+    info->tool = strcmp(msg->method, "tools/call") == 0 ? jsonrpc_get_param_string(msg, "name") : NULL;
+    info->uri = strcmp(msg->method, "resources/read") == 0 ? jsonrpc_get_param_string(msg, "uri") : NULL;
+    info->session = stream ? stream->sockfd : -1;
+    info->request_len = len;
+    info->notification = msg->type == JSONRPC_NOTIFICATION;
+    // Start time, until middleware_post_dispatch() turns it into the duration
+    info->duration_us = esp_timer_get_time();
+
+    for (uint8_t i = 0; i < ctx->middleware_count; i++) {
+        const esp_mcp_middleware_t *mw = &ctx->middleware[i];
+        if (!mw->pre) {
+            continue;
+        }
+        esp_mcp_hook_response_t answer = { 0 };
+        esp_err_t ret = mw->pre(info, &answer, mw->user_data);
+        if (ret == ESP_OK) {
+            cJSON_Delete(answer.result);
+            continue;
+        }
+
+        MCP_LOG_REQUEST("Request '%s' answered by middleware %u", msg->method, (unsigned)i);
+        info->short_circuited = true;
+        resp->status = 200;
+        resp->error = NULL;
+        resp->body = NULL;
+        if (msg->type == JSONRPC_REQUEST) {
+            if (answer.error_code == 0 && answer.result) {
+                resp->body = jsonrpc_create_response(msg->id, answer.result);
+            } else {
+                resp->body = jsonrpc_create_error(msg->id, answer.error_code ? answer.error_code : JSONRPC_INTERNAL_ERROR,
+                                                  answer.message ? answer.message : esp_err_to_name(ret), NULL);
+            }
+        }
+        cJSON_Delete(answer.result);
+        return true;
+    }
+    return false;
+}
+
+// Run the post-dispatch hooks, innermost middleware first
+static void middleware_post_dispatch(mcp_server_ctx_t *ctx, esp_mcp_request_info_t *info,
+                                     const mcp_transport_response_t *resp) {
+    if (ctx->middleware_count == 0) {
+        return;
+    }
+
+    info->streamed = resp->streamed;
+    info->response = resp->streamed ? NULL : resp->body;
+    info->response_len = resp->streamed ? resp->streamed_len : (resp->body ? strlen(resp->body) : 0);
+    info->duration_us = esp_timer_get_time() - info->duration_us;
+
+    for (uint8_t i = ctx->middleware_count; i-- > 0;) {
+        const esp_mcp_middleware_t *mw = &ctx->middleware[i];
+        if (mw->post) {
+            mw->post(info, mw->user_data);
+        }
+    }
+}
+#else
+#define middleware_pre_dispatch(ctx, msg, len, stream, info, resp) (false)
+#define middleware_post_dispatch(ctx, info, resp)
+#endif
+
+#if MCP_EVENT_STREAM_SUPPORTED
+// Whether two sockets are connected to the same client address
+static bool same_peer(int a, int b) {
+    struct sockaddr_storage addr_a, addr_b;
+    socklen_t len_a = sizeof(addr_a);
+    socklen_t len_b = sizeof(addr_b);
+    if (getpeername(a, (struct sockaddr *)&addr_a, &len_a) != 0 ||
+        getpeername(b, (struct sockaddr *)&addr_b, &len_b) != 0 || addr_a.ss_family != addr_b.ss_family) {
+        return false;
+    }
+    if (addr_a.ss_family == AF_INET) {
+        return ((struct sockaddr_in *)&addr_a)->sin_addr.s_addr == ((struct sockaddr_in *)&addr_b)->sin_addr.s_addr;
+    }
+#if CONFIG_LWIP_IPV6 || CONFIG_IDF_TARGET_LINUX
+    if (addr_a.ss_family == AF_INET6) {
+        return memcmp(&((struct sockaddr_in6 *)&addr_a)->sin6_addr, &((struct sockaddr_in6 *)&addr_b)->sin6_addr,
+                      sizeof(struct in6_addr)) == 0;
+    }
+#endif
+    return false;
+}
+
+/**
+ * @brief Session a client response belongs to
+ *
+ * The event stream socket is busy with the open GET, so responses are POSTed
+ * on another connection; they count as the stream's session when they come
+ * from the same client address.
+ *
+ * @return Socket of the event stream, or -1 if the response is from another client
+ */
+static int response_session(mcp_server_ctx_t *ctx, const mcp_transport_stream_t *stream) {
+    if (!ctx->event_stream_lock || !stream || stream->sockfd < 0) {
+        return -1;
+    }
+    int session = -1;
+    xSemaphoreTake(ctx->event_stream_lock, portMAX_DELAY);
+    if (ctx->event_stream) {
+        int stream_fd = httpd_req_to_sockfd(ctx->event_stream);
+        if (same_peer(stream->sockfd, stream_fd)) {
+            session = stream_fd;
+        }
+    }
+    xSemaphoreGive(ctx->event_stream_lock);
+    return session;
+}
+#else
+#define response_session(ctx, stream) (-1)
+#endif
+
+static void dispatch_request(char *content, size_t len, void *arg,
+                             const mcp_transport_stream_t *stream, mcp_transport_response_t *resp) {
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)arg;
+    // Lite workers dispatch concurrently
+    __atomic_add_fetch(&ctx->total_requests, 1, __ATOMIC_RELAXED);
+    memset(resp, 0, sizeof(*resp));
+
+    stack_profiler_request_begin();
+
+    MCP_LOG_REQUEST("Received MCP request: %s", content);
+
+    // Parse and validate JSON-RPC message
+    jsonrpc_msg_t msg;
+    bool parse_success = jsonrpc_parse_message(content, len, &msg);
+
+    if (!parse_success) {
+        __atomic_add_fetch(&ctx->failed_requests, 1, __ATOMIC_RELAXED);
+        stack_profiler_request_end(NULL);
+        resp->status = 400;
+        resp->body = NULL;
+        resp->error = "Invalid JSON-RPC request";
+        return;
+    }
+
+    if (msg.type == JSONRPC_RESPONSE || msg.type == JSONRPC_ERROR) {
+        // Answer to a server-initiated request; acknowledged with an empty 200 OK
+        if (!ctx->outbound ||
+            !mcp_outbound_complete(ctx->outbound, response_session(ctx, stream), msg.id, msg.result, msg.error)) {
+            ESP_LOGW(TAG, "Dropping response with no matching request from this client");
+        }
+        resp->status = 200;
+    } else {
+#if CONFIG_ESP_MCP_SERVER_MIDDLEWARE
+        esp_mcp_request_info_t info;
+#endif
+        // Journaled before any hook or handler runs, since either may be what crashes
+        uint32_t journal_seq = crash_journal_begin(msg.method, strcmp(msg.method, "tools/call") == 0 ?
+                                                   jsonrpc_get_param_string(&msg, "name") : NULL, msg.id);
+        if (!middleware_pre_dispatch(ctx, &msg, len, stream, &info, resp)) {
+            // Process JSON-RPC request, streaming the result of streaming tools, filesystem and partition reads
+            int stream_tool = stream ? find_streaming_tool(ctx, &msg) : -1;
+            bool answered = stream && (stream_tool >= 0 ? stream_tool_call(ctx, stream_tool, &msg, stream, resp) :
+                                                          stream_resource_read(ctx, &msg, stream, resp));
+            if (!answered) {
+                resp->status = 200;
+                resp->body = jsonrpc_dispatch(&msg, mcp_methods, mcp_methods_count, ctx);
+                resp->error = NULL;
+            }
+        }
+        middleware_post_dispatch(ctx, &info, resp);
+        crash_journal_end(journal_seq, resp->status);
+    }
+
+    // The transport ends the allocation scope once the response is sent and freed
+    alloc_profiler_request_method(msg.method ? msg.method : "(response)");
+#if CONFIG_ESP_MCP_SERVER_STACK_PROFILER
+    char profiled_method[32];
+    snprintf(profiled_method, sizeof(profiled_method), "%s", msg.method ? msg.method : "(response)");
+#endif
+    jsonrpc_free_message(&msg);
+    stack_profiler_request_end(profiled_method);
+}
+
+// Dispatch and then abort the stream sinks a failed call left claimed by this task;
+// every entry point, including replay, goes through here
+static void dispatch_and_release(char *content, size_t len, mcp_server_ctx_t *ctx,
+                                 const mcp_transport_stream_t *stream, mcp_transport_response_t *resp) {
+    dispatch_request(content, len, ctx, stream, resp);
+    release_stream_sinks(ctx);
+}
+
+// Entry point of both transports: dispatch a request body, recording it if capture is enabled
+static void mcp_dispatch_body(char *content, size_t len, void *arg,
+                              const mcp_transport_stream_t *stream, mcp_transport_response_t *resp) {
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)arg;
+#if CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+    if (ctx->capture) {
+        uint32_t seq = traffic_capture_begin(ctx->capture, content, len);
+        int64_t start_us = esp_timer_get_time();
+        dispatch_and_release(content, len, ctx, stream, resp);
+
+        size_t response_len = resp->streamed ? resp->streamed_len : (resp->body ? strlen(resp->body) : 0);
+        traffic_capture_end(ctx->capture, seq, (uint32_t)(esp_timer_get_time() - start_us), resp->status, response_len);
+        return;
+    }
+#endif
+    dispatch_and_release(content, len, ctx, stream, resp);
+}
+
+// The lite transport reads bodies into its connection buffers, so the worker's
+// arena and allocation scope only have to start here rather than when the body arrives
+static void lite_dispatch_body(char *content, size_t len, void *arg,
+                               const mcp_transport_stream_t *stream, mcp_transport_response_t *resp) {
+    request_arena_begin();
+    alloc_profiler_request_begin();
+    mcp_dispatch_body(content, len, arg, stream, resp);
+}
+
+// Run by the lite worker once the response has been sent and freed
+static void lite_request_complete(void *arg) {
+    alloc_profiler_request_end();
+}
+
+// Check the Authorization header of a request; shared by both transports
+static bool mcp_authorize(const char *authorization, size_t len, void *arg) {
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)arg;
+    if (!ctx->auth) {
+        return true;
+    }
+    if (mcp_auth_check_header(ctx->auth, authorization, len)) {
+        return true;
+    }
+    __atomic_add_fetch(&ctx->auth_rejected, 1, __ATOMIC_RELAXED);
+    return false;
+}
+
+// Decide a lite request from the token cache alone; the listener task must not run the verifier
+static mcp_transport_auth_t mcp_precheck_authorization(const char *authorization, size_t len, void *arg) {
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)arg;
+    switch (mcp_auth_check_cached(ctx->auth, authorization, len)) {
+        case MCP_AUTH_ACCEPTED:
+            return MCP_TRANSPORT_AUTH_ACCEPT;
+        case MCP_AUTH_REJECTED:
+            __atomic_add_fetch(&ctx->auth_rejected, 1, __ATOMIC_RELAXED);
+            return MCP_TRANSPORT_AUTH_REJECT;
+        default:
+            return MCP_TRANSPORT_AUTH_VERIFY;
+    }
+}
+
+// Authorize an httpd request from its headers alone, before any of the body is read
+static bool authorize_http_request(httpd_req_t *req, mcp_server_ctx_t *ctx, mcp_conn_ctx_t *conn) {
+    if (!ctx->auth) {
+        return true;
+    }
+
+    size_t len = httpd_req_get_hdr_value_len(req, "Authorization");
+    if (len == 0) {
+        return mcp_authorize(NULL, 0, ctx);
+    }
+
+    // The header is copied into the connection's receive buffer, which the body reuses afterwards
+    char *value = acquire_recv_buffer(ctx, conn, len + 1);
+    if (!value) {
+        return false;
+    }
+    bool authorized = httpd_req_get_hdr_value_str(req, "Authorization", value, len + 1) == ESP_OK &&
+                      mcp_authorize(value, len, ctx);
+    release_recv_buffer(conn, value);
+    return authorized;
+}
+
+static esp_err_t httpd_send_chunk(void *ctx, const char *data, size_t len) {
+    return httpd_resp_send_chunk((httpd_req_t *)ctx, data, len);
+}
+
+#if CONFIG_ESP_MCP_SERVER_CORS
+static void set_cors_headers(httpd_req_t *req) {
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "POST, GET, OPTIONS");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type, Authorization, MCP-Protocol-Version");
+}
+#endif
+
+// Receive len bytes of the body into buf
+static esp_err_t receive_body(httpd_req_t *req, char *buf, size_t len) {
+    size_t received = 0;
+    while (received < len) {
+        int ret = httpd_req_recv(req, buf + received, len - received);
+        if (ret <= 0) {
+            return ret == HTTPD_SOCK_ERR_TIMEOUT ? ESP_ERR_TIMEOUT : ESP_FAIL;
+        }
+        received += ret;
+    }
+    return ESP_OK;
+}
+
+#if CONFIG_ESP_MCP_SERVER_STREAM_ARGUMENTS
+/**
+ * @brief Receive a body larger than the connection buffer, diverting a streamed argument to its sink as it arrives
+ *
+ * Only the rest of the body is kept, in the connection buffer. If the buffer
+ * fills before any value was diverted, the body is received whole into a
+ * one-off buffer instead, as without streamed arguments.
+ *
+ * @param body Output buffer, released with release_recv_buffer()
+ * @param len Output length of the body left in the buffer
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if the rest of the body does not fit, or a receive error
+ */
+static esp_err_t receive_split_body(httpd_req_t *req, mcp_server_ctx_t *ctx, mcp_conn_ctx_t *conn,
+                                    char **body, size_t *len) {
+    size_t capacity = ctx->config.conn_buffer_max_size;
+    char *buf = acquire_recv_buffer(ctx, conn, capacity);
+    arg_stream_t *split = MCP_MALLOC(sizeof(arg_stream_t));
+    if (!buf || !split) {
+        release_recv_buffer(conn, buf);
+        MCP_FREE(split);
+        return ESP_ERR_NO_MEM;
+    }
+    arg_stream_begin(split, buf, claim_body_argument, ctx);
+
+    esp_err_t ret = ESP_OK;
+    size_t received = 0;
+    while (ret == ESP_OK && received < req->content_len) {
+        // One byte is kept for the terminator
+        size_t room = capacity - 1 - split->len;
+        if (room == 0 && !split->diverted) {
+            char *whole = MCP_MALLOC(req->content_len + 1);
+            if (!whole) {
+                ret = ESP_ERR_NO_MEM;
+                break;
+            }
+            memcpy(whole, buf, split->len);
+            release_recv_buffer(conn, buf);
+            buf = whole;
+            ret = receive_body(req, buf + received, req->content_len - received);
+            split->len = req->content_len;
+            break;
+        }
+        if (room == 0) {
+            ret = ESP_ERR_INVALID_SIZE;
+            break;
+        }
+
+        int n = httpd_req_recv(req, buf + split->len, MIN(room, req->content_len - received));
+        if (n <= 0) {
+            ret = n == HTTPD_SOCK_ERR_TIMEOUT ? ESP_ERR_TIMEOUT : ESP_FAIL;
+            break;
+        }
+        arg_stream_feed(split, buf + split->len, n);
+        received += n;
+    }
+
+    if (ret == ESP_OK) {
+        end_body_argument(ctx, arg_stream_end(split));
+        buf[split->len] = '\0';
+        *body = buf;
+        *len = split->len;
+    } else {
+        release_recv_buffer(conn, buf);
+    }
+    MCP_FREE(split);
+    return ret;
+}
+#endif
+
+static esp_err_t serve_post_request(httpd_req_t *req) {
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)req->user_ctx;
+
+#if CONFIG_ESP_MCP_SERVER_CORS
+    set_cors_headers(req);
+#endif
+
+    mcp_conn_ctx_t *conn = get_conn_ctx(req, ctx);
+    if (!authorize_http_request(req, ctx, conn)) {
+        // Returning ESP_FAIL closes the socket, so the unread body is never received
+        httpd_resp_set_hdr(req, "WWW-Authenticate", "Bearer");
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+        return ESP_FAIL;
+    }
+
+    char *content = NULL;
+    size_t content_len = req->content_len;
+    esp_err_t ret;
+#if CONFIG_ESP_MCP_SERVER_STREAM_ARGUMENTS
+    if (ctx->stream_lock && req->content_len >= ctx->config.conn_buffer_max_size) {
+        // A tool takes a streamed argument, which may be what makes the body this large
+        ret = receive_split_body(req, ctx, conn, &content, &content_len);
+    } else
+#endif
+    {
+        content = acquire_recv_buffer(ctx, conn, req->content_len + 1);
+        ret = content ? receive_body(req, content, req->content_len) : ESP_ERR_NO_MEM;
+        if (ret == ESP_OK) {
+            content[req->content_len] = '\0';
+        } else if (content) {
+            release_recv_buffer(conn, content);
+        }
+    }
+
+    if (ret != ESP_OK) {
+        __atomic_add_fetch(&ctx->total_requests, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&ctx->failed_requests, 1, __ATOMIC_RELAXED);
+        release_stream_sinks(ctx);
+        if (ret == ESP_ERR_NO_MEM) {
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
+            return ESP_ERR_NO_MEM;
+        }
+        if (ret == ESP_ERR_INVALID_SIZE) {
+            // The rest of the body is left unread, so the connection is closed
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Request body too large");
+        } else if (ret == ESP_ERR_TIMEOUT) {
+            httpd_resp_send_err(req, HTTPD_408_REQ_TIMEOUT, "Request timeout");
+        }
+        return ESP_FAIL;
+    }
+
+    // Set up front, since a streamed response sends its header with the first chunk
+    httpd_resp_set_type(req, "application/json");
+
+    mcp_transport_stream_t stream = { .send_chunk = httpd_send_chunk, .ctx = req,
+                                      .sockfd = httpd_req_to_sockfd(req) };
+    mcp_transport_response_t resp;
+    mcp_dispatch_body(content, content_len, ctx, &stream, &resp);
+    release_recv_buffer(conn, content);
+
+    if (resp.streamed) {
+        // Terminate the chunked body, or drop the connection if the stream failed
+        if (resp.status != 200 || httpd_resp_send_chunk(req, NULL, 0) != ESP_OK) {
+            return ESP_FAIL;
+        }
+        return ESP_OK;
+    }
+
+    if (resp.status != 200) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, resp.error);
+        return ESP_FAIL;
+    }
+
+    // A NULL body (notification) sends an empty 200 OK
+    httpd_resp_send(req, resp.body, resp.body ? strlen(resp.body) : 0);
+    cJSON_free(resp.body);
+    return ESP_OK;
+}
+
+static esp_err_t mcp_post_handler(httpd_req_t *req) {
+    request_arena_begin();
+    // Spans the body buffer and the response, both released before the scope ends
+    alloc_profiler_request_begin();
+    esp_err_t ret = serve_post_request(req);
+    alloc_profiler_request_end();
+    return ret;
+}
+
+#if CONFIG_ESP_MCP_SERVER_CORS
+static esp_err_t mcp_options_handler(httpd_req_t *req) {
+    // Handle CORS preflight
+    set_cors_headers(req);
+    httpd_resp_send(req, NULL, 0);
+    return ESP_OK;
+}
+#endif
+
+#if MCP_EVENT_STREAM_SUPPORTED
+// Must be called with event_stream_lock held
+static void close_event_stream_locked(mcp_server_ctx_t *ctx) {
+    if (ctx->event_stream) {
+        httpd_resp_send_chunk(ctx->event_stream, NULL, 0);
+        httpd_req_async_handler_complete(ctx->event_stream);
+        ctx->event_stream = NULL;
+    }
+}
+
+// Event stream a server-initiated request is bound to
+typedef struct {
+    mcp_server_ctx_t *ctx;
+    int session;                         // Socket of the stream when the request was registered
+} event_target_t;
+
+// Transmit a server-initiated request as one SSE event, on the stream it was registered for
+static esp_err_t send_event(const char *message, size_t len, void *arg) {
+    event_target_t *target = (event_target_t *)arg;
+    mcp_server_ctx_t *ctx = target->ctx;
+    static const char prefix[] = "event: message\ndata: ";
+
+    xSemaphoreTake(ctx->event_stream_lock, portMAX_DELAY);
+    esp_err_t ret = ESP_ERR_INVALID_STATE;
+    if (ctx->event_stream && httpd_req_to_sockfd(ctx->event_stream) == target->session) {
+        ret = httpd_resp_send_chunk(ctx->event_stream, prefix, sizeof(prefix) - 1);
+        if (ret == ESP_OK) {
+            ret = httpd_resp_send_chunk(ctx->event_stream, message, len);
+        }
+        if (ret == ESP_OK) {
+            ret = httpd_resp_send_chunk(ctx->event_stream, "\n\n", 2);
+        }
+        if (ret != ESP_OK) {
+            // The client went away; it reconnects with a fresh GET
+            ESP_LOGW(TAG, "Event stream lost: %s", esp_err_to_name(ret));
+            httpd_req_async_handler_complete(ctx->event_stream);
+            ctx->event_stream = NULL;
+            ret = ESP_ERR_INVALID_STATE;
+        }
+    }
+    xSemaphoreGive(ctx->event_stream_lock);
+    return ret;
+}
+
+static bool accepts_event_stream(httpd_req_t *req) {
+    char accept[96];
+    return httpd_req_get_hdr_value_str(req, "Accept", accept, sizeof(accept)) == ESP_OK &&
+           strstr(accept, "text/event-stream") != NULL;
+}
+#endif
+
+static esp_err_t mcp_get_handler(httpd_req_t *req) {
+#if CONFIG_ESP_MCP_SERVER_CORS
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+#endif
+
+#if MCP_EVENT_STREAM_SUPPORTED
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)req->user_ctx;
+    if (ctx->outbound && accepts_event_stream(req)) {
+        request_arena_begin();
+        if (!authorize_http_request(req, ctx, get_conn_ctx(req, ctx))) {
+            httpd_resp_set_hdr(req, "WWW-Authenticate", "Bearer");
+            httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+            return ESP_FAIL;
+        }
+
+        // Headers are copied along with the request, so set them before detaching it
+        httpd_resp_set_type(req, "text/event-stream");
+        httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+        httpd_req_t *stream_req;
+        if (httpd_req_async_handler_begin(req, &stream_req) != ESP_OK) {
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Event stream unavailable");
+            return ESP_FAIL;
+        }
+        // Send the response header right away so that the client sees the stream open
+        static const char opened[] = ": stream open\n\n";
+        if (httpd_resp_send_chunk(stream_req, opened, sizeof(opened) - 1) != ESP_OK) {
+            httpd_req_async_handler_complete(stream_req);
+            return ESP_FAIL;
+        }
+
+        // A single stream per server; a reconnecting client replaces the previous one
+        xSemaphoreTake(ctx->event_stream_lock, portMAX_DELAY);
+        int replaced = ctx->event_stream ? httpd_req_to_sockfd(ctx->event_stream) : -1;
+        close_event_stream_locked(ctx);
+        ctx->event_stream = stream_req;
+        xSemaphoreGive(ctx->event_stream_lock);
+        // Requests sent on the old stream can no longer be answered
+        if (replaced >= 0) {
+            mcp_outbound_fail_session(ctx->outbound, replaced, ESP_ERR_INVALID_STATE);
+        }
+        ESP_LOGI(TAG, "Event stream opened");
+        return ESP_OK;
+    }
+#endif
+
+    httpd_resp_set_status(req, "405 Method Not Allowed");
+#if CONFIG_ESP_MCP_SERVER_CORS
+    httpd_resp_set_hdr(req, "Allow", "POST, OPTIONS");
+#else
+    httpd_resp_set_hdr(req, "Allow", "POST");
+#endif
+    httpd_resp_send(req, NULL, 0);
+    return ESP_OK;
+}
+
+// Helper functions for resource management
+static esp_err_t expand_tool_array(mcp_server_ctx_t *ctx) {
+    if (ctx->tool_count >= CONFIG_ESP_MCP_SERVER_MAX_TOOLS) {
+        ESP_LOGE(TAG, "Tool limit (%d) reached", CONFIG_ESP_MCP_SERVER_MAX_TOOLS);
+        return ESP_ERR_NO_MEM;
+    }
+#if !CONFIG_ESP_MCP_SERVER_STATIC_REGISTRY
+    if (ctx->tool_count >= ctx->tool_capacity) {
+        size_t new_capacity = ctx->tool_capacity * 2;
+        if (new_capacity > CONFIG_ESP_MCP_SERVER_MAX_TOOLS) {
+            new_capacity = CONFIG_ESP_MCP_SERVER_MAX_TOOLS;
+        }
+        void *new_tools = realloc(ctx->tools, new_capacity * sizeof(ctx->tools[0]));
+        if (!new_tools) {
+            return ESP_ERR_NO_MEM;
+        }
+        ctx->tools = new_tools;
+        ctx->tool_capacity = new_capacity;
+    }
+#endif
+    return ESP_OK;
+}
+
+#if CONFIG_ESP_MCP_SERVER_COMPLETIONS
+static esp_err_t expand_completion_array(mcp_server_ctx_t *ctx) {
+    if (ctx->completion_count >= ctx->completion_capacity) {
+        size_t new_capacity = ctx->completion_capacity ? ctx->completion_capacity * 2 : 4;
+        void *new_completions = realloc(ctx->completions, new_capacity * sizeof(ctx->completions[0]));
+        if (!new_completions) {
+            return ESP_ERR_NO_MEM;
+        }
+        ctx->completions = new_completions;
+        ctx->completion_capacity = new_capacity;
+    }
+    return ESP_OK;
+}
+#endif
+
+static esp_err_t expand_resource_array(mcp_server_ctx_t *ctx) {
+    if (ctx->resource_count >= CONFIG_ESP_MCP_SERVER_MAX_RESOURCES) {
+        ESP_LOGE(TAG, "Resource limit (%d) reached", CONFIG_ESP_MCP_SERVER_MAX_RESOURCES);
+        return ESP_ERR_NO_MEM;
+    }
+#if !CONFIG_ESP_MCP_SERVER_STATIC_REGISTRY
+    if (ctx->resource_count >= ctx->resource_capacity) {
+        size_t new_capacity = ctx->resource_capacity * 2;
+        if (new_capacity > CONFIG_ESP_MCP_SERVER_MAX_RESOURCES) {
+            new_capacity = CONFIG_ESP_MCP_SERVER_MAX_RESOURCES;
+        }
+        void *new_resources = realloc(ctx->resources, new_capacity * sizeof(ctx->resources[0]));
+        if (!new_resources) {
+            return ESP_ERR_NO_MEM;
+        }
+        ctx->resources = new_resources;
+        ctx->resource_capacity = new_capacity;
+    }
+#endif
+    return ESP_OK;
+}
+
+// Release the registry tables, unless they are part of the context
+static void free_registry_tables(mcp_server_ctx_t *ctx) {
+#if !CONFIG_ESP_MCP_SERVER_STATIC_REGISTRY
+    free(ctx->resources);
+    free(ctx->tools);
+#endif
+}
+
+// Public API implementations
+esp_err_t esp_mcp_server_init(const esp_mcp_server_config_t *config, esp_mcp_server_handle_t *server_handle) {
+    if (!config || !server_handle) {
+        ESP_LOGE(TAG, "Invalid arguments");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Validate configuration
+    if (config->port == 0 || config->max_sessions == 0) {
+        ESP_LOGE(TAG, "Invalid configuration: port and max_sessions must be > 0");
+        return ESP_ERR_INVALID_ARG;
     }
 
     mcp_server_ctx_t *ctx = calloc(1, sizeof(mcp_server_ctx_t));
@@ -538,6 +2001,10 @@ esp_err_t esp_mcp_server_init(const esp_mcp_server_config_t *config, esp_mcp_ser
         return ESP_ERR_NO_MEM;
     }
 
+    ctx->tools_hash = CATALOG_HASH_BASIS;
+    ctx->resources_hash = CATALOG_HASH_BASIS;
+    update_catalog_hash(ctx);
+
     // Copy configuration
     ctx->config = *config;
     if (config->server_name) {
@@ -548,25 +2015,78 @@ esp_err_t esp_mcp_server_init(const esp_mcp_server_config_t *config, esp_mcp_ser
     }
 
     // Initialize arrays
-    ctx->tool_capacity = 8;
+#if CONFIG_ESP_MCP_SERVER_STATIC_REGISTRY
+    ctx->tool_capacity = CONFIG_ESP_MCP_SERVER_MAX_TOOLS;
+    ctx->resource_capacity = CONFIG_ESP_MCP_SERVER_MAX_RESOURCES;
+#else
+    ctx->tool_capacity = MIN(MCP_REGISTRY_INITIAL_CAPACITY, CONFIG_ESP_MCP_SERVER_MAX_TOOLS);
     ctx->tools = calloc(ctx->tool_capacity, sizeof(ctx->tools[0]));
     if (!ctx->tools) {
         free(ctx);
         return ESP_ERR_NO_MEM;
     }
 
-    ctx->resource_capacity = 8;
+    ctx->resource_capacity = MIN(MCP_REGISTRY_INITIAL_CAPACITY, CONFIG_ESP_MCP_SERVER_MAX_RESOURCES);
     ctx->resources = calloc(ctx->resource_capacity, sizeof(ctx->resources[0]));
     if (!ctx->resources) {
         free(ctx->tools);
         free(ctx);
         return ESP_ERR_NO_MEM;
     }
+#endif
+
+#if CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+    if (traffic_capture_create(CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE_SIZE, &ctx->capture) != ESP_OK) {
+        ESP_LOGW(TAG, "Traffic capture unavailable");
+        ctx->capture = NULL;
+    }
+#endif
+
+#if MCP_EVENT_STREAM_SUPPORTED
+    if (config->max_pending_requests > 0) {
+        ctx->event_stream_lock = xSemaphoreCreateMutex();
+        if (!ctx->event_stream_lock ||
+            mcp_outbound_create(config->max_pending_requests, &ctx->outbound) != ESP_OK) {
+            ESP_LOGW(TAG, "Server-initiated requests unavailable");
+            ctx->outbound = NULL;
+        }
+    }
+#endif
+
+    // One flight per connection is enough for every request to lead or follow one
+    if (config->coalesce_reads &&
+        single_flight_create(config->max_sessions, &ctx->flights) != ESP_OK) {
+        ESP_LOGW(TAG, "Read coalescing unavailable");
+        ctx->flights = NULL;
+    }
+
+    if (config->auth_verifier) {
+        esp_err_t ret = mcp_auth_create(config->auth_verifier, config->auth_user_data,
+                                        config->auth_cache_entries, &ctx->auth);
+        if (ret != ESP_OK) {
+#if CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+            traffic_capture_destroy(ctx->capture);
+#endif
+            mcp_outbound_destroy(ctx->outbound);
+            single_flight_destroy(ctx->flights);
+            if (ctx->event_stream_lock) {
+                vSemaphoreDelete(ctx->event_stream_lock);
+            }
+            free_registry_tables(ctx);
+            free(ctx);
+            return ret;
+        }
+    }
 
     // Initialize server state
     ctx->http_server = NULL;
     ctx->is_running = false;
 
+    alloc_profiler_init();
+    stack_profiler_init();
+    crash_journal_init();
+    log_tail_init();
+
     *server_handle = (esp_mcp_server_handle_t)ctx;
     ESP_LOGI(TAG, "MCP Server initialized successfully");
     return ESP_OK;
@@ -593,8 +2113,10 @@ esp_err_t esp_mcp_server_deinit(esp_mcp_server_handle_t server_handle) {
         if (ctx->tools[i].input_schema) {
             cJSON_Delete(ctx->tools[i].input_schema);
         }
+#if CONFIG_ESP_MCP_SERVER_STREAM_ARGUMENTS
+        free(ctx->tools[i].stream_argument);
+#endif
     }
-    free(ctx->tools);
 
     // Cleanup resources
     for (size_t i = 0; i < ctx->resource_count; i++) {
@@ -603,8 +2125,24 @@ esp_err_t esp_mcp_server_deinit(esp_mcp_server_handle_t server_handle) {
         free(ctx->resources[i].title);
         free(ctx->resources[i].description);
         free(ctx->resources[i].mime_type);
+#if CONFIG_ESP_MCP_SERVER_FS_RESOURCES
+        fs_resource_destroy(ctx->resources[i].fs);
+#endif
+#if CONFIG_ESP_MCP_SERVER_PARTITION_RESOURCES
+        partition_resource_destroy(ctx->resources[i].partition);
+#endif
     }
-    free(ctx->resources);
+    free_registry_tables(ctx);
+
+#if CONFIG_ESP_MCP_SERVER_COMPLETIONS
+    // Cleanup completion indexes
+    for (size_t i = 0; i < ctx->completion_count; i++) {
+        free(ctx->completions[i].uri_template);
+        free(ctx->completions[i].argument);
+        completion_index_free(&ctx->completions[i].index);
+    }
+    free(ctx->completions);
+#endif
 
     // Cleanup config strings
     if (ctx->config.server_name) {
@@ -614,32 +2152,104 @@ esp_err_t esp_mcp_server_deinit(esp_mcp_server_handle_t server_handle) {
         free((char*)ctx->config.server_version);
     }
 
+    alloc_profiler_deinit();
+    mcp_auth_destroy(ctx->auth);
+#if CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+    traffic_capture_destroy(ctx->capture);
+#endif
+    mcp_outbound_destroy(ctx->outbound);
+    single_flight_destroy(ctx->flights);
+    if (ctx->event_stream_lock) {
+        vSemaphoreDelete(ctx->event_stream_lock);
+    }
+#if CONFIG_ESP_MCP_SERVER_STREAM_ARGUMENTS
+    if (ctx->stream_lock) {
+        vSemaphoreDelete(ctx->stream_lock);
+    }
+#endif
+
     free(ctx);
     ESP_LOGI(TAG, "MCP Server stopped successfully");
     return ESP_OK;
 }
 
-esp_err_t esp_mcp_server_start(esp_mcp_server_handle_t server_handle) {
-    if (!server_handle) {
-        ESP_LOGE(TAG, "Invalid server handle");
-        return ESP_ERR_INVALID_ARG;
+#if CONFIG_ESP_HTTPS_SERVER_ENABLE
+// esp_https_server session callbacks carry no user argument
+static mcp_server_ctx_t *s_https_server_ctx;
+
+static void https_session_callback(esp_https_server_user_cb_arg_t *arg) {
+    mcp_server_ctx_t *ctx = s_https_server_ctx;
+    if (!ctx || !arg || arg->user_cb_state != HTTPD_SSL_USER_CB_SESS_CREATE) {
+        return;
     }
 
-    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)server_handle;
+    ctx->tls_handshakes++;
+}
+
+static esp_err_t start_https_server(mcp_server_ctx_t *ctx, const httpd_config_t *server_config) {
+    httpd_ssl_config_t ssl_config = HTTPD_SSL_CONFIG_DEFAULT();
+    // Keep the larger HTTPS task stack unless the application sized it
+    size_t tls_stack_size = ssl_config.httpd.stack_size;
+    ssl_config.httpd = *server_config;
+    if (!ctx->config.task_stack_size) {
+        ssl_config.httpd.stack_size = tls_stack_size;
+    }
+    ssl_config.port_secure = ctx->config.port;
+    ssl_config.servercert = (const uint8_t *)ctx->config.tls_cert_pem;
+    ssl_config.servercert_len = strlen(ctx->config.tls_cert_pem) + 1;
+    ssl_config.prvtkey_pem = (const uint8_t *)ctx->config.tls_key_pem;
+    ssl_config.prvtkey_len = strlen(ctx->config.tls_key_pem) + 1;
+    ssl_config.user_cb = https_session_callback;
+
+#if CONFIG_ESP_TLS_SERVER_SESSION_TICKETS
+    ssl_config.session_tickets = ctx->config.tls_session_tickets;
+#else
+    if (ctx->config.tls_session_tickets) {
+        ESP_LOGW(TAG, "CONFIG_ESP_TLS_SERVER_SESSION_TICKETS is disabled, every reconnect pays a full handshake");
+        ctx->config.tls_session_tickets = false;
+    }
+#endif
 
-    if (ctx->is_running) {
-        ESP_LOGW(TAG, "MCP Server is already running");
-        return ESP_ERR_INVALID_STATE;
+    s_https_server_ctx = ctx;
+    esp_err_t ret = httpd_ssl_start(&ctx->http_server, &ssl_config);
+    if (ret != ESP_OK) {
+        s_https_server_ctx = NULL;
     }
+    return ret;
+}
+#endif
+
+static esp_err_t start_http_transport(mcp_server_ctx_t *ctx) {
+    bool use_tls = ctx->config.tls_cert_pem && ctx->config.tls_key_pem;
 
-    // Start HTTP server
     httpd_config_t server_config = HTTPD_DEFAULT_CONFIG();
     server_config.server_port = ctx->config.port;
     server_config.max_uri_handlers = 8;
+    if (ctx->config.task_stack_size) {
+        server_config.stack_size = ctx->config.task_stack_size;
+    }
 
-    esp_err_t ret = httpd_start(&ctx->http_server, &server_config);
+    esp_err_t ret;
+    if (use_tls) {
+#if CONFIG_ESP_HTTPS_SERVER_ENABLE
+        // Keep sessions open and reclaim idle sockets so that reconnecting
+        // clients do not have to wait for a slot and a fresh handshake
+        server_config.lru_purge_enable = true;
+        server_config.keep_alive_enable = true;
+        server_config.keep_alive_idle = MCP_TLS_KEEP_ALIVE_IDLE_SEC;
+        server_config.keep_alive_interval = MCP_TLS_KEEP_ALIVE_INTERVAL_SEC;
+        server_config.keep_alive_count = MCP_TLS_KEEP_ALIVE_COUNT;
+        ret = start_https_server(ctx, &server_config);
+#else
+        ESP_LOGE(TAG, "HTTPS requested but CONFIG_ESP_HTTPS_SERVER_ENABLE is disabled");
+        ret = ESP_ERR_NOT_SUPPORTED;
+#endif
+    } else {
+        ret = httpd_start(&ctx->http_server, &server_config);
+    }
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start HTTP server: %s", esp_err_to_name(ret));
+        ctx->http_server = NULL;
         return ret;
     }
 
@@ -652,6 +2262,15 @@ esp_err_t esp_mcp_server_start(esp_mcp_server_handle_t server_handle) {
     };
     httpd_register_uri_handler(ctx->http_server, &mcp_post_uri);
 
+    httpd_uri_t mcp_get_uri = {
+        .uri = "/mcp",
+        .method = HTTP_GET,
+        .handler = mcp_get_handler,
+        .user_ctx = ctx
+    };
+    httpd_register_uri_handler(ctx->http_server, &mcp_get_uri);
+
+#if CONFIG_ESP_MCP_SERVER_CORS
     httpd_uri_t mcp_options_uri = {
         .uri = "/mcp",
         .method = HTTP_OPTIONS,
@@ -659,6 +2278,118 @@ esp_err_t esp_mcp_server_start(esp_mcp_server_handle_t server_handle) {
         .user_ctx = ctx
     };
     httpd_register_uri_handler(ctx->http_server, &mcp_options_uri);
+#endif
+
+    return ESP_OK;
+}
+
+static esp_err_t start_lite_transport(mcp_server_ctx_t *ctx) {
+    if (ctx->config.tls_cert_pem) {
+        ESP_LOGE(TAG, "HTTPS is not supported by the lite transport");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+#if CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER
+    if (ctx->config.lite_worker_count > CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER_TASKS) {
+        ESP_LOGE(TAG, "%u lite workers exceed the %d tasks the allocation profiler can follow",
+                 ctx->config.lite_worker_count, CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER_TASKS);
+        return ESP_ERR_INVALID_ARG;
+    }
+#endif
+
+    mcp_lite_transport_config_t lite_config = {
+        .port = ctx->config.port,
+        .max_connections = ctx->config.max_sessions,
+        .worker_count = ctx->config.lite_worker_count ? ctx->config.lite_worker_count : 1,
+        .max_body_size = ctx->config.conn_buffer_max_size,
+        .listener_stack_size = ctx->config.lite_listener_stack_size ?
+                               ctx->config.lite_listener_stack_size : MCP_LITE_TASK_STACK_SIZE,
+        .worker_stack_size = ctx->config.task_stack_size ? ctx->config.task_stack_size : MCP_LITE_TASK_STACK_SIZE,
+        .task_priority = MCP_LITE_TASK_PRIORITY,
+#if CONFIG_ESP_MCP_SERVER_STEADY_STATE
+        .reserve_buffers = true,
+#endif
+        .dispatch = lite_dispatch_body,
+        .complete = lite_request_complete,
+        .authorize = ctx->auth ? mcp_authorize : NULL,
+        .precheck = ctx->auth ? mcp_precheck_authorization : NULL,
+        .arg = ctx,
+    };
+    esp_err_t ret = mcp_lite_transport_start(&lite_config, &ctx->lite_transport);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start lite transport: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+#if CONFIG_ESP_MCP_SERVER_STEADY_STATE
+// Reserve everything the request path allocates: one arena per dispatching task and the session slots
+static esp_err_t reserve_request_memory(mcp_server_ctx_t *ctx) {
+    size_t arenas = 1;
+    if (ctx->config.transport == ESP_MCP_TRANSPORT_LITE) {
+        arenas = ctx->config.lite_worker_count ? ctx->config.lite_worker_count : 1;
+    }
+
+    esp_err_t ret = request_arena_init(arenas, CONFIG_ESP_MCP_SERVER_REQUEST_ARENA_SIZE);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to reserve request arenas: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ctx->conn_slots = calloc(ctx->config.max_sessions, sizeof(mcp_conn_ctx_t));
+    if (!ctx->conn_slots) {
+        request_arena_deinit();
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static void release_request_memory(mcp_server_ctx_t *ctx) {
+    request_arena_deinit();
+    free(ctx->conn_slots);
+    ctx->conn_slots = NULL;
+}
+#endif
+
+esp_err_t esp_mcp_server_start(esp_mcp_server_handle_t server_handle) {
+    if (!server_handle) {
+        ESP_LOGE(TAG, "Invalid server handle");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)server_handle;
+
+    if (ctx->is_running) {
+        ESP_LOGW(TAG, "MCP Server is already running");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret;
+#if CONFIG_ESP_MCP_SERVER_STEADY_STATE
+    ret = reserve_request_memory(ctx);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+#endif
+
+    ret = ctx->config.transport == ESP_MCP_TRANSPORT_LITE ?
+          start_lite_transport(ctx) : start_http_transport(ctx);
+    if (ret != ESP_OK) {
+#if CONFIG_ESP_MCP_SERVER_STEADY_STATE
+        release_request_memory(ctx);
+#endif
+        return ret;
+    }
+
+#if CONFIG_ESP_MCP_SERVER_BUILTINS
+    // Start background telemetry for the built-in system tool and resource
+    if (ctx->config.telemetry_interval_ms > 0) {
+        ret = telemetry_sampler_start(ctx->config.telemetry_interval_ms, ctx->config.telemetry_stack_size,
+                                      read_server_counters, ctx, &ctx->telemetry);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Telemetry sampler unavailable, built-ins will sample on demand: %s", esp_err_to_name(ret));
+            ctx->telemetry = NULL;
+        }
+    }
+#endif
 
     ctx->is_running = true;
     ESP_LOGI(TAG, "MCP Server started successfully on port %d", ctx->config.port);
@@ -678,15 +2409,50 @@ esp_err_t esp_mcp_server_stop(esp_mcp_server_handle_t server_handle) {
         return ESP_ERR_INVALID_STATE;
     }
 
+#if CONFIG_ESP_MCP_SERVER_BUILTINS
+    // Stop telemetry before the HTTP server it reads socket counts from
+    telemetry_sampler_stop(ctx->telemetry);
+    ctx->telemetry = NULL;
+#endif
+
+    if (ctx->lite_transport) {
+        mcp_lite_transport_stop(ctx->lite_transport);
+        ctx->lite_transport = NULL;
+    }
+
     // Stop HTTP server
     if (ctx->http_server) {
+#if MCP_EVENT_STREAM_SUPPORTED
+        if (ctx->event_stream_lock) {
+            xSemaphoreTake(ctx->event_stream_lock, portMAX_DELAY);
+            close_event_stream_locked(ctx);
+            xSemaphoreGive(ctx->event_stream_lock);
+        }
+#endif
+#if CONFIG_ESP_HTTPS_SERVER_ENABLE
+        esp_err_t ret = ctx == s_https_server_ctx ? httpd_ssl_stop(ctx->http_server) : httpd_stop(ctx->http_server);
+        if (ctx == s_https_server_ctx) {
+            s_https_server_ctx = NULL;
+        }
+#else
         esp_err_t ret = httpd_stop(ctx->http_server);
+#endif
         if (ret != ESP_OK) {
             ESP_LOGW(TAG, "Failed to stop HTTP server: %s", esp_err_to_name(ret));
         }
         ctx->http_server = NULL;
     }
 
+    // Responses can no longer arrive for requests sent to the old client
+    if (ctx->outbound) {
+        mcp_outbound_fail_all(ctx->outbound, ESP_ERR_INVALID_STATE);
+    }
+
+#if CONFIG_ESP_MCP_SERVER_STEADY_STATE
+    // Both transports have stopped, so no request can be using the arenas
+    release_request_memory(ctx);
+#endif
+
     ctx->is_running = false;
     ESP_LOGI(TAG, "MCP Server stopped successfully");
     return ESP_OK;
@@ -698,13 +2464,32 @@ esp_err_t esp_mcp_server_register_tool(esp_mcp_server_handle_t server_handle, co
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (!tool_config->name || !tool_config->handler) {
+    if (!tool_config->name || (!tool_config->handler && !tool_config->stream_handler)) {
         ESP_LOGE(TAG, "Tool name and handler are required");
         return ESP_ERR_INVALID_ARG;
     }
 
+    if (tool_config->stream_argument && !tool_config->stream_sink.write) {
+        ESP_LOGE(TAG, "Tool '%s' streams '%s' but has no sink", tool_config->name, tool_config->stream_argument);
+        return ESP_ERR_INVALID_ARG;
+    }
+
     mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)server_handle;
 
+#if CONFIG_ESP_MCP_SERVER_STREAM_ARGUMENTS
+    if (tool_config->stream_argument && !ctx->stream_lock) {
+        ctx->stream_lock = xSemaphoreCreateMutex();
+        if (!ctx->stream_lock) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+#else
+    if (tool_config->stream_argument) {
+        ESP_LOGE(TAG, "Streamed tool arguments are disabled (CONFIG_ESP_MCP_SERVER_STREAM_ARGUMENTS)");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+#endif
+
     // Check if tool already exists
     for (size_t i = 0; i < ctx->tool_count; i++) {
         if (strcmp(ctx->tools[i].name, tool_config->name) == 0) {
@@ -726,30 +2511,45 @@ esp_err_t esp_mcp_server_register_tool(esp_mcp_server_handle_t server_handle, co
     ctx->tools[idx].description = tool_config->description ? strdup(tool_config->description) : NULL;
     ctx->tools[idx].input_schema = tool_config->input_schema;
     ctx->tools[idx].handler = tool_config->handler;
+    ctx->tools[idx].stream_handler = tool_config->handler ? NULL : tool_config->stream_handler;
     ctx->tools[idx].user_data = tool_config->user_data;
+    // A call that feeds a sink has side effects, so it is never shared
+    ctx->tools[idx].coalesce = tool_config->coalesce && tool_config->handler && !tool_config->stream_argument;
 
     if (!ctx->tools[idx].name) {
         return ESP_ERR_NO_MEM;
     }
 
+#if CONFIG_ESP_MCP_SERVER_STREAM_ARGUMENTS
+    ctx->tools[idx].stream_argument = tool_config->stream_argument ? strdup(tool_config->stream_argument) : NULL;
+    ctx->tools[idx].stream_base64 = tool_config->stream_base64;
+    ctx->tools[idx].stream_sink = tool_config->stream_sink;
+    ctx->tools[idx].stream_owner = NULL;
+    if (tool_config->stream_argument && !ctx->tools[idx].stream_argument) {
+        free(ctx->tools[idx].name);
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+
+    // Fold the new entry in, in list order, with every field tools/list reports
+    uint32_t hash = ctx->tools_hash;
+    hash = catalog_hash_string(hash, tool_config->name);
+    hash = catalog_hash_string(hash, tool_config->title);
+    hash = catalog_hash_string(hash, tool_config->description);
+    char *schema_text = tool_config->input_schema ? json_writer_print(tool_config->input_schema) : NULL;
+    hash = catalog_hash_string(hash, schema_text);
+    cJSON_free(schema_text);
+    ctx->tools_hash = hash;
+    update_catalog_hash(ctx);
+
     ctx->tool_count++;
     ESP_LOGI(TAG, "Tool '%s' registered successfully", tool_config->name);
     return ESP_OK;
 }
 
-esp_err_t esp_mcp_server_register_resource(esp_mcp_server_handle_t server_handle, const esp_mcp_resource_config_t *resource_config) {
-    if (!server_handle || !resource_config) {
-        ESP_LOGE(TAG, "Invalid arguments");
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    if (!resource_config->uri_template || !resource_config->name || !resource_config->handler) {
-        ESP_LOGE(TAG, "Resource URI template, name, and handler are required");
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)server_handle;
-
+// Add a resource entry; a filesystem provider or partition range is taken over on success
+static esp_err_t add_resource(mcp_server_ctx_t *ctx, const esp_mcp_resource_config_t *resource_config,
+                              fs_resource_t *fs, partition_resource_t *partition) {
     // Check if resource already exists
     for (size_t i = 0; i < ctx->resource_count; i++) {
         if (strcmp(ctx->resources[i].name, resource_config->name) == 0) {
@@ -773,16 +2573,208 @@ esp_err_t esp_mcp_server_register_resource(esp_mcp_server_handle_t server_handle
     ctx->resources[idx].mime_type = resource_config->mime_type ? strdup(resource_config->mime_type) : NULL;
     ctx->resources[idx].handler = resource_config->handler;
     ctx->resources[idx].user_data = resource_config->user_data;
+#if CONFIG_ESP_MCP_SERVER_FS_RESOURCES
+    ctx->resources[idx].fs = fs;
+#endif
+#if CONFIG_ESP_MCP_SERVER_PARTITION_RESOURCES
+    ctx->resources[idx].partition = partition;
+#endif
 
     if (!ctx->resources[idx].uri_template || !ctx->resources[idx].name) {
         return ESP_ERR_NO_MEM;
     }
 
+    uint32_t hash = ctx->resources_hash;
+    hash = catalog_hash_string(hash, resource_config->uri_template);
+    hash = catalog_hash_string(hash, resource_config->name);
+    hash = catalog_hash_string(hash, resource_config->title);
+    hash = catalog_hash_string(hash, resource_config->description);
+    hash = catalog_hash_string(hash, resource_config->mime_type);
+    ctx->resources_hash = hash;
+    update_catalog_hash(ctx);
+
     ctx->resource_count++;
     ESP_LOGI(TAG, "Resource '%s' registered successfully", resource_config->name);
     return ESP_OK;
 }
 
+esp_err_t esp_mcp_server_register_resource(esp_mcp_server_handle_t server_handle, const esp_mcp_resource_config_t *resource_config) {
+    if (!server_handle || !resource_config) {
+        ESP_LOGE(TAG, "Invalid arguments");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!resource_config->uri_template || !resource_config->name || !resource_config->handler) {
+        ESP_LOGE(TAG, "Resource URI template, name, and handler are required");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return add_resource((mcp_server_ctx_t *)server_handle, resource_config, NULL, NULL);
+}
+
+esp_err_t esp_mcp_server_register_fs_resource(esp_mcp_server_handle_t server_handle,
+                                              const esp_mcp_fs_resource_config_t *config) {
+    if (!server_handle || !config || !config->base_path) {
+        ESP_LOGE(TAG, "Invalid arguments");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+#if CONFIG_ESP_MCP_SERVER_FS_RESOURCES
+    fs_resource_t *fs;
+    esp_err_t ret = fs_resource_create(config, &fs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Published as a template whose variable spans the rest of the path
+    char uri_template[128];
+    snprintf(uri_template, sizeof(uri_template), "%s{+path}", fs_resource_uri_prefix(fs));
+    esp_mcp_resource_config_t resource_config = {
+        .uri_template = uri_template,
+        .name = config->name ? config->name : "files",
+        .description = config->description,
+    };
+    ret = add_resource((mcp_server_ctx_t *)server_handle, &resource_config, fs, NULL);
+    if (ret != ESP_OK) {
+        fs_resource_destroy(fs);
+    }
+    return ret;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t esp_mcp_server_register_partition_resource(esp_mcp_server_handle_t server_handle,
+                                                     const esp_mcp_partition_resource_config_t *config) {
+    if (!server_handle || !config || !config->uri || !config->name || !config->partition_label) {
+        ESP_LOGE(TAG, "Invalid arguments");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+#if CONFIG_ESP_MCP_SERVER_PARTITION_RESOURCES
+    partition_resource_t *partition;
+    esp_err_t ret = partition_resource_create(config, &partition);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    esp_mcp_resource_config_t resource_config = {
+        .uri_template = config->uri,
+        .name = config->name,
+        .title = config->title,
+        .description = config->description,
+        .mime_type = config->mime_type ? config->mime_type : "application/octet-stream",
+    };
+    ret = add_resource((mcp_server_ctx_t *)server_handle, &resource_config, NULL, partition);
+    if (ret != ESP_OK) {
+        partition_resource_destroy(partition);
+    }
+    return ret;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t esp_mcp_server_register_completion(esp_mcp_server_handle_t server_handle,
+                                             const char *uri_template,
+                                             const char *argument,
+                                             const char *const *values,
+                                             size_t value_count) {
+    if (!server_handle || !uri_template || !argument || (!values && value_count > 0)) {
+        ESP_LOGE(TAG, "Invalid arguments");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+#if CONFIG_ESP_MCP_SERVER_COMPLETIONS
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)server_handle;
+
+    // The variable must belong to a registered resource template
+    char placeholder[72];
+    int len = snprintf(placeholder, sizeof(placeholder), "{%s}", argument);
+    if (len < 0 || (size_t)len >= sizeof(placeholder)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool found = false;
+    for (size_t i = 0; i < ctx->resource_count; i++) {
+        if (strcmp(ctx->resources[i].uri_template, uri_template) == 0 &&
+            strstr(ctx->resources[i].uri_template, placeholder)) {
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        ESP_LOGE(TAG, "No resource template '%s' with variable '%s'", uri_template, argument);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    completion_index_t index;
+    esp_err_t ret = completion_index_build(&index, values, value_count);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Replace the candidate set if this variable already has one
+    for (size_t i = 0; i < ctx->completion_count; i++) {
+        if (strcmp(ctx->completions[i].uri_template, uri_template) == 0 &&
+            strcmp(ctx->completions[i].argument, argument) == 0) {
+            completion_index_free(&ctx->completions[i].index);
+            ctx->completions[i].index = index;
+            return ESP_OK;
+        }
+    }
+
+    ret = expand_completion_array(ctx);
+    if (ret != ESP_OK) {
+        completion_index_free(&index);
+        return ret;
+    }
+
+    size_t idx = ctx->completion_count;
+    ctx->completions[idx].uri_template = strdup(uri_template);
+    ctx->completions[idx].argument = strdup(argument);
+    ctx->completions[idx].index = index;
+
+    if (!ctx->completions[idx].uri_template || !ctx->completions[idx].argument) {
+        free(ctx->completions[idx].uri_template);
+        free(ctx->completions[idx].argument);
+        completion_index_free(&ctx->completions[idx].index);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ctx->completion_count++;
+    ESP_LOGI(TAG, "Registered %u completion values for '%s' in '%s'",
+             (unsigned)index.count, argument, uri_template);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t esp_mcp_server_register_middleware(esp_mcp_server_handle_t server_handle,
+                                             const esp_mcp_middleware_t *middleware) {
+#if CONFIG_ESP_MCP_SERVER_MIDDLEWARE
+    if (!server_handle || !middleware || (!middleware->pre && !middleware->post)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)server_handle;
+    if (ctx->is_running) {
+        ESP_LOGE(TAG, "Middleware must be registered before the server starts");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (ctx->middleware_count >= CONFIG_ESP_MCP_SERVER_MAX_MIDDLEWARE) {
+        ESP_LOGE(TAG, "Middleware limit (%d) reached", CONFIG_ESP_MCP_SERVER_MAX_MIDDLEWARE);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ctx->middleware[ctx->middleware_count++] = *middleware;
+    ESP_LOGI(TAG, "Registered middleware %u", (unsigned)ctx->middleware_count);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
 
 esp_err_t esp_mcp_server_get_stats(esp_mcp_server_handle_t server_handle,
                                    uint16_t *active_sessions,
@@ -795,9 +2787,208 @@ esp_err_t esp_mcp_server_get_stats(esp_mcp_server_handle_t server_handle,
 
     mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)server_handle;
 
-    if (active_sessions) *active_sessions = ctx->active_sessions;
+    if (active_sessions) *active_sessions = current_active_sessions(ctx);
     if (total_tools) *total_tools = ctx->tool_count;
     if (total_resources) *total_resources = ctx->resource_count;
 
     return ESP_OK;
 }
+
+esp_err_t esp_mcp_server_get_detailed_stats(esp_mcp_server_handle_t server_handle, esp_mcp_server_stats_t *stats) {
+    if (!server_handle || !stats) {
+        ESP_LOGE(TAG, "Invalid arguments");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)server_handle;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->active_sessions = current_active_sessions(ctx);
+    stats->total_tools = ctx->tool_count;
+    stats->total_resources = ctx->resource_count;
+    stats->total_requests = ctx->total_requests;
+    stats->failed_requests = ctx->failed_requests;
+    stats->tls_handshakes = ctx->tls_handshakes;
+    stats->auth_rejected = ctx->auth_rejected;
+    stats->arena_overflows = request_arena_overflows();
+    stats->arena_high_water = request_arena_high_water();
+#if CONFIG_ESP_MCP_SERVER_STACK_PROFILER
+    stats->stack_min_free = stack_profiler_min_free();
+#endif
+    single_flight_get_counters(ctx->flights, &stats->coalesced_runs, &stats->coalesced_shared);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_mcp_server_get_alloc_profile(esp_mcp_server_handle_t server_handle,
+                                           esp_mcp_alloc_profile_entry_t *entries,
+                                           size_t max_entries,
+                                           size_t *entry_count) {
+    if (!server_handle || !entries || !entry_count) {
+        ESP_LOGE(TAG, "Invalid arguments");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+#if CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER
+    *entry_count = alloc_profiler_snapshot(entries, max_entries);
+    return ESP_OK;
+#else
+    *entry_count = 0;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t esp_mcp_server_get_stack_profile(esp_mcp_server_handle_t server_handle,
+                                           esp_mcp_stack_profile_entry_t *entries,
+                                           size_t max_entries,
+                                           size_t *entry_count) {
+    if (!server_handle || !entries || !entry_count) {
+        ESP_LOGE(TAG, "Invalid arguments");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+#if CONFIG_ESP_MCP_SERVER_STACK_PROFILER
+    *entry_count = stack_profiler_snapshot(entries, max_entries);
+    return ESP_OK;
+#else
+    *entry_count = 0;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t esp_mcp_server_send_request(esp_mcp_server_handle_t server_handle, const char *method, const cJSON *params,
+                                      uint32_t timeout_ms, esp_mcp_response_cb_t callback, void *user_data) {
+    if (!server_handle || !method || !callback) {
+        ESP_LOGE(TAG, "Invalid arguments");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+#if MCP_EVENT_STREAM_SUPPORTED
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)server_handle;
+    if (!ctx->outbound || ctx->lite_transport) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    // Bind the request to the current stream; only its client may answer
+    event_target_t target = { .ctx = ctx, .session = -1 };
+    xSemaphoreTake(ctx->event_stream_lock, portMAX_DELAY);
+    if (ctx->event_stream) {
+        target.session = httpd_req_to_sockfd(ctx->event_stream);
+    }
+    xSemaphoreGive(ctx->event_stream_lock);
+    if (target.session < 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = mcp_outbound_send(ctx->outbound, target.session, method, params, timeout_ms, callback, user_data,
+                                      send_event, &target);
+    if (ret == ESP_ERR_INVALID_STATE) {
+        // The stream was lost or replaced; requests still waiting on it can no longer be answered
+        mcp_outbound_fail_session(ctx->outbound, target.session, ESP_ERR_INVALID_STATE);
+    }
+    return ret;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t esp_mcp_server_handle_request(esp_mcp_server_handle_t server_handle, const char *request, size_t len,
+                                        char **response) {
+    if (!server_handle || !request || !response) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)server_handle;
+    *response = NULL;
+
+    alloc_profiler_request_begin();
+    // Dispatch may modify the body in place, so work on a private copy
+    char *body = MCP_MALLOC(len + 1);
+    if (!body) {
+        alloc_profiler_request_end();
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(body, request, len);
+    body[len] = '\0';
+
+    mcp_transport_response_t resp;
+    mcp_dispatch_body(body, len, ctx, NULL, &resp);
+    MCP_FREE(body);
+
+    // The response now belongs to the caller, so it is not a leak of this request
+    alloc_profiler_hand_over(resp.body);
+    alloc_profiler_request_end();
+    if (resp.status != 200) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *response = resp.body;
+    return ESP_OK;
+}
+
+#if CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+static esp_err_t write_capture_file(const char *data, size_t len, void *arg) {
+    return fwrite(data, 1, len, (FILE *)arg) == len ? ESP_OK : ESP_FAIL;
+}
+#endif
+
+esp_err_t esp_mcp_server_export_capture(esp_mcp_server_handle_t server_handle, const char *path) {
+#if CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+    if (!server_handle || !path) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mcp_server_ctx_t *ctx = (mcp_server_ctx_t *)server_handle;
+    if (!ctx->capture) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        ESP_LOGE(TAG, "Failed to open '%s' for writing", path);
+        return ESP_FAIL;
+    }
+    esp_err_t ret = traffic_capture_export(ctx->capture, write_capture_file, fp);
+    if (fclose(fp) != 0 && ret == ESP_OK) {
+        ret = ESP_FAIL;
+    }
+    return ret;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+// Replayed streaming tools write into a sink that only accepts the output
+static esp_err_t discard_chunk(void *ctx, const char *data, size_t len) {
+    return ESP_OK;
+}
+
+// Replay callback: dispatch without capturing and discard the response
+static void replay_request(char *body, size_t len, void *arg, int *status, size_t *response_len) {
+    static const mcp_transport_stream_t discard_stream = { .send_chunk = discard_chunk, .sockfd = -1 };
+    mcp_transport_response_t resp;
+    alloc_profiler_request_begin();
+    dispatch_and_release(body, len, (mcp_server_ctx_t *)arg, &discard_stream, &resp);
+    *status = resp.status;
+    *response_len = resp.streamed ? resp.streamed_len : (resp.body ? strlen(resp.body) : 0);
+    cJSON_free(resp.body);
+    alloc_profiler_request_end();
+}
+
+esp_err_t esp_mcp_server_replay_capture(esp_mcp_server_handle_t server_handle, const char *path, bool realtime,
+                                        esp_mcp_replay_stats_t *stats) {
+    if (!server_handle || !path || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        ESP_LOGE(TAG, "Failed to open capture '%s'", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+    esp_err_t ret = traffic_capture_replay(fp, realtime, replay_request, server_handle, stats);
+    fclose(fp);
+
+    ESP_LOGI(TAG, "Replayed %" PRIu32 " requests (%" PRIu32 " skipped, %" PRIu32 " mismatched) in %" PRIu64 " us",
+             stats->requests, stats->skipped, stats->mismatches, stats->total_us);
+    return ret;
+}
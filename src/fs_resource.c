@@ -0,0 +1,422 @@
+/**
+ * @file fs_resource.c
+ * @brief Resources served from a mounted VFS directory
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_ESP_MCP_SERVER_FS_RESOURCES
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/param.h>
+#include "esp_log.h"
+#include "alloc_profiler.h"
+#include "content_writer.h"
+#include "fs_resource.h"
+
+static const char *TAG = "MCP_FS_RESOURCE";
+
+#define FS_RESOURCE_DEFAULT_PREFIX "file:///"
+#define FS_RESOURCE_DEFAULT_CHUNK_SIZE 1024
+
+// Directories are listed one entry URI per line
+#define FS_RESOURCE_DIRECTORY_MIME "text/uri-list"
+
+struct fs_resource {
+    char *base_path;
+    char *uri_prefix;
+    size_t prefix_len;
+    size_t chunk_size;
+};
+
+typedef enum {
+    FS_ENTRY_NONE,
+    FS_ENTRY_FILE,
+    FS_ENTRY_DIR,
+} fs_entry_kind_t;
+
+static const struct {
+    const char *extension;
+    const char *mime_type;
+} MIME_TYPES[] = {
+    {"txt", "text/plain"},
+    {"log", "text/plain"},
+    {"cfg", "text/plain"},
+    {"conf", "text/plain"},
+    {"ini", "text/plain"},
+    {"csv", "text/csv"},
+    {"md", "text/markdown"},
+    {"htm", "text/html"},
+    {"html", "text/html"},
+    {"css", "text/css"},
+    {"js", "text/javascript"},
+    {"json", "application/json"},
+    {"xml", "application/xml"},
+    {"yml", "application/yaml"},
+    {"yaml", "application/yaml"},
+    {"png", "image/png"},
+    {"jpg", "image/jpeg"},
+    {"jpeg", "image/jpeg"},
+    {"gif", "image/gif"},
+    {"bmp", "image/bmp"},
+    {"wav", "audio/wav"},
+    {"mp3", "audio/mpeg"},
+    {"pdf", "application/pdf"},
+    {"gz", "application/gzip"},
+};
+
+const char* fs_resource_mime_type(const char *path) {
+    const char *slash = strrchr(path, '/');
+    const char *dot = strrchr(slash ? slash : path, '.');
+    if (dot) {
+        for (size_t i = 0; i < sizeof(MIME_TYPES) / sizeof(MIME_TYPES[0]); i++) {
+            if (strcasecmp(dot + 1, MIME_TYPES[i].extension) == 0) {
+                return MIME_TYPES[i].mime_type;
+            }
+        }
+    }
+    return "application/octet-stream";
+}
+
+esp_err_t fs_resource_create(const esp_mcp_fs_resource_config_t *config, fs_resource_t **fs) {
+    if (!config || !config->base_path || !fs) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->chunk_size != 0 && config->chunk_size < CONTENT_WRITER_MIN_SIZE) {
+        ESP_LOGE(TAG, "chunk_size must be at least %d bytes", CONTENT_WRITER_MIN_SIZE);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    fs_resource_t *f = calloc(1, sizeof(*f));
+    if (!f) {
+        return ESP_ERR_NO_MEM;
+    }
+    f->base_path = strdup(config->base_path);
+    f->uri_prefix = strdup(config->uri_prefix ? config->uri_prefix : FS_RESOURCE_DEFAULT_PREFIX);
+    f->chunk_size = config->chunk_size ? config->chunk_size : FS_RESOURCE_DEFAULT_CHUNK_SIZE;
+    if (!f->base_path || !f->uri_prefix) {
+        fs_resource_destroy(f);
+        return ESP_ERR_NO_MEM;
+    }
+    f->prefix_len = strlen(f->uri_prefix);
+
+    // Paths are built as base_path + "/" + relative path
+    size_t base_len = strlen(f->base_path);
+    while (base_len > 1 && f->base_path[base_len - 1] == '/') {
+        f->base_path[--base_len] = '\0';
+    }
+
+    *fs = f;
+    return ESP_OK;
+}
+
+void fs_resource_destroy(fs_resource_t *fs) {
+    if (!fs) {
+        return;
+    }
+    free(fs->base_path);
+    free(fs->uri_prefix);
+    free(fs);
+}
+
+const char* fs_resource_uri_prefix(const fs_resource_t *fs) {
+    return fs->uri_prefix;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    return (tolower((unsigned char)c) - 'a') + 10;
+}
+
+bool fs_resource_resolve(const fs_resource_t *fs, const char *uri, char *path) {
+    if (strncmp(uri, fs->uri_prefix, fs->prefix_len) != 0) {
+        return false;
+    }
+
+    int base_len = snprintf(path, FS_RESOURCE_PATH_MAX, "%s/", strcmp(fs->base_path, "/") == 0 ? "" : fs->base_path);
+    if (base_len < 0 || base_len >= FS_RESOURCE_PATH_MAX) {
+        return false;
+    }
+
+    // Percent-decode the rest of the URI into the path
+    size_t len = base_len;
+    for (const char *p = uri + fs->prefix_len; *p; p++) {
+        char c = *p;
+        if (c == '%' && isxdigit((unsigned char)p[1]) && isxdigit((unsigned char)p[2])) {
+            c = (char)(hex_value(p[1]) << 4 | hex_value(p[2]));
+            p += 2;
+            if (c == '\0') {
+                return false;
+            }
+        }
+        if (len + 1 >= FS_RESOURCE_PATH_MAX) {
+            return false;
+        }
+        path[len++] = c;
+    }
+    while (len > 1 && path[len - 1] == '/') {
+        len--;
+    }
+    path[len] = '\0';
+
+    // Only the decoded path tells whether a segment climbs out of the base directory
+    for (const char *segment = path + base_len; segment; ) {
+        const char *end = strchr(segment, '/');
+        size_t segment_len = end ? (size_t)(end - segment) : strlen(segment);
+        if (segment_len == 2 && segment[0] == '.' && segment[1] == '.') {
+            ESP_LOGW(TAG, "Rejected path outside %s: %s", fs->base_path, uri);
+            return false;
+        }
+        segment = end ? end + 1 : NULL;
+    }
+    return true;
+}
+
+static fs_entry_kind_t entry_kind(const char *path, size_t *size) {
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+        *size = st.st_size;
+        return FS_ENTRY_FILE;
+    }
+    // Some filesystems (SPIFFS) cannot stat their mount point, so directories are probed by opening them
+    DIR *dir = opendir(path);
+    if (dir) {
+        closedir(dir);
+        return FS_ENTRY_DIR;
+    }
+    return FS_ENTRY_NONE;
+}
+
+// Destination of a directory listing: the response stream, or a buffer (NULL to measure)
+typedef struct {
+    esp_mcp_content_writer_t *writer;
+    char *buf;
+    size_t size;
+    size_t len;
+} listing_sink_t;
+
+static void sink_write(listing_sink_t *sink, const char *data, size_t len) {
+    if (sink->writer) {
+        esp_mcp_content_append_text(sink->writer, data, len);
+        return;
+    }
+    if (sink->buf && sink->len < sink->size) {
+        memcpy(sink->buf + sink->len, data, MIN(len, sink->size - sink->len));
+    }
+    sink->len += len;
+}
+
+// Write a file name as a URI path segment, percent-encoding all but unreserved characters
+static void sink_write_name(listing_sink_t *sink, const char *name) {
+    static const char HEX[] = "0123456789ABCDEF";
+    while (*name) {
+        size_t run = 0;
+        while (name[run] && (isalnum((unsigned char)name[run]) || strchr("-._~", name[run]))) {
+            run++;
+        }
+        sink_write(sink, name, run);
+        name += run;
+        if (*name) {
+            char escaped[3] = {'%', HEX[(uint8_t)*name >> 4], HEX[(uint8_t)*name & 0xf]};
+            sink_write(sink, escaped, sizeof(escaped));
+            name++;
+        }
+    }
+}
+
+// List a directory entry by entry, without holding more than one name at a time
+static esp_err_t write_listing(const char *path, const char *uri, listing_sink_t *sink) {
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    size_t uri_len = strlen(uri);
+    bool has_slash = uri_len > 0 && uri[uri_len - 1] == '/';
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        sink_write(sink, uri, uri_len);
+        if (!has_slash) {
+            sink_write(sink, "/", 1);
+        }
+        sink_write_name(sink, entry->d_name);
+        if (entry->d_type == DT_DIR) {
+            sink_write(sink, "/", 1);
+        }
+        sink_write(sink, "\r\n", 2);
+    }
+    closedir(dir);
+    return sink->writer ? sink->writer->error : ESP_OK;
+}
+
+static char* render_listing(const char *path, const char *uri) {
+    listing_sink_t sink = { 0 };
+    if (write_listing(path, uri, &sink) != ESP_OK) {
+        return NULL;
+    }
+
+    // Entries added between the two passes are cut off at the measured size
+    sink.size = sink.len;
+    sink.len = 0;
+    sink.buf = MCP_MALLOC(sink.size + 1);
+    if (!sink.buf) {
+        return NULL;
+    }
+    if (write_listing(path, uri, &sink) != ESP_OK) {
+        MCP_FREE(sink.buf);
+        return NULL;
+    }
+    sink.buf[MIN(sink.len, sink.size)] = '\0';
+    return sink.buf;
+}
+
+// Read a whole file, as text or base64-encoded
+static char* load_file(const char *path, size_t size, bool base64) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    char *data = MCP_MALLOC(size + 1);
+    if (!data) {
+        fclose(f);
+        return NULL;
+    }
+    size_t len = fread(data, 1, size, f);
+    bool failed = ferror(f);
+    fclose(f);
+    if (failed) {
+        MCP_FREE(data);
+        return NULL;
+    }
+    data[len] = '\0';
+    if (!base64) {
+        return data;
+    }
+
+    size_t encoded_size = ESP_MCP_BASE64_ENCODED_LEN(len) + 1;
+    char *encoded = MCP_MALLOC(encoded_size);
+    if (encoded) {
+        esp_mcp_base64_encode(data, len, encoded, encoded_size);
+    }
+    MCP_FREE(data);
+    return encoded;
+}
+
+cJSON* fs_resource_read(const fs_resource_t *fs, const char *uri, const char *path) {
+    size_t size = 0;
+    fs_entry_kind_t kind = entry_kind(path, &size);
+    if (kind == FS_ENTRY_NONE) {
+        return NULL;
+    }
+
+    const char *mime_type = FS_RESOURCE_DIRECTORY_MIME;
+    bool text = true;
+    char *data;
+    if (kind == FS_ENTRY_DIR) {
+        data = render_listing(path, uri);
+    } else {
+        mime_type = fs_resource_mime_type(path);
+        text = content_writer_is_text_type(mime_type);
+        data = load_file(path, size, !text);
+    }
+    if (!data) {
+        return NULL;
+    }
+
+    cJSON *result = cJSON_CreateObject();
+    if (result) {
+        cJSON *contents_array = cJSON_CreateArray();
+        cJSON *content = cJSON_CreateObject();
+
+        cJSON_AddStringToObject(content, "uri", uri);
+        cJSON_AddStringToObject(content, "mimeType", mime_type);
+        cJSON_AddStringToObject(content, text ? "text" : "blob", data);
+
+        cJSON_AddItemToArray(contents_array, content);
+        cJSON_AddItemToObject(result, "contents", contents_array);
+    }
+    MCP_FREE(data);
+    return result;
+}
+
+static int read_file(void *ctx, uint8_t *buf, size_t size) {
+    FILE *f = (FILE *)ctx;
+    size_t n = fread(buf, 1, size, f);
+    return n == 0 && ferror(f) ? -1 : (int)n;
+}
+
+esp_err_t fs_resource_stream(const fs_resource_t *fs, const char *uri, const char *path,
+                             const mcp_transport_stream_t *stream, const cJSON *id, size_t *sent) {
+    *sent = 0;
+    size_t size = 0;
+    fs_entry_kind_t kind = entry_kind(path, &size);
+    if (kind == FS_ENTRY_NONE) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    FILE *f = NULL;
+    const char *mime_type = FS_RESOURCE_DIRECTORY_MIME;
+    bool text = true;
+    if (kind == FS_ENTRY_FILE) {
+        f = fopen(path, "rb");
+        if (!f) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        mime_type = fs_resource_mime_type(path);
+        text = content_writer_is_text_type(mime_type);
+    }
+
+    // Staging buffer for the response, followed by the read buffer of text files;
+    // binary files are read straight into the staging buffer and encoded in place
+    bool read_buffer = f && text;
+    char *buf = MCP_MALLOC(fs->chunk_size * (read_buffer ? 2 : 1));
+    if (!buf) {
+        if (f) {
+            fclose(f);
+        }
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_mcp_content_writer_t writer = { 0 };
+    esp_err_t ret = content_writer_begin_contents(&writer, stream, id, buf, fs->chunk_size);
+    if (ret == ESP_OK) {
+        if (kind == FS_ENTRY_DIR) {
+            content_writer_begin_resource_text(&writer, uri, mime_type);
+            listing_sink_t sink = { .writer = &writer };
+            ret = write_listing(path, uri, &sink);
+        } else if (text) {
+            content_writer_begin_resource_text(&writer, uri, mime_type);
+            char *chunk = buf + fs->chunk_size;
+            size_t n;
+            while (writer.error == ESP_OK && (n = fread(chunk, 1, fs->chunk_size, f)) > 0) {
+                esp_mcp_content_append_text(&writer, chunk, n);
+            }
+            ret = ferror(f) ? ESP_FAIL : writer.error;
+        } else {
+            ret = content_writer_add_resource_blob(&writer, uri, mime_type, NULL, 0, read_file, f);
+        }
+        if (ret == ESP_OK) {
+            ret = content_writer_finish(&writer, false);
+        }
+    }
+    *sent = writer.sent;
+
+    if (f) {
+        fclose(f);
+    }
+    MCP_FREE(buf);
+    return ret;
+}
+
+#endif // CONFIG_ESP_MCP_SERVER_FS_RESOURCES
@@ -1,130 +1,178 @@
 #include "json_rpc.h"
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include "esp_log.h"
+#include "alloc_profiler.h"
+#include "json_writer.h"
 
 static const char *TAG = "JSON_RPC";
 
-bool jsonrpc_parse_message(const char *json_str, jsonrpc_msg_t *msg) {
-    if (!json_str || !msg) {
+bool jsonrpc_parse_message(char *buf, size_t len, jsonrpc_msg_t *msg) {
+    if (!buf || !msg) {
         return false;
     }
 
     // Initialize message structure
     memset(msg, 0, sizeof(jsonrpc_msg_t));
+    msg->params_token = -1;
 
-    cJSON *json = cJSON_Parse(json_str);
-    if (!json) {
+    // Count first so that the token array is a single allocation of the right size
+    int count = json_tokenize(buf, len, NULL, 0);
+    if (count <= 0 || count > CONFIG_ESP_MCP_SERVER_MAX_JSON_TOKENS) {
+        ESP_LOGE(TAG, count > 0 ? "Too many JSON values" : "Failed to parse JSON");
+        return false;
+    }
+    msg->tokens = MCP_MALLOC(count * sizeof(json_token_t));
+    if (!msg->tokens) {
+        return false;
+    }
+    if (json_tokenize(buf, len, msg->tokens, count) != count) {
         ESP_LOGE(TAG, "Failed to parse JSON");
+        jsonrpc_free_message(msg);
         return false;
     }
+    msg->buf = buf;
+    const json_token_t *tokens = msg->tokens;
 
     // Check for jsonrpc version
-    cJSON *jsonrpc = cJSON_GetObjectItem(json, "jsonrpc");
-    if (!jsonrpc || !cJSON_IsString(jsonrpc) || strcmp(jsonrpc->valuestring, "2.0") != 0) {
+    const char *jsonrpc = json_token_string(buf, tokens, json_token_find(buf, tokens, 0, "jsonrpc"));
+    if (!jsonrpc || strcmp(jsonrpc, "2.0") != 0) {
         ESP_LOGE(TAG, "Invalid or missing jsonrpc version");
-        cJSON_Delete(json);
+        jsonrpc_free_message(msg);
         return false;
     }
-    msg->jsonrpc = strdup(jsonrpc->valuestring);
+    msg->jsonrpc = jsonrpc;
 
     // Get ID (can be null for notifications)
-    cJSON *id = cJSON_GetObjectItem(json, "id");
-    if (id) {
-        msg->id = cJSON_Duplicate(id, 1);
+    int id = json_token_find(buf, tokens, 0, "id");
+    if (id >= 0) {
+        msg->id = json_token_to_cjson(buf, tokens, id);
     }
 
     // Check if it's a request/notification or response
-    cJSON *method = cJSON_GetObjectItem(json, "method");
-    cJSON *result = cJSON_GetObjectItem(json, "result");
-    cJSON *error = cJSON_GetObjectItem(json, "error");
+    int method = json_token_find(buf, tokens, 0, "method");
+    int result = json_token_find(buf, tokens, 0, "result");
+    int error = json_token_find(buf, tokens, 0, "error");
 
-    if (method && cJSON_IsString(method)) {
+    if (json_token_string(buf, tokens, method)) {
         // It's a request or notification
-        msg->method = strdup(method->valuestring);
-
-        cJSON *params = cJSON_GetObjectItem(json, "params");
-        if (params) {
-            msg->params = cJSON_Duplicate(params, 1);
-        }
+        msg->method = json_token_string(buf, tokens, method);
+        msg->params_token = json_token_find(buf, tokens, 0, "params");
 
         if (msg->id) {
             msg->type = JSONRPC_REQUEST;
         } else {
             msg->type = JSONRPC_NOTIFICATION;
         }
-    } else if (result || error) {
+    } else if (result >= 0 || error >= 0) {
         // It's a response
-        if (result) {
-            msg->result = cJSON_Duplicate(result, 1);
+        if (result >= 0) {
+            msg->result = json_token_to_cjson(buf, tokens, result);
             msg->type = JSONRPC_RESPONSE;
         } else {
-            msg->error = cJSON_Duplicate(error, 1);
+            msg->error = json_token_to_cjson(buf, tokens, error);
             msg->type = JSONRPC_ERROR;
         }
     } else {
         ESP_LOGE(TAG, "Invalid JSON-RPC message format");
-        cJSON_Delete(json);
         jsonrpc_free_message(msg);
         return false;
     }
 
-    cJSON_Delete(json);
     return true;
 }
 
-char* jsonrpc_create_response(const cJSON *id, const cJSON *result) {
-    cJSON *response = cJSON_CreateObject();
-    if (!response) {
-        return NULL;
+const cJSON* jsonrpc_get_params(jsonrpc_msg_t *msg) {
+    if (!msg->params && msg->params_token >= 0) {
+        msg->params = json_token_to_cjson(msg->buf, msg->tokens, msg->params_token);
     }
+    return msg->params;
+}
 
-    cJSON_AddStringToObject(response, "jsonrpc", "2.0");
+const char* jsonrpc_get_param_string(const jsonrpc_msg_t *msg, const char *key) {
+    return json_token_string(msg->buf, msg->tokens, json_token_find(msg->buf, msg->tokens, msg->params_token, key));
+}
 
-    if (result) {
-        cJSON_AddItemToObject(response, "result", cJSON_Duplicate(result, 1));
-    } else {
-        cJSON_AddNullToObject(response, "result");
-    }
+cJSON* jsonrpc_build_param(const jsonrpc_msg_t *msg, const char *key) {
+    int index = json_token_find(msg->buf, msg->tokens, msg->params_token, key);
+    return index >= 0 ? json_token_to_cjson(msg->buf, msg->tokens, index) : NULL;
+}
 
-    if (id) {
-        cJSON_AddItemToObject(response, "id", cJSON_Duplicate(id, 1));
-    } else {
-        cJSON_AddNullToObject(response, "id");
-    }
+typedef struct {
+    const cJSON *id;
+    const cJSON *result;
+} response_args_t;
+
+static void render_response(json_writer_t *writer, const void *arg) {
+    const response_args_t *args = (const response_args_t *)arg;
+    json_writer_literal(writer, "{\"jsonrpc\":\"2.0\",\"result\":");
+    json_writer_value(writer, args->result);
+    json_writer_literal(writer, ",\"id\":");
+    json_writer_value(writer, args->id);
+    json_writer_literal(writer, "}");
+}
 
-    char *response_str = cJSON_Print(response);
-    cJSON_Delete(response);
-    return response_str;
+char* jsonrpc_create_response(const cJSON *id, const cJSON *result) {
+    // Serialized straight from the handler's result, without copying it into an envelope object
+    response_args_t args = { .id = id, .result = result };
+    return json_writer_render(render_response, &args);
 }
 
-char* jsonrpc_create_error(const cJSON *id, int code, const char *message, const cJSON *data) {
-    cJSON *response = cJSON_CreateObject();
-    if (!response) {
-        return NULL;
+typedef struct {
+    const cJSON *id;
+    int code;
+    const char *message;
+    const cJSON *data;
+} error_args_t;
+
+static void render_error(json_writer_t *writer, const void *arg) {
+    const error_args_t *args = (const error_args_t *)arg;
+    char code[16];
+    int code_len = snprintf(code, sizeof(code), "%d", args->code);
+
+    json_writer_literal(writer, "{\"jsonrpc\":\"2.0\",\"error\":{\"code\":");
+    json_writer_raw(writer, code, code_len);
+    json_writer_literal(writer, ",\"message\":");
+    json_writer_string(writer, args->message, strlen(args->message));
+    if (args->data) {
+        json_writer_literal(writer, ",\"data\":");
+        json_writer_value(writer, args->data);
     }
+    json_writer_literal(writer, "},\"id\":");
+    json_writer_value(writer, args->id);
+    json_writer_literal(writer, "}");
+}
 
-    cJSON_AddStringToObject(response, "jsonrpc", "2.0");
-
-    cJSON *error = cJSON_CreateObject();
-    cJSON_AddNumberToObject(error, "code", code);
-    cJSON_AddStringToObject(error, "message", message ? message : "Unknown error");
+char* jsonrpc_create_error(const cJSON *id, int code, const char *message, const cJSON *data) {
+    error_args_t args = {
+        .id = id,
+        .code = code,
+        .message = message ? message : "Unknown error",
+        .data = data,
+    };
+    return json_writer_render(render_error, &args);
+}
 
-    if (data) {
-        cJSON_AddItemToObject(error, "data", cJSON_Duplicate(data, 1));
+typedef struct {
+    const char *method;
+    const cJSON *params;
+    const cJSON *id;
+} request_args_t;
+
+static void render_request(json_writer_t *writer, const void *arg) {
+    const request_args_t *args = (const request_args_t *)arg;
+    json_writer_literal(writer, "{\"jsonrpc\":\"2.0\",\"method\":");
+    json_writer_string(writer, args->method, strlen(args->method));
+    if (args->params) {
+        json_writer_literal(writer, ",\"params\":");
+        json_writer_value(writer, args->params);
     }
-
-    cJSON_AddItemToObject(response, "error", error);
-
-    if (id) {
-        cJSON_AddItemToObject(response, "id", cJSON_Duplicate(id, 1));
-    } else {
-        cJSON_AddNullToObject(response, "id");
+    if (args->id) {
+        json_writer_literal(writer, ",\"id\":");
+        json_writer_value(writer, args->id);
     }
-
-    char *response_str = cJSON_Print(response);
-    cJSON_Delete(response);
-    return response_str;
+    json_writer_literal(writer, "}");
 }
 
 char* jsonrpc_create_request(const char *method, const cJSON *params, const cJSON *id) {
@@ -132,100 +180,97 @@ char* jsonrpc_create_request(const char *method, const cJSON *params, const cJSO
         return NULL;
     }
 
-    cJSON *request = cJSON_CreateObject();
-    if (!request) {
-        return NULL;
-    }
-
-    cJSON_AddStringToObject(request, "jsonrpc", "2.0");
-    cJSON_AddStringToObject(request, "method", method);
-
-    if (params) {
-        cJSON_AddItemToObject(request, "params", cJSON_Duplicate(params, 1));
-    }
-
-    if (id) {
-        cJSON_AddItemToObject(request, "id", cJSON_Duplicate(id, 1));
-    }
-
-    char *request_str = cJSON_Print(request);
-    cJSON_Delete(request);
-    return request_str;
+    request_args_t args = { .method = method, .params = params, .id = id };
+    return json_writer_render(render_request, &args);
 }
 
 char* jsonrpc_create_notification(const char *method, const cJSON *params) {
     return jsonrpc_create_request(method, params, NULL);
 }
 
-char* jsonrpc_process_message(const char *json_str, const jsonrpc_method_t *methods, size_t method_count, void *user_data) {
-    if (!json_str || !methods) {
+char* jsonrpc_dispatch(jsonrpc_msg_t *msg, const jsonrpc_method_t *methods, size_t method_count, void *user_data) {
+    if (!msg || !methods) {
         return jsonrpc_create_error(NULL, JSONRPC_INVALID_REQUEST, "Invalid parameters", NULL);
     }
 
-    jsonrpc_msg_t msg;
-    if (!jsonrpc_parse_message(json_str, &msg)) {
-        return jsonrpc_create_error(NULL, JSONRPC_PARSE_ERROR, "Parse error", NULL);
-    }
-
     // Handle only requests and notifications
-    if (msg.type != JSONRPC_REQUEST && msg.type != JSONRPC_NOTIFICATION) {
-        jsonrpc_free_message(&msg);
-        return jsonrpc_create_error(msg.id, JSONRPC_INVALID_REQUEST, "Invalid request", NULL);
+    if (msg->type != JSONRPC_REQUEST && msg->type != JSONRPC_NOTIFICATION) {
+        return jsonrpc_create_error(msg->id, JSONRPC_INVALID_REQUEST, "Invalid request", NULL);
     }
 
     // Find method handler
     jsonrpc_method_handler_t handler = NULL;
     for (size_t i = 0; i < method_count; i++) {
-        if (strcmp(methods[i].method, msg.method) == 0) {
+        if (strcmp(methods[i].method, msg->method) == 0) {
             handler = methods[i].handler;
             break;
         }
     }
 
     if (!handler) {
-        char *error_response = NULL;
-        if (msg.type == JSONRPC_REQUEST) {
-            error_response = jsonrpc_create_error(msg.id, JSONRPC_METHOD_NOT_FOUND, "Method not found", NULL);
+        if (msg->type == JSONRPC_REQUEST) {
+            return jsonrpc_create_error(msg->id, JSONRPC_METHOD_NOT_FOUND, "Method not found", NULL);
         }
-        jsonrpc_free_message(&msg);
-        return error_response;
+        return NULL;
     }
 
     // Call method handler
-    cJSON *result = handler(msg.params, msg.id, user_data);
-    char *response = NULL;
-
-    if (msg.type == JSONRPC_REQUEST) {
-        if (result) {
-            // Check if the result is actually an error indicator
-            cJSON *error_type = cJSON_GetObjectItem(result, "_jsonrpc_error");
-            if (error_type && cJSON_IsString(error_type)) {
-                // Handle special error types
-                int error_code = JSONRPC_INTERNAL_ERROR;
-                const char *default_message = "Internal error";
-
-                if (strcmp(error_type->valuestring, "invalid_params") == 0) {
-                    error_code = JSONRPC_INVALID_PARAMS;
-                    default_message = "Invalid params";
-                }
-
-                cJSON *message = cJSON_GetObjectItem(result, "message");
-                cJSON *data = cJSON_GetObjectItem(result, "data");
-
-                response = jsonrpc_create_error(msg.id, error_code,
-                    message && cJSON_IsString(message) ? message->valuestring : default_message,
-                    data);
-            } else {
-                response = jsonrpc_create_response(msg.id, result);
-            }
-            cJSON_Delete(result);
-        } else {
-            response = jsonrpc_create_error(msg.id, JSONRPC_INTERNAL_ERROR, "Internal error", NULL);
-        }
-    }
+    cJSON *result = handler(msg, user_data);
     // Notifications don't return responses
+    char *response = msg->type == JSONRPC_REQUEST ? jsonrpc_create_result(msg->id, result) : NULL;
+    cJSON_Delete(result);
 
-    jsonrpc_free_message(&msg);
+    return response;
+}
+
+char* jsonrpc_create_result(const cJSON *id, const cJSON *result) {
+    if (!result) {
+        return jsonrpc_create_error(id, JSONRPC_INTERNAL_ERROR, "Internal error", NULL);
+    }
+
+    // Check if the result is actually an error indicator
+    cJSON *error_type = cJSON_GetObjectItem(result, "_jsonrpc_error");
+    if (!error_type || !cJSON_IsString(error_type)) {
+        return jsonrpc_create_response(id, result);
+    }
+
+    // Handle special error types
+    int error_code = JSONRPC_INTERNAL_ERROR;
+    const char *default_message = "Internal error";
+
+    if (strcmp(error_type->valuestring, "invalid_params") == 0) {
+        error_code = JSONRPC_INVALID_PARAMS;
+        default_message = "Invalid params";
+    }
+
+    cJSON *message = cJSON_GetObjectItem(result, "message");
+    cJSON *data = cJSON_GetObjectItem(result, "data");
+
+    return jsonrpc_create_error(id, error_code,
+        message && cJSON_IsString(message) ? message->valuestring : default_message,
+        data);
+}
+
+char* jsonrpc_process_message(const char *json_str, const jsonrpc_method_t *methods, size_t method_count, void *user_data) {
+    if (!json_str || !methods) {
+        return jsonrpc_create_error(NULL, JSONRPC_INVALID_REQUEST, "Invalid parameters", NULL);
+    }
+
+    // The parser decodes in place, so work on a copy
+    char *buf = MCP_STRDUP(json_str);
+    if (!buf) {
+        return NULL;
+    }
+
+    jsonrpc_msg_t msg;
+    char *response;
+    if (jsonrpc_parse_message(buf, strlen(buf), &msg)) {
+        response = jsonrpc_dispatch(&msg, methods, method_count, user_data);
+        jsonrpc_free_message(&msg);
+    } else {
+        response = jsonrpc_create_error(NULL, JSONRPC_PARSE_ERROR, "Parse error", NULL);
+    }
+    MCP_FREE(buf);
     return response;
 }
 
@@ -238,15 +283,16 @@ void jsonrpc_free_message(jsonrpc_msg_t *msg) {
         return;
     }
 
-    if (msg->jsonrpc) {
-        free(msg->jsonrpc);
-        msg->jsonrpc = NULL;
-    }
+    // jsonrpc and method point into the tokenized buffer, which the caller owns
+    msg->jsonrpc = NULL;
+    msg->method = NULL;
 
-    if (msg->method) {
-        free(msg->method);
-        msg->method = NULL;
+    if (msg->tokens) {
+        MCP_FREE(msg->tokens);
+        msg->tokens = NULL;
     }
+    msg->buf = NULL;
+    msg->params_token = -1;
 
     if (msg->params) {
         cJSON_Delete(msg->params);
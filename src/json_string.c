@@ -0,0 +1,233 @@
+/**
+ * @file json_string.c
+ * @brief Word-at-a-time scanning, escaping and unescaping of JSON strings
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "json_string.h"
+#include "esp_mcp_server.h"
+
+// Native register width: 4 bytes on the ESP32 family, 8 on the linux target
+typedef uintptr_t json_word_t;
+
+#define WORD_ONES  ((json_word_t)-1 / 0xff)   // 0x0101...01
+#define WORD_HIGHS (WORD_ONES * 0x80)         // 0x8080...80
+
+// Nonzero iff some byte of v is zero
+static inline json_word_t has_zero_byte(json_word_t v) {
+    return (v - WORD_ONES) & ~v & WORD_HIGHS;
+}
+
+// Nonzero iff some byte of w is a quote, a backslash or a control character.
+// Exact as a whole-word test; it does not tell which byte matched.
+static inline json_word_t has_special_byte(json_word_t w) {
+    return has_zero_byte(w ^ (WORD_ONES * '"')) |
+           has_zero_byte(w ^ (WORD_ONES * '\\')) |
+           ((w - WORD_ONES * 0x20) & ~w & WORD_HIGHS);
+}
+
+static inline int is_special(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+size_t json_string_scan(const char *str, size_t len) {
+    size_t i = 0;
+
+    // Byte steps up to the first aligned word; unaligned loads trap or are split on Xtensa
+    while (i < len && ((uintptr_t)(str + i) & (sizeof(json_word_t) - 1)) != 0) {
+        if (is_special((unsigned char)str[i])) {
+            return i;
+        }
+        i++;
+    }
+
+    for (; i + sizeof(json_word_t) <= len; i += sizeof(json_word_t)) {
+        json_word_t w;
+        memcpy(&w, __builtin_assume_aligned(str + i, sizeof(json_word_t)), sizeof(w));
+        if (has_special_byte(w)) {
+            break;
+        }
+    }
+
+    // Locate the match within the word, or finish the tail
+    for (; i < len; i++) {
+        if (is_special((unsigned char)str[i])) {
+            return i;
+        }
+    }
+    return len;
+}
+
+size_t json_string_escape_char(unsigned char c, char *out) {
+    static const char hex[] = "0123456789abcdef";
+
+    out[0] = '\\';
+    switch (c) {
+        case '"':  out[1] = '"'; return 2;
+        case '\\': out[1] = '\\'; return 2;
+        case '\n': out[1] = 'n'; return 2;
+        case '\r': out[1] = 'r'; return 2;
+        case '\t': out[1] = 't'; return 2;
+        case '\b': out[1] = 'b'; return 2;
+        case '\f': out[1] = 'f'; return 2;
+        default:
+            memcpy(out + 1, "u00", 3);
+            out[4] = hex[c >> 4];
+            out[5] = hex[c & 0x0f];
+            return 6;
+    }
+}
+
+size_t json_string_escaped_len(const char *str, size_t len) {
+    size_t escaped = len;
+    size_t i = json_string_scan(str, len);
+    while (i < len) {
+        char esc[JSON_STRING_ESCAPE_MAX];
+        escaped += json_string_escape_char((unsigned char)str[i], esc) - 1;
+        i++;
+        i += json_string_scan(str + i, len - i);
+    }
+    return escaped;
+}
+
+static int parse_hex4(const char *in, size_t len, uint32_t *value) {
+    if (len < 4) {
+        return 0;
+    }
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = in[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9') {
+            v |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            v |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            v |= c - 'A' + 10;
+        } else {
+            return 0;
+        }
+    }
+    *value = v;
+    return 1;
+}
+
+static size_t encode_utf8(uint32_t cp, char *out) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xc0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3f));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xe0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3f));
+        out[2] = (char)(0x80 | (cp & 0x3f));
+        return 3;
+    }
+    out[0] = (char)(0xf0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3f));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3f));
+    out[3] = (char)(0x80 | (cp & 0x3f));
+    return 4;
+}
+
+ssize_t json_string_unescape(const char *in, size_t len, char *out) {
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < len) {
+        size_t run = json_string_scan(in + i, len - i);
+        // Raw control characters are passed through, as cJSON does
+        while (i + run < len && in[i + run] != '\\') {
+            run++;
+            run += json_string_scan(in + i + run, len - i - run);
+        }
+        if (out + o != in + i) {
+            memmove(out + o, in + i, run);
+        }
+        i += run;
+        o += run;
+        if (i == len) {
+            break;
+        }
+
+        // in[i] is a backslash; the output never overtakes the input
+        if (i + 1 == len) {
+            return -1;
+        }
+        char c = in[i + 1];
+        i += 2;
+        switch (c) {
+            case '"':
+            case '\\':
+            case '/': out[o++] = c; break;
+            case 'b': out[o++] = '\b'; break;
+            case 'f': out[o++] = '\f'; break;
+            case 'n': out[o++] = '\n'; break;
+            case 'r': out[o++] = '\r'; break;
+            case 't': out[o++] = '\t'; break;
+            case 'u': {
+                uint32_t cp;
+                if (!parse_hex4(in + i, len - i, &cp)) {
+                    return -1;
+                }
+                i += 4;
+                if (cp >= 0xd800 && cp <= 0xdbff) {
+                    uint32_t low;
+                    if (len - i < 6 || in[i] != '\\' || in[i + 1] != 'u' ||
+                        !parse_hex4(in + i + 2, len - i - 2, &low) || low < 0xdc00 || low > 0xdfff) {
+                        return -1;
+                    }
+                    i += 6;
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                } else if (cp >= 0xdc00 && cp <= 0xdfff) {
+                    return -1;
+                }
+                o += encode_utf8(cp, out + o);
+                break;
+            }
+            default:
+                return -1;
+        }
+    }
+    return (ssize_t)o;
+}
+
+size_t esp_mcp_json_escape(const char *str, size_t len, char *out, size_t out_size) {
+    size_t escaped_len = json_string_escaped_len(str, len);
+    if (!out || out_size <= escaped_len) {
+        return escaped_len;
+    }
+
+    size_t i = 0;
+    size_t o = 0;
+    while (i < len) {
+        size_t run = json_string_scan(str + i, len - i);
+        memcpy(out + o, str + i, run);
+        i += run;
+        o += run;
+        if (i < len) {
+            o += json_string_escape_char((unsigned char)str[i], out + o);
+            i++;
+        }
+    }
+    out[o] = '\0';
+    return o;
+}
+
+esp_err_t esp_mcp_json_unescape(const char *in, size_t len, char *out, size_t *out_len) {
+    if ((!in && len > 0) || !out || !out_len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ssize_t decoded = json_string_unescape(in, len, out);
+    if (decoded < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_len = decoded;
+    return ESP_OK;
+}
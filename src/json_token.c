@@ -0,0 +1,352 @@
+/**
+ * @file json_token.c
+ * @brief In-situ JSON tokenizer for request bodies
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "json_string.h"
+#include "json_token.h"
+
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t pos;
+    json_token_t *tokens;              // NULL while counting
+    size_t max_tokens;
+    size_t count;
+    int depth;
+    int error;
+} tokenizer_t;
+
+static bool parse_value(tokenizer_t *t);
+
+static void skip_whitespace(tokenizer_t *t) {
+    while (t->pos < t->len) {
+        char c = t->buf[t->pos];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            break;
+        }
+        t->pos++;
+    }
+}
+
+static bool fail(tokenizer_t *t, int error) {
+    if (t->error == 0) {
+        t->error = error;
+    }
+    return false;
+}
+
+// Reserve the next token; returns its index, or -1 if the array is full
+static int add_token(tokenizer_t *t, json_token_type_t type, size_t start) {
+    if (t->tokens) {
+        if (t->count >= t->max_tokens) {
+            fail(t, JSON_TOKENIZE_NO_TOKENS);
+            return -1;
+        }
+        json_token_t *token = &t->tokens[t->count];
+        token->type = type;
+        token->start = start;
+        token->len = 0;
+        token->size = 0;
+        token->end = t->count + 1;
+    }
+    return (int)t->count++;
+}
+
+static void finish_token(tokenizer_t *t, int index, size_t len, size_t size) {
+    if (t->tokens) {
+        t->tokens[index].len = len;
+        t->tokens[index].size = size;
+        t->tokens[index].end = t->count;
+    }
+}
+
+static bool parse_string(tokenizer_t *t) {
+    size_t start = t->pos + 1;
+    size_t i = start;
+
+    // Find the closing quote; only backslashes need a closer look
+    for (;;) {
+        i += json_string_scan(t->buf + i, t->len - i);
+        if (i >= t->len) {
+            return fail(t, JSON_TOKENIZE_INVALID);
+        }
+        char c = t->buf[i];
+        if (c == '"') {
+            break;
+        }
+        if (c == '\\') {
+            if (i + 1 >= t->len) {
+                return fail(t, JSON_TOKENIZE_INVALID);
+            }
+            i += 2;
+        } else {
+            i++;                       // Raw control character, accepted as cJSON does
+        }
+    }
+    t->pos = i + 1;
+
+    int index = add_token(t, JSON_TOKEN_STRING, start);
+    if (index < 0) {
+        return false;
+    }
+    if (t->tokens) {
+        ssize_t decoded = json_string_unescape(t->buf + start, i - start, t->buf + start);
+        if (decoded < 0) {
+            return fail(t, JSON_TOKENIZE_INVALID);
+        }
+        // At most on the closing quote, which has been consumed already
+        t->buf[start + decoded] = '\0';
+        finish_token(t, index, decoded, 0);
+    }
+    return true;
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// JSON number grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+static bool is_number(const char *s, size_t len) {
+    size_t i = 0;
+    if (i < len && s[i] == '-') {
+        i++;
+    }
+    if (i >= len || !is_digit(s[i])) {
+        return false;
+    }
+    if (s[i] == '0') {
+        i++;
+    } else {
+        while (i < len && is_digit(s[i])) {
+            i++;
+        }
+    }
+    if (i < len && s[i] == '.') {
+        i++;
+        if (i >= len || !is_digit(s[i])) {
+            return false;
+        }
+        while (i < len && is_digit(s[i])) {
+            i++;
+        }
+    }
+    if (i < len && (s[i] == 'e' || s[i] == 'E')) {
+        i++;
+        if (i < len && (s[i] == '+' || s[i] == '-')) {
+            i++;
+        }
+        if (i >= len || !is_digit(s[i])) {
+            return false;
+        }
+        while (i < len && is_digit(s[i])) {
+            i++;
+        }
+    }
+    return i == len;
+}
+
+static bool parse_primitive(tokenizer_t *t) {
+    size_t start = t->pos;
+    while (t->pos < t->len) {
+        char c = t->buf[t->pos];
+        if (c == ',' || c == ']' || c == '}' || c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            break;
+        }
+        t->pos++;
+    }
+
+    const char *s = t->buf + start;
+    size_t len = t->pos - start;
+    bool valid = (len == 4 && memcmp(s, "true", 4) == 0) ||
+                 (len == 5 && memcmp(s, "false", 5) == 0) ||
+                 (len == 4 && memcmp(s, "null", 4) == 0) ||
+                 is_number(s, len);
+    if (!valid) {
+        return fail(t, JSON_TOKENIZE_INVALID);
+    }
+
+    int index = add_token(t, JSON_TOKEN_PRIMITIVE, start);
+    if (index < 0) {
+        return false;
+    }
+    finish_token(t, index, len, 0);
+    return true;
+}
+
+static bool parse_container(tokenizer_t *t, bool is_object) {
+    if (++t->depth > JSON_TOKEN_MAX_DEPTH) {
+        return fail(t, JSON_TOKENIZE_INVALID);
+    }
+
+    size_t start = t->pos;
+    char close = is_object ? '}' : ']';
+    int index = add_token(t, is_object ? JSON_TOKEN_OBJECT : JSON_TOKEN_ARRAY, start);
+    if (index < 0) {
+        return false;
+    }
+    t->pos++;
+
+    size_t size = 0;
+    skip_whitespace(t);
+    if (t->pos < t->len && t->buf[t->pos] == close) {
+        t->pos++;
+    } else {
+        for (;;) {
+            if (is_object) {
+                skip_whitespace(t);
+                if (t->pos >= t->len || t->buf[t->pos] != '"' || !parse_string(t)) {
+                    return fail(t, JSON_TOKENIZE_INVALID);
+                }
+                skip_whitespace(t);
+                if (t->pos >= t->len || t->buf[t->pos] != ':') {
+                    return fail(t, JSON_TOKENIZE_INVALID);
+                }
+                t->pos++;
+            }
+            if (!parse_value(t)) {
+                return false;
+            }
+            size++;
+
+            skip_whitespace(t);
+            if (t->pos >= t->len) {
+                return fail(t, JSON_TOKENIZE_INVALID);
+            }
+            char c = t->buf[t->pos++];
+            if (c == close) {
+                break;
+            }
+            if (c != ',') {
+                return fail(t, JSON_TOKENIZE_INVALID);
+            }
+        }
+    }
+
+    finish_token(t, index, t->pos - start, size);
+    t->depth--;
+    return true;
+}
+
+static bool parse_value(tokenizer_t *t) {
+    skip_whitespace(t);
+    if (t->pos >= t->len) {
+        return fail(t, JSON_TOKENIZE_INVALID);
+    }
+
+    switch (t->buf[t->pos]) {
+        case '{':
+            return parse_container(t, true);
+        case '[':
+            return parse_container(t, false);
+        case '"':
+            return parse_string(t);
+        default:
+            return parse_primitive(t);
+    }
+}
+
+int json_tokenize(char *buf, size_t len, json_token_t *tokens, size_t max_tokens) {
+    if (!buf) {
+        return JSON_TOKENIZE_INVALID;
+    }
+
+    tokenizer_t t = {
+        .buf = buf,
+        .len = len,
+        .tokens = tokens,
+        .max_tokens = max_tokens,
+    };
+    if (!parse_value(&t)) {
+        return t.error ? t.error : JSON_TOKENIZE_INVALID;
+    }
+    skip_whitespace(&t);
+    if (t.pos != len) {
+        return JSON_TOKENIZE_INVALID;
+    }
+    return (int)t.count;
+}
+
+int json_token_find(const char *buf, const json_token_t *tokens, int object, const char *key) {
+    if (object < 0 || tokens[object].type != JSON_TOKEN_OBJECT) {
+        return -1;
+    }
+
+    size_t key_len = strlen(key);
+    int i = object + 1;
+    for (uint32_t member = 0; member < tokens[object].size; member++) {
+        if (tokens[i].len == key_len && memcmp(buf + tokens[i].start, key, key_len) == 0) {
+            return i + 1;
+        }
+        i = tokens[i + 1].end;
+    }
+    return -1;
+}
+
+static cJSON* primitive_to_cjson(const char *s, size_t len) {
+    switch (s[0]) {
+        case 't':
+            return cJSON_CreateTrue();
+        case 'f':
+            return cJSON_CreateFalse();
+        case 'n':
+            return cJSON_CreateNull();
+        default:
+            break;
+    }
+
+    // Short integers are accumulated exactly, without strtod's soft-float work
+    size_t digits = len - (s[0] == '-');
+    if (digits <= 15 && !memchr(s, '.', len) && !memchr(s, 'e', len) && !memchr(s, 'E', len)) {
+        int64_t value = 0;
+        for (size_t i = s[0] == '-'; i < len; i++) {
+            value = value * 10 + (s[i] - '0');
+        }
+        return cJSON_CreateNumber((double)(s[0] == '-' ? -value : value));
+    }
+
+    char num[64];
+    if (len >= sizeof(num)) {
+        return NULL;
+    }
+    memcpy(num, s, len);
+    num[len] = '\0';
+    return cJSON_CreateNumber(strtod(num, NULL));
+}
+
+cJSON* json_token_to_cjson(const char *buf, const json_token_t *tokens, int index) {
+    const json_token_t *token = &tokens[index];
+
+    switch (token->type) {
+        case JSON_TOKEN_STRING:
+            return cJSON_CreateString(buf + token->start);
+        case JSON_TOKEN_PRIMITIVE:
+            return primitive_to_cjson(buf + token->start, token->len);
+        case JSON_TOKEN_ARRAY:
+        case JSON_TOKEN_OBJECT: {
+            bool is_object = token->type == JSON_TOKEN_OBJECT;
+            cJSON *item = is_object ? cJSON_CreateObject() : cJSON_CreateArray();
+            int i = index + 1;
+            for (uint32_t n = 0; item && n < token->size; n++) {
+                int value = is_object ? i + 1 : i;
+                cJSON *child = json_token_to_cjson(buf, tokens, value);
+                if (!child) {
+                    cJSON_Delete(item);
+                    return NULL;
+                }
+                if (is_object) {
+                    cJSON_AddItemToObject(item, buf + tokens[i].start, child);
+                } else {
+                    cJSON_AddItemToArray(item, child);
+                }
+                i = tokens[value].end;
+            }
+            return item;
+        }
+        default:
+            return NULL;
+    }
+}
@@ -0,0 +1,269 @@
+/**
+ * @file json_writer.c
+ * @brief Compact serialization of cJSON values
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "alloc_profiler.h"
+#include "json_string.h"
+#include "json_writer.h"
+
+void json_writer_raw(json_writer_t *writer, const char *data, size_t len) {
+    if (writer->buf) {
+        memcpy(writer->buf + writer->len, data, len);
+    }
+    writer->len += len;
+}
+
+void json_writer_string(json_writer_t *writer, const char *str, size_t len) {
+    json_writer_literal(writer, "\"");
+    if (!writer->buf) {
+        writer->len += json_string_escaped_len(str, len);
+    } else {
+        size_t i = 0;
+        while (i < len) {
+            size_t run = json_string_scan(str + i, len - i);
+            json_writer_raw(writer, str + i, run);
+            i += run;
+            if (i < len) {
+                char esc[JSON_STRING_ESCAPE_MAX];
+                json_writer_raw(writer, esc, json_string_escape_char((unsigned char)str[i], esc));
+                i++;
+            }
+        }
+    }
+    json_writer_literal(writer, "\"");
+}
+
+// Two digits per step halves the number of divisions, which are slow on cores without a divider
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Write the decimal digits of v backwards, ending just before end; returns the first digit
+static char* format_u32(uint32_t v, char *end) {
+    while (v >= 100) {
+        uint32_t pair = (v % 100) * 2;
+        v /= 100;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    }
+    if (v >= 10) {
+        *--end = digit_pairs[v * 2 + 1];
+        *--end = digit_pairs[v * 2];
+    } else {
+        *--end = (char)('0' + v);
+    }
+    return end;
+}
+
+static char* format_u64(uint64_t v, char *end) {
+    // Peel off eight digits at a time so that most of the work stays in 32-bit arithmetic
+    while (v > UINT32_MAX) {
+        uint32_t low = (uint32_t)(v % 100000000);
+        v /= 100000000;
+        char *digits = format_u32(low, end);
+        while (digits > end - 8) {
+            *--digits = '0';
+        }
+        end = digits;
+    }
+    return format_u32((uint32_t)v, end);
+}
+
+// Largest magnitude below which every integer is exactly representable
+#define EXACT_INT_LIMIT 9007199254740992.0
+
+// Exactly representable powers of ten
+static const double pow10_table[] = {
+    1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+};
+
+/*
+ * Shortest fixed-point form of a non-integral value, found by scaling by
+ * increasing powers of ten until the scaled value is an exact integer m with
+ * m / 10^k == value. Since the division is correctly rounded, so is the
+ * decimal m * 10^-k when parsed back, which makes the output round-trip
+ * without the sprintf/sscanf pair. Returns 0 when the value needs more than
+ * 53 bits of mantissa at every scale, leaving it to the generic path.
+ */
+static size_t format_fraction(double value, char *out) {
+    bool negative = value < 0;
+    double magnitude = negative ? -value : value;
+    if (!(magnitude >= 1e-4 && magnitude < 1e15)) {
+        return 0;
+    }
+
+    for (size_t k = 0; k < sizeof(pow10_table) / sizeof(pow10_table[0]); k++) {
+        double scaled = magnitude * pow10_table[k];
+        if (scaled >= EXACT_INT_LIMIT) {
+            return 0;
+        }
+        uint64_t m = (uint64_t)(scaled + 0.5);
+        if ((double)m / pow10_table[k] != magnitude) {
+            continue;
+        }
+
+        size_t decimals = k + 1;
+        char digits[24];
+        char *end = digits + sizeof(digits);
+        char *first = format_u64(m, end);
+        // Leading zeros so that there is at least one digit before the point
+        while ((size_t)(end - first) <= decimals) {
+            *--first = '0';
+        }
+        size_t integer_len = (end - first) - decimals;
+
+        size_t len = 0;
+        if (negative) {
+            out[len++] = '-';
+        }
+        memcpy(out + len, first, integer_len);
+        len += integer_len;
+        out[len++] = '.';
+        memcpy(out + len, first + integer_len, decimals);
+        return len + decimals;
+    }
+    return 0;
+}
+
+static void write_number(json_writer_t *writer, const cJSON *item) {
+    double d = item->valuedouble;
+    char num[32];
+    char *end = num + sizeof(num);
+    size_t len;
+
+    if (d == (double)item->valueint) {
+        // Integral and within int range: cJSON's valueint is exact
+        int32_t v = item->valueint;
+        char *first = format_u32(v < 0 ? 0u - (uint32_t)v : (uint32_t)v, end);
+        if (v < 0) {
+            *--first = '-';
+        }
+        json_writer_raw(writer, first, end - first);
+        return;
+    }
+    if (d > -EXACT_INT_LIMIT && d < EXACT_INT_LIMIT && d == (double)(int64_t)d) {
+        // Integral beyond int range, e.g. microsecond timestamps
+        int64_t v = (int64_t)d;
+        char *first = format_u64(v < 0 ? 0u - (uint64_t)v : (uint64_t)v, end);
+        if (v < 0) {
+            *--first = '-';
+        }
+        json_writer_raw(writer, first, end - first);
+        return;
+    }
+
+    if (isnan(d) || isinf(d)) {
+        json_writer_literal(writer, "null");
+        return;
+    }
+
+    len = format_fraction(d, num);
+    if (len == 0) {
+        // Same as cJSON: the shorter of %.15g/%.17g that round-trips
+        len = snprintf(num, sizeof(num), "%1.15g", d);
+        double test;
+        if (sscanf(num, "%lg", &test) != 1 || test != d) {
+            len = snprintf(num, sizeof(num), "%1.17g", d);
+        }
+    }
+    json_writer_raw(writer, num, len);
+}
+
+void json_writer_value(json_writer_t *writer, const cJSON *item) {
+    if (!item) {
+        json_writer_literal(writer, "null");
+        return;
+    }
+
+    switch (item->type & 0xff) {
+        case cJSON_NULL:
+            json_writer_literal(writer, "null");
+            break;
+        case cJSON_False:
+            json_writer_literal(writer, "false");
+            break;
+        case cJSON_True:
+            json_writer_literal(writer, "true");
+            break;
+        case cJSON_Number:
+            write_number(writer, item);
+            break;
+        case cJSON_String:
+            if (!item->valuestring) {
+                writer->failed = true;
+                return;
+            }
+            json_writer_string(writer, item->valuestring, strlen(item->valuestring));
+            break;
+        case cJSON_Raw:
+            if (!item->valuestring) {
+                writer->failed = true;
+                return;
+            }
+            json_writer_raw(writer, item->valuestring, strlen(item->valuestring));
+            break;
+        case cJSON_Array:
+            json_writer_literal(writer, "[");
+            for (const cJSON *child = item->child; child; child = child->next) {
+                json_writer_value(writer, child);
+                if (child->next) {
+                    json_writer_literal(writer, ",");
+                }
+            }
+            json_writer_literal(writer, "]");
+            break;
+        case cJSON_Object:
+            json_writer_literal(writer, "{");
+            for (const cJSON *child = item->child; child; child = child->next) {
+                if (!child->string) {
+                    writer->failed = true;
+                    return;
+                }
+                json_writer_string(writer, child->string, strlen(child->string));
+                json_writer_literal(writer, ":");
+                json_writer_value(writer, child);
+                if (child->next) {
+                    json_writer_literal(writer, ",");
+                }
+            }
+            json_writer_literal(writer, "}");
+            break;
+        default:
+            writer->failed = true;
+            break;
+    }
+}
+
+char* json_writer_render(json_writer_render_fn_t render, const void *arg) {
+    json_writer_t writer = { 0 };
+    render(&writer, arg);
+    if (writer.failed) {
+        return NULL;
+    }
+
+    writer.buf = MCP_MALLOC(writer.len + 1);
+    if (!writer.buf) {
+        return NULL;
+    }
+    writer.len = 0;
+    render(&writer, arg);
+    writer.buf[writer.len] = '\0';
+    return writer.buf;
+}
+
+static void render_value(json_writer_t *writer, const void *arg) {
+    json_writer_value(writer, (const cJSON *)arg);
+}
+
+char* json_writer_print(const cJSON *item) {
+    if (!item) {
+        return NULL;
+    }
+    return json_writer_render(render_value, item);
+}
@@ -0,0 +1,146 @@
+/**
+ * @file log_tail.c
+ * @brief Ring buffer of recent log output, read incrementally by offset
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_ESP_MCP_SERVER_LOG_TAIL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "alloc_profiler.h"
+#include "log_tail.h"
+
+static const char *TAG = "MCP_LOG_TAIL";
+
+// Longer messages are cut short in the ring (not on the console)
+#define LOG_TAIL_LINE_MAX 256
+
+// A message is left out of the ring rather than stall the logging task behind a reader
+#define LOG_TAIL_LOCK_WAIT_MS 10
+
+static SemaphoreHandle_t s_lock;
+static vprintf_like_t s_previous;
+static uint8_t s_ring[CONFIG_ESP_MCP_SERVER_LOG_TAIL_SIZE];
+static uint64_t s_written;               // Bytes appended since init; the ring holds the last of them
+static char s_line[LOG_TAIL_LINE_MAX];   // Formatting buffer, used under s_lock
+
+static void append(const char *data, size_t len) {
+    size_t pos = s_written % sizeof(s_ring);
+    size_t first = len < sizeof(s_ring) - pos ? len : sizeof(s_ring) - pos;
+    memcpy(s_ring + pos, data, first);
+    memcpy(s_ring, data + first, len - first);
+    s_written += len;
+}
+
+static int log_tail_vprintf(const char *format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int ret = s_previous(format, args);
+
+    if (xSemaphoreTake(s_lock, pdMS_TO_TICKS(LOG_TAIL_LOCK_WAIT_MS)) == pdTRUE) {
+        int len = vsnprintf(s_line, sizeof(s_line), format, copy);
+        if (len >= (int)sizeof(s_line)) {
+            len = sizeof(s_line) - 1;
+            s_line[len - 1] = '\n';
+        }
+        if (len > 0) {
+            append(s_line, len);
+        }
+        xSemaphoreGive(s_lock);
+    }
+    va_end(copy);
+    return ret;
+}
+
+void log_tail_init(void) {
+    if (s_lock) {
+        return;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_lock) {
+        ESP_LOGE(TAG, "Failed to create log tail lock");
+        return;
+    }
+    s_previous = esp_log_set_vprintf(log_tail_vprintf);
+    if (!s_previous) {
+        s_previous = vprintf;
+    }
+}
+
+// Offset of the first complete line at or after the oldest byte held, or the oldest byte if none
+static uint64_t first_line(uint64_t oldest, uint64_t end) {
+    for (uint64_t i = oldest; i < end; i++) {
+        if (s_ring[i % sizeof(s_ring)] == '\n') {
+            return i + 1;
+        }
+    }
+    return oldest;
+}
+
+cJSON* log_tail_read(const char *uri) {
+    size_t prefix_len = strlen(LOG_TAIL_URI_PREFIX);
+    if (!s_lock || strncmp(uri, LOG_TAIL_URI_PREFIX, prefix_len) != 0) {
+        return NULL;
+    }
+    const char *arg = uri + prefix_len;
+    uint64_t offset = 0;
+    if (*arg) {
+        char *end;
+        offset = strtoull(arg, &end, 10);
+        if (!isdigit((unsigned char)*arg) || *end) {
+            return NULL;
+        }
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint64_t end = s_written;
+    uint64_t oldest = end > sizeof(s_ring) ? end - sizeof(s_ring) : 0;
+    uint64_t start = offset;
+    if (offset < oldest || offset > end) {
+        // The oldest byte may be in the middle of a line once the ring has wrapped
+        start = oldest > 0 ? first_line(oldest, end) : 0;
+    }
+    size_t len = end - start;
+    char *text = MCP_MALLOC(len + 1);
+    if (text) {
+        size_t pos = start % sizeof(s_ring);
+        size_t first = len < sizeof(s_ring) - pos ? len : sizeof(s_ring) - pos;
+        memcpy(text, s_ring + pos, first);
+        memcpy(text + first, s_ring, len - first);
+        text[len] = '\0';
+    }
+    xSemaphoreGive(s_lock);
+    if (!text) {
+        return NULL;
+    }
+
+    cJSON *result = cJSON_CreateObject();
+    if (result) {
+        cJSON *contents_array = cJSON_CreateArray();
+        cJSON *content = cJSON_CreateObject();
+        cJSON *meta = cJSON_CreateObject();
+
+        cJSON_AddStringToObject(content, "uri", uri);
+        cJSON_AddStringToObject(content, "mimeType", "text/plain");
+        cJSON_AddStringToObject(content, "text", text);
+        cJSON_AddNumberToObject(meta, "nextOffset", (double)end);
+        // Bytes the ring overwrote before this read could return them
+        cJSON_AddNumberToObject(meta, "dropped", offset < start && offset <= end ? (double)(start - offset) : 0);
+        cJSON_AddItemToObject(content, "_meta", meta);
+
+        cJSON_AddItemToArray(contents_array, content);
+        cJSON_AddItemToObject(result, "contents", contents_array);
+    }
+    MCP_FREE(text);
+    return result;
+}
+
+#endif // CONFIG_ESP_MCP_SERVER_LOG_TAIL
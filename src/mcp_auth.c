@@ -0,0 +1,179 @@
+/**
+ * @file mcp_auth.c
+ * @brief Bearer-token authentication with a bounded cache of verified token digests
+ */
+
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "mbedtls/sha256.h"
+#include "mcp_auth.h"
+
+static const char *TAG = "MCP_AUTH";
+
+#define AUTH_DIGEST_LEN 32
+
+typedef struct {
+    uint8_t digest[AUTH_DIGEST_LEN];
+    int64_t expires_at_us;               // 0 marks an unused slot
+    uint32_t last_used;
+} auth_cache_entry_t;
+
+struct mcp_auth {
+    esp_mcp_auth_verifier_t verifier;
+    void *user_data;
+    SemaphoreHandle_t lock;
+    uint32_t use_counter;
+    size_t cache_entries;
+    auth_cache_entry_t cache[];
+};
+
+esp_err_t mcp_auth_create(esp_mcp_auth_verifier_t verifier, void *user_data, size_t cache_entries, mcp_auth_t **auth) {
+    if (!verifier || !auth) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mcp_auth_t *a = calloc(1, sizeof(*a) + cache_entries * sizeof(a->cache[0]));
+    if (!a) {
+        return ESP_ERR_NO_MEM;
+    }
+    a->lock = xSemaphoreCreateMutex();
+    if (!a->lock) {
+        free(a);
+        return ESP_ERR_NO_MEM;
+    }
+    a->verifier = verifier;
+    a->user_data = user_data;
+    a->cache_entries = cache_entries;
+
+    *auth = a;
+    return ESP_OK;
+}
+
+void mcp_auth_destroy(mcp_auth_t *auth) {
+    if (!auth) {
+        return;
+    }
+    vSemaphoreDelete(auth->lock);
+    // Do not leave token digests behind in freed memory
+    memset(auth->cache, 0, auth->cache_entries * sizeof(auth->cache[0]));
+    free(auth);
+}
+
+// Digest comparison whose duration does not depend on where the digests differ
+static bool digest_equals(const uint8_t *a, const uint8_t *b) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < AUTH_DIGEST_LEN; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+static bool cache_lookup(mcp_auth_t *auth, const uint8_t *digest, int64_t now) {
+    bool hit = false;
+    xSemaphoreTake(auth->lock, portMAX_DELAY);
+    for (size_t i = 0; i < auth->cache_entries; i++) {
+        auth_cache_entry_t *entry = &auth->cache[i];
+        if (entry->expires_at_us == 0) {
+            continue;
+        }
+        if (entry->expires_at_us <= now) {
+            memset(entry, 0, sizeof(*entry));
+            continue;
+        }
+        if (digest_equals(entry->digest, digest)) {
+            entry->last_used = ++auth->use_counter;
+            hit = true;
+        }
+    }
+    xSemaphoreGive(auth->lock);
+    return hit;
+}
+
+static void cache_insert(mcp_auth_t *auth, const uint8_t *digest, int64_t expires_at_us) {
+    xSemaphoreTake(auth->lock, portMAX_DELAY);
+    // Prefer a free slot, otherwise evict the least recently used token
+    auth_cache_entry_t *victim = &auth->cache[0];
+    for (size_t i = 0; i < auth->cache_entries; i++) {
+        auth_cache_entry_t *entry = &auth->cache[i];
+        if (entry->expires_at_us == 0) {
+            victim = entry;
+            break;
+        }
+        if ((int32_t)(entry->last_used - victim->last_used) < 0) {
+            victim = entry;
+        }
+    }
+    memcpy(victim->digest, digest, AUTH_DIGEST_LEN);
+    victim->expires_at_us = expires_at_us;
+    victim->last_used = ++auth->use_counter;
+    xSemaphoreGive(auth->lock);
+}
+
+// Locate the token of a bearer Authorization header, with surrounding blanks trimmed
+static bool bearer_token(const char *header, size_t len, const char **token, size_t *token_len) {
+    static const char scheme[] = "Bearer ";
+    const size_t scheme_len = sizeof(scheme) - 1;
+
+    if (!header || len <= scheme_len || strncasecmp(header, scheme, scheme_len) != 0) {
+        return false;
+    }
+
+    const char *start = header + scheme_len;
+    const char *end = header + len;
+    while (start < end && *start == ' ') {
+        start++;
+    }
+    while (end > start && (end[-1] == ' ' || end[-1] == '\t')) {
+        end--;
+    }
+    *token = start;
+    *token_len = end - start;
+    return *token_len > 0;
+}
+
+bool mcp_auth_check_header(mcp_auth_t *auth, const char *header, size_t len) {
+    const char *token;
+    size_t token_len;
+    if (!auth || !bearer_token(header, len, &token, &token_len)) {
+        return false;
+    }
+
+    uint8_t digest[AUTH_DIGEST_LEN];
+    bool cacheable = auth->cache_entries > 0 &&
+                     mbedtls_sha256((const unsigned char *)token, token_len, digest, 0) == 0;
+    int64_t now = esp_timer_get_time();
+    if (cacheable && cache_lookup(auth, digest, now)) {
+        return true;
+    }
+
+    uint32_t valid_for_s = 0;
+    if (auth->verifier(token, token_len, &valid_for_s, auth->user_data) != ESP_OK) {
+        ESP_LOGD(TAG, "Bearer token rejected");
+        return false;
+    }
+    if (cacheable && valid_for_s > 0) {
+        cache_insert(auth, digest, now + (int64_t)valid_for_s * 1000000);
+    }
+    return true;
+}
+
+mcp_auth_result_t mcp_auth_check_cached(mcp_auth_t *auth, const char *header, size_t len) {
+    const char *token;
+    size_t token_len;
+    if (!auth || !bearer_token(header, len, &token, &token_len)) {
+        return MCP_AUTH_REJECTED;
+    }
+
+    uint8_t digest[AUTH_DIGEST_LEN];
+    if (auth->cache_entries > 0 &&
+        mbedtls_sha256((const unsigned char *)token, token_len, digest, 0) == 0 &&
+        cache_lookup(auth, digest, esp_timer_get_time())) {
+        return MCP_AUTH_ACCEPTED;
+    }
+    return MCP_AUTH_UNVERIFIED;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file mcp_outbound.c
+ * @brief Correlation of server-initiated requests with client responses
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "json_rpc.h"
+#include "mcp_outbound.h"
+
+static const char *TAG = "MCP_OUTBOUND";
+
+// Resolution of request timeouts
+#define OUTBOUND_SWEEP_PERIOD_US (100 * 1000)
+
+typedef struct {
+    uint32_t id;                         // 0 marks a free slot
+    int session;                         // Event stream socket the request was sent on
+    int64_t deadline_us;
+    esp_mcp_response_cb_t callback;
+    void *user_data;
+} pending_request_t;
+
+struct mcp_outbound {
+    SemaphoreHandle_t lock;
+    esp_timer_handle_t sweep_timer;
+    uint32_t next_id;
+    size_t pending_count;
+    size_t max_pending;
+    pending_request_t pending[];
+};
+
+// Must be called with the lock held; takes the entry out of the table
+static pending_request_t take_entry(mcp_outbound_t *outbound, pending_request_t *entry) {
+    pending_request_t taken = *entry;
+    memset(entry, 0, sizeof(*entry));
+    outbound->pending_count--;
+    return taken;
+}
+
+static void sweep_timeouts(void *arg) {
+    mcp_outbound_t *outbound = (mcp_outbound_t *)arg;
+    int64_t now = esp_timer_get_time();
+
+    for (size_t i = 0; i < outbound->max_pending; i++) {
+        pending_request_t expired = { 0 };
+        xSemaphoreTake(outbound->lock, portMAX_DELAY);
+        if (outbound->pending[i].id != 0 && outbound->pending[i].deadline_us <= now) {
+            expired = take_entry(outbound, &outbound->pending[i]);
+        }
+        xSemaphoreGive(outbound->lock);
+
+        if (expired.id != 0) {
+            ESP_LOGW(TAG, "Request %" PRIu32 " timed out", expired.id);
+            expired.callback(ESP_ERR_TIMEOUT, NULL, NULL, expired.user_data);
+        }
+    }
+
+    // Sleep until the next request is sent
+    xSemaphoreTake(outbound->lock, portMAX_DELAY);
+    if (outbound->pending_count == 0) {
+        esp_timer_stop(outbound->sweep_timer);
+    }
+    xSemaphoreGive(outbound->lock);
+}
+
+esp_err_t mcp_outbound_create(size_t max_pending, mcp_outbound_t **outbound) {
+    if (!outbound || max_pending == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mcp_outbound_t *o = calloc(1, sizeof(*o) + max_pending * sizeof(o->pending[0]));
+    if (!o) {
+        return ESP_ERR_NO_MEM;
+    }
+    o->max_pending = max_pending;
+    o->next_id = 1;
+    o->lock = xSemaphoreCreateMutex();
+
+    esp_timer_create_args_t timer_args = {
+        .callback = sweep_timeouts,
+        .arg = o,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "mcp_outbound",
+    };
+    if (!o->lock || esp_timer_create(&timer_args, &o->sweep_timer) != ESP_OK) {
+        if (o->lock) {
+            vSemaphoreDelete(o->lock);
+        }
+        free(o);
+        return ESP_ERR_NO_MEM;
+    }
+
+    *outbound = o;
+    return ESP_OK;
+}
+
+void mcp_outbound_destroy(mcp_outbound_t *outbound) {
+    if (!outbound) {
+        return;
+    }
+    esp_timer_stop(outbound->sweep_timer);
+    esp_timer_delete(outbound->sweep_timer);
+    mcp_outbound_fail_all(outbound, ESP_ERR_INVALID_STATE);
+    vSemaphoreDelete(outbound->lock);
+    free(outbound);
+}
+
+esp_err_t mcp_outbound_send(mcp_outbound_t *outbound, int session, const char *method, const cJSON *params, uint32_t timeout_ms,
+                            esp_mcp_response_cb_t callback, void *user_data,
+                            mcp_outbound_send_fn_t send, void *send_arg) {
+    if (!outbound || !method || !callback || !send) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Register the entry before sending, since the response may arrive before send() returns
+    xSemaphoreTake(outbound->lock, portMAX_DELAY);
+    pending_request_t *entry = NULL;
+    for (size_t i = 0; i < outbound->max_pending && !entry; i++) {
+        if (outbound->pending[i].id == 0) {
+            entry = &outbound->pending[i];
+        }
+    }
+    if (!entry) {
+        xSemaphoreGive(outbound->lock);
+        ESP_LOGW(TAG, "Pending request table full, '%s' not sent", method);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t id = outbound->next_id++;
+    if (outbound->next_id == 0) {
+        outbound->next_id = 1;
+    }
+    entry->id = id;
+    entry->session = session;
+    entry->deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    entry->callback = callback;
+    entry->user_data = user_data;
+    if (outbound->pending_count++ == 0) {
+        esp_timer_start_periodic(outbound->sweep_timer, OUTBOUND_SWEEP_PERIOD_US);
+    }
+    xSemaphoreGive(outbound->lock);
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    cJSON *id_item = cJSON_CreateNumber(id);
+    char *message = id_item ? jsonrpc_create_request(method, params, id_item) : NULL;
+    cJSON_Delete(id_item);
+    if (message) {
+        ret = send(message, strlen(message), send_arg);
+        cJSON_free(message);
+    }
+
+    if (ret != ESP_OK) {
+        // Withdraw the entry unless it has already been completed or expired
+        xSemaphoreTake(outbound->lock, portMAX_DELAY);
+        if (entry->id == id) {
+            take_entry(outbound, entry);
+        }
+        xSemaphoreGive(outbound->lock);
+    }
+    return ret;
+}
+
+bool mcp_outbound_complete(mcp_outbound_t *outbound, int session, const cJSON *id, const cJSON *result,
+                           const cJSON *error) {
+    if (!outbound || !cJSON_IsNumber(id) || id->valuedouble < 1 || id->valuedouble > UINT32_MAX) {
+        return false;
+    }
+
+    pending_request_t completed = { 0 };
+    xSemaphoreTake(outbound->lock, portMAX_DELAY);
+    for (size_t i = 0; i < outbound->max_pending; i++) {
+        if (outbound->pending[i].id != 0 && outbound->pending[i].id == (uint32_t)id->valuedouble) {
+            // An id guessed or replayed by another client leaves the request waiting
+            if (outbound->pending[i].session == session) {
+                completed = take_entry(outbound, &outbound->pending[i]);
+            }
+            break;
+        }
+    }
+    xSemaphoreGive(outbound->lock);
+
+    if (completed.id == 0) {
+        return false;
+    }
+    completed.callback(error ? ESP_FAIL : ESP_OK, error ? NULL : result, error, completed.user_data);
+    return true;
+}
+
+// Fail the pending requests of one session, or of all sessions if all is set
+static void fail_pending(mcp_outbound_t *outbound, bool all, int session, esp_err_t reason) {
+    if (!outbound) {
+        return;
+    }
+
+    for (size_t i = 0; i < outbound->max_pending; i++) {
+        pending_request_t failed = { 0 };
+        xSemaphoreTake(outbound->lock, portMAX_DELAY);
+        if (outbound->pending[i].id != 0 && (all || outbound->pending[i].session == session)) {
+            failed = take_entry(outbound, &outbound->pending[i]);
+        }
+        xSemaphoreGive(outbound->lock);
+
+        if (failed.id != 0) {
+            failed.callback(reason, NULL, NULL, failed.user_data);
+        }
+    }
+}
+
+void mcp_outbound_fail_session(mcp_outbound_t *outbound, int session, esp_err_t reason) {
+    fail_pending(outbound, false, session, reason);
+}
+
+void mcp_outbound_fail_all(mcp_outbound_t *outbound, esp_err_t reason) {
+    fail_pending(outbound, true, -1, reason);
+}
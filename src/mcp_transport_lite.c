@@ -0,0 +1,801 @@
+/**
+ * @file mcp_transport_lite.c
+ * @brief Minimal select()-based HTTP/1.1 transport for the /mcp endpoint
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <strings.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "mcp_transport.h"
+
+static const char *TAG = "MCP_LITE";
+
+#define LITE_MAX_HEADER_LEN      2048     // Leaves room for a bearer token
+#define LITE_INITIAL_BUFFER_LEN  512
+#define LITE_SEND_TIMEOUT_SEC    5
+#define LITE_STOP_SENTINEL       (-1)
+
+#if CONFIG_ESP_MCP_SERVER_CORS
+#define LITE_CORS_ENABLED        true
+#define LITE_CORS_ORIGIN_HEADER  "Access-Control-Allow-Origin: *\r\n"
+#define LITE_CORS_HEADERS        LITE_CORS_ORIGIN_HEADER \
+                                 "Access-Control-Allow-Methods: POST, GET, OPTIONS\r\n" \
+                                 "Access-Control-Allow-Headers: Content-Type, Authorization, MCP-Protocol-Version\r\n"
+#else
+#define LITE_CORS_ENABLED        false
+#define LITE_CORS_ORIGIN_HEADER  ""
+#define LITE_CORS_HEADERS        ""
+#endif
+
+typedef enum {
+    CONN_FREE = 0,
+    CONN_READING,            // Owned by the listener, waiting for a complete request
+    CONN_QUEUED,             // Owned by a worker
+    CONN_AUTHORIZING,        // Owned by a worker verifying the token; the body is still unread
+    CONN_PARSE_PENDING,      // Returned by a worker; may hold a pipelined or just authorized request
+    CONN_CLOSING,            // Returned by a worker; must be closed by the listener
+} conn_state_t;
+
+typedef enum {
+    REQ_MCP_POST,
+    REQ_MCP_OPTIONS,
+    REQ_NOT_FOUND,
+    REQ_METHOD_NOT_ALLOWED,
+    REQ_BAD_REQUEST,
+    REQ_LENGTH_REQUIRED,
+    REQ_TOO_LARGE,
+    REQ_UNAUTHORIZED,
+} request_kind_t;
+
+typedef struct {
+    int fd;
+    volatile conn_state_t state;
+    char *buf;
+    size_t capacity;
+    size_t len;                          // Bytes currently buffered
+    size_t header_len;                   // Length of the parsed header block, 0 if incomplete
+    size_t content_len;
+    request_kind_t kind;
+    bool keep_alive;
+    bool auth_pending;                   // Headers parsed, token not yet verified
+    size_t auth_offset;                  // Authorization header value within buf
+    size_t auth_len;
+    TickType_t last_active;
+} lite_conn_t;
+
+struct mcp_lite_transport {
+    mcp_lite_transport_config_t config;
+    int listen_fd;
+    int ctrl_fd;                         // Loopback UDP socket used to wake select()
+    struct sockaddr_in ctrl_addr;
+    QueueHandle_t work_queue;
+    TaskHandle_t stop_waiter;
+    volatile bool stop_requested;
+    lite_conn_t *conns;
+    volatile uint16_t open_connections;
+};
+
+static void wake_listener(mcp_lite_transport_t *t) {
+    char byte = 0;
+    sendto(t->ctrl_fd, &byte, 1, 0, (struct sockaddr *)&t->ctrl_addr, sizeof(t->ctrl_addr));
+}
+
+static bool send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t sent = send(fd, data, len, 0);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += sent;
+        len -= sent;
+    }
+    return true;
+}
+
+static bool send_response(lite_conn_t *conn, const char *status, const char *content_type,
+                          const char *extra_headers, const char *body, size_t body_len) {
+    char header[320];
+    int header_len = snprintf(header, sizeof(header),
+            "HTTP/1.1 %s\r\n"
+            "Content-Type: %s\r\n"
+            "Content-Length: %u\r\n"
+            LITE_CORS_HEADERS
+            "Connection: %s\r\n"
+            "%s"
+            "\r\n",
+            status, content_type, (unsigned)body_len, conn->keep_alive ? "keep-alive" : "close",
+            extra_headers ? extra_headers : "");
+    if (header_len < 0 || (size_t)header_len >= sizeof(header)) {
+        return false;
+    }
+    if (!send_all(conn->fd, header, header_len)) {
+        return false;
+    }
+    return body_len == 0 || send_all(conn->fd, body, body_len);
+}
+
+static bool send_error(lite_conn_t *conn, int status, const char *message) {
+    const char *status_line;
+    switch (status) {
+        case 400: status_line = "400 Bad Request"; break;
+        case 401: status_line = "401 Unauthorized"; break;
+        case 404: status_line = "404 Not Found"; break;
+        case 405: status_line = "405 Method Not Allowed"; break;
+        case 408: status_line = "408 Request Timeout"; break;
+        case 411: status_line = "411 Length Required"; break;
+        case 413: status_line = "413 Content Too Large"; break;
+        default: status_line = "500 Internal Server Error"; break;
+    }
+    const char *extra_headers = status == 401 ? "WWW-Authenticate: Bearer\r\n" : NULL;
+    return send_response(conn, status_line, "text/plain", extra_headers, message, strlen(message));
+}
+
+// Chunked response state of a request served by a worker
+typedef struct {
+    lite_conn_t *conn;
+    bool started;
+} lite_stream_t;
+
+static esp_err_t send_stream_chunk(void *ctx, const char *data, size_t len) {
+    lite_stream_t *stream = (lite_stream_t *)ctx;
+    lite_conn_t *conn = stream->conn;
+
+    if (!stream->started) {
+        char header[320];
+        int header_len = snprintf(header, sizeof(header),
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Type: application/json\r\n"
+                "Transfer-Encoding: chunked\r\n"
+                LITE_CORS_ORIGIN_HEADER
+                "Connection: %s\r\n"
+                "\r\n",
+                conn->keep_alive ? "keep-alive" : "close");
+        if (!send_all(conn->fd, header, header_len)) {
+            return ESP_FAIL;
+        }
+        stream->started = true;
+    }
+
+    char size_line[12];
+    int size_len = snprintf(size_line, sizeof(size_line), "%x\r\n", (unsigned)len);
+    if (len == 0 || !send_all(conn->fd, size_line, size_len) ||
+        !send_all(conn->fd, data, len) || !send_all(conn->fd, "\r\n", 2)) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+// Case-insensitive comparison of a length-delimited token with a literal
+static bool token_equals(const char *token, size_t len, const char *literal) {
+    return strlen(literal) == len && strncasecmp(token, literal, len) == 0;
+}
+
+// Content-Length value: one or more digits, then only whitespace. Values past limit are clamped to limit + 1
+static bool parse_content_length(const char *value, const char *end, size_t limit, size_t *length) {
+    const char *p = value;
+    size_t n = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        n = n > limit ? n : n * 10 + (*p - '0');
+    }
+    if (p == value) {
+        return false;
+    }
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    *length = n > limit ? limit + 1 : n;
+    return p == end;
+}
+
+/**
+ * @brief Scan the buffered bytes for a complete header block and classify the request
+ *
+ * The headers are never copied: the request line and header fields are compared
+ * where they sit in the connection buffer.
+ *
+ * @return true once the header block is complete (conn->header_len is set)
+ */
+static bool parse_headers(lite_conn_t *conn, const mcp_lite_transport_config_t *config) {
+    size_t max_body_size = config->max_body_size;
+    const char *buf = conn->buf;
+    const char *end = NULL;
+    for (size_t i = 3; i < conn->len; i++) {
+        if (buf[i] == '\n' && buf[i - 1] == '\r' && buf[i - 2] == '\n' && buf[i - 3] == '\r') {
+            end = buf + i + 1;
+            break;
+        }
+    }
+    if (!end) {
+        return false;
+    }
+    conn->header_len = end - buf;
+    conn->content_len = 0;
+    conn->keep_alive = true;
+
+    // Request line: METHOD SP PATH SP VERSION CRLF
+    const char *line_end = memchr(buf, '\r', conn->header_len);
+    const char *method_end = memchr(buf, ' ', line_end - buf);
+    const char *path = method_end ? method_end + 1 : NULL;
+    const char *path_end = path ? memchr(path, ' ', line_end - path) : NULL;
+    if (!path_end) {
+        conn->kind = REQ_BAD_REQUEST;
+        conn->keep_alive = false;
+        return true;
+    }
+    const char *version = path_end + 1;
+    if (token_equals(version, line_end - version, "HTTP/1.0")) {
+        conn->keep_alive = false;
+    }
+
+    // Ignore any query string when matching the endpoint
+    const char *query = memchr(path, '?', path_end - path);
+    size_t path_len = (query ? query : path_end) - path;
+    bool is_post = token_equals(buf, method_end - buf, "POST");
+    bool is_options = token_equals(buf, method_end - buf, "OPTIONS");
+
+    if (!token_equals(path, path_len, "/mcp")) {
+        conn->kind = REQ_NOT_FOUND;
+    } else if (is_post) {
+        conn->kind = REQ_MCP_POST;
+    } else if (is_options && LITE_CORS_ENABLED) {
+        conn->kind = REQ_MCP_OPTIONS;
+    } else {
+        conn->kind = REQ_METHOD_NOT_ALLOWED;
+    }
+
+    bool has_length = false;
+    bool bad_length = false;
+    const char *authorization = NULL;
+    size_t authorization_len = 0;
+    const char *line = line_end + 2;
+    while (line < end - 2) {
+        const char *eol = memchr(line, '\r', end - line);
+        const char *colon = memchr(line, ':', eol - line);
+        if (colon) {
+            const char *value = colon + 1;
+            while (value < eol && (*value == ' ' || *value == '\t')) {
+                value++;
+            }
+            size_t name_len = colon - line;
+            size_t value_len = eol - value;
+
+            if (token_equals(line, name_len, "Content-Length")) {
+                // A repeat must agree, or the body's end is ambiguous
+                size_t length = 0;
+                if (!parse_content_length(value, eol, max_body_size, &length) ||
+                    (has_length && length != conn->content_len)) {
+                    bad_length = true;
+                }
+                conn->content_len = length;
+                has_length = true;
+            } else if (token_equals(line, name_len, "Transfer-Encoding")) {
+                // Chunked request bodies are not needed for /mcp
+                conn->kind = REQ_LENGTH_REQUIRED;
+                conn->keep_alive = false;
+            } else if (token_equals(line, name_len, "Authorization")) {
+                authorization = value;
+                authorization_len = value_len;
+            } else if (token_equals(line, name_len, "Connection")) {
+                if (token_equals(value, value_len, "close")) {
+                    conn->keep_alive = false;
+                } else if (token_equals(value, value_len, "keep-alive")) {
+                    conn->keep_alive = true;
+                }
+            }
+        }
+        line = eol + 2;
+    }
+
+    if (bad_length) {
+        // The body cannot be delimited, so neither can the next request on the connection
+        conn->kind = REQ_BAD_REQUEST;
+        conn->keep_alive = false;
+    } else if (conn->kind == REQ_MCP_POST) {
+        if (!has_length) {
+            conn->kind = REQ_LENGTH_REQUIRED;
+            conn->keep_alive = false;
+        } else if (conn->content_len > max_body_size) {
+            conn->kind = REQ_TOO_LARGE;
+            conn->keep_alive = false;
+        } else if (config->authorize) {
+            // Only a cache hit is decided here; anything the verifier must see goes to a worker
+            mcp_transport_auth_t decision = config->precheck ?
+                config->precheck(authorization, authorization_len, config->arg) : MCP_TRANSPORT_AUTH_VERIFY;
+            if (decision == MCP_TRANSPORT_AUTH_REJECT) {
+                // Reject before the body is received; the unread body makes the stream unusable
+                conn->kind = REQ_UNAUTHORIZED;
+                conn->keep_alive = false;
+            } else if (decision == MCP_TRANSPORT_AUTH_VERIFY) {
+                conn->auth_pending = true;
+                conn->auth_offset = authorization ? authorization - buf : 0;
+                conn->auth_len = authorization_len;
+            }
+        }
+    }
+    if (conn->kind != REQ_MCP_POST) {
+        // Bodies of other requests are never read, so the stream cannot be reused
+        if (conn->content_len > 0 || conn->kind != REQ_MCP_OPTIONS) {
+            conn->keep_alive = false;
+        }
+        conn->content_len = 0;
+    }
+    return true;
+}
+
+// A request is complete once its headers and the declared body are buffered
+static bool request_complete(lite_conn_t *conn, const mcp_lite_transport_config_t *config) {
+    if (conn->header_len == 0 && !parse_headers(conn, config)) {
+        return false;
+    }
+    return conn->len >= conn->header_len + conn->content_len;
+}
+
+static bool ensure_capacity(lite_conn_t *conn, size_t needed) {
+    if (conn->capacity >= needed) {
+        return true;
+    }
+    size_t new_capacity = conn->capacity ? conn->capacity : LITE_INITIAL_BUFFER_LEN;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    char *grown = realloc(conn->buf, new_capacity);
+    if (!grown) {
+        return false;
+    }
+    conn->buf = grown;
+    conn->capacity = new_capacity;
+    return true;
+}
+
+// Reset a slot to its unused state, keeping its buffer if buffers are reserved
+static void clear_conn(mcp_lite_transport_t *t, lite_conn_t *conn) {
+    char *buf = NULL;
+    size_t capacity = 0;
+    if (t->config.reserve_buffers) {
+        buf = conn->buf;
+        capacity = conn->capacity;
+    } else {
+        free(conn->buf);
+    }
+    memset(conn, 0, sizeof(*conn));
+    conn->buf = buf;
+    conn->capacity = capacity;
+    conn->fd = -1;
+    conn->state = CONN_FREE;
+}
+
+static void close_conn(mcp_lite_transport_t *t, lite_conn_t *conn) {
+    if (conn->fd >= 0) {
+        close(conn->fd);
+        t->open_connections--;
+    }
+    clear_conn(t, conn);
+}
+
+// Drop the request just served and keep any pipelined bytes that followed it
+static void consume_request(lite_conn_t *conn) {
+    size_t used = conn->header_len + conn->content_len;
+    conn->len -= used;
+    if (conn->len > 0) {
+        memmove(conn->buf, conn->buf + used, conn->len);
+    }
+    conn->header_len = 0;
+    conn->content_len = 0;
+}
+
+// Hand the connection to a worker if a whole request is buffered or its token needs verifying
+static bool try_queue_request(mcp_lite_transport_t *t, lite_conn_t *conn) {
+    if (!request_complete(conn, &t->config) && !conn->auth_pending) {
+        if (conn->header_len == 0 && conn->len >= LITE_MAX_HEADER_LEN) {
+            send_error(conn, 400, "Request header too large");
+            close_conn(t, conn);
+        }
+        return false;
+    }
+
+    int idx = conn - t->conns;
+    conn->state = conn->auth_pending ? CONN_AUTHORIZING : CONN_QUEUED;
+    if (xQueueSend(t->work_queue, &idx, 0) != pdTRUE) {
+        conn->state = CONN_READING;
+        return false;
+    }
+    return true;
+}
+
+static void read_conn(mcp_lite_transport_t *t, lite_conn_t *conn) {
+    // Until the headers are complete only the header block is buffered, growing
+    // on demand so that requests without large headers keep a small buffer
+    size_t wanted = conn->header_len + conn->content_len + 1;
+    if (conn->header_len == 0) {
+        wanted = conn->len + LITE_INITIAL_BUFFER_LEN / 2;
+        if (wanted > LITE_MAX_HEADER_LEN + 1) {
+            wanted = LITE_MAX_HEADER_LEN + 1;
+        }
+    }
+    if (!ensure_capacity(conn, wanted)) {
+        send_error(conn, 500, "Memory allocation failed");
+        close_conn(t, conn);
+        return;
+    }
+
+    // Keep one byte spare for the body terminator added before dispatch
+    ssize_t n = recv(conn->fd, conn->buf + conn->len, conn->capacity - conn->len - 1, 0);
+    if (n <= 0) {
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return;
+        }
+        close_conn(t, conn);
+        return;
+    }
+    conn->len += n;
+    conn->last_active = xTaskGetTickCount();
+    try_queue_request(t, conn);
+}
+
+static void accept_conn(mcp_lite_transport_t *t) {
+    int fd = accept(t->listen_fd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+
+    lite_conn_t *slot = NULL;
+    lite_conn_t *oldest_idle = NULL;
+    for (uint16_t i = 0; i < t->config.max_connections; i++) {
+        lite_conn_t *conn = &t->conns[i];
+        if (conn->state == CONN_FREE) {
+            slot = conn;
+            break;
+        }
+        if (conn->state == CONN_READING && conn->len == 0 &&
+            (!oldest_idle || conn->last_active < oldest_idle->last_active)) {
+            oldest_idle = conn;
+        }
+    }
+
+    // When full, make room by closing the least recently used idle connection
+    if (!slot && oldest_idle) {
+        close_conn(t, oldest_idle);
+        slot = oldest_idle;
+    }
+    if (!slot) {
+        close(fd);
+        return;
+    }
+
+    struct timeval timeout = { .tv_sec = LITE_SEND_TIMEOUT_SEC };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    // Responses are written as header then body; with Nagle the body would wait for
+    // the client's delayed ACK of the header
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    clear_conn(t, slot);
+    slot->fd = fd;
+    slot->state = CONN_READING;
+    slot->last_active = xTaskGetTickCount();
+    t->open_connections++;
+}
+
+static void listener_task(void *arg) {
+    mcp_lite_transport_t *t = (mcp_lite_transport_t *)arg;
+
+    while (!t->stop_requested) {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(t->ctrl_fd, &read_fds);
+        FD_SET(t->listen_fd, &read_fds);
+        int max_fd = t->ctrl_fd > t->listen_fd ? t->ctrl_fd : t->listen_fd;
+
+        for (uint16_t i = 0; i < t->config.max_connections; i++) {
+            lite_conn_t *conn = &t->conns[i];
+            if (conn->state == CONN_CLOSING) {
+                close_conn(t, conn);
+            } else if (conn->state == CONN_PARSE_PENDING) {
+                conn->state = CONN_READING;
+                try_queue_request(t, conn);
+            }
+            if (conn->state == CONN_READING) {
+                FD_SET(conn->fd, &read_fds);
+                if (conn->fd > max_fd) {
+                    max_fd = conn->fd;
+                }
+            }
+        }
+
+        if (select(max_fd + 1, &read_fds, NULL, NULL, NULL) < 0) {
+            if (errno != EINTR) {
+                ESP_LOGE(TAG, "select failed: %d", errno);
+                vTaskDelay(pdMS_TO_TICKS(10));
+            }
+            continue;
+        }
+
+        if (FD_ISSET(t->ctrl_fd, &read_fds)) {
+            char drain[16];
+            recv(t->ctrl_fd, drain, sizeof(drain), 0);
+        }
+        if (FD_ISSET(t->listen_fd, &read_fds)) {
+            accept_conn(t);
+        }
+        for (uint16_t i = 0; i < t->config.max_connections; i++) {
+            lite_conn_t *conn = &t->conns[i];
+            if (conn->state == CONN_READING && FD_ISSET(conn->fd, &read_fds)) {
+                read_conn(t, conn);
+            }
+        }
+    }
+
+    xTaskNotifyGive(t->stop_waiter);
+    vTaskDelete(NULL);
+}
+
+static void serve_request(mcp_lite_transport_t *t, lite_conn_t *conn) {
+    bool ok;
+    switch (conn->kind) {
+        case REQ_MCP_POST: {
+            // Terminate the body in place, preserving the first pipelined byte
+            char *body = conn->buf + conn->header_len;
+            char saved = body[conn->content_len];
+            body[conn->content_len] = '\0';
+
+            lite_stream_t stream_state = { .conn = conn };
+            mcp_transport_stream_t stream = { .send_chunk = send_stream_chunk, .ctx = &stream_state,
+                                              .sockfd = conn->fd };
+            mcp_transport_response_t resp = { .status = 200 };
+            t->config.dispatch(body, conn->content_len, t->config.arg, &stream, &resp);
+            body[conn->content_len] = saved;
+
+            if (resp.streamed) {
+                // A failed stream cannot be reported any more; dropping the connection
+                // leaves the client with an unterminated chunked body
+                ok = resp.status == 200 && stream_state.started && send_all(conn->fd, "0\r\n\r\n", 5);
+            } else if (resp.status == 200) {
+                ok = send_response(conn, "200 OK", "application/json", NULL,
+                                   resp.body, resp.body ? strlen(resp.body) : 0);
+            } else {
+                ok = send_error(conn, resp.status, resp.error ? resp.error : "Request failed");
+            }
+            cJSON_free(resp.body);
+            if (t->config.complete) {
+                t->config.complete(t->config.arg);
+            }
+            break;
+        }
+        case REQ_MCP_OPTIONS:
+            ok = send_response(conn, "204 No Content", "text/plain", NULL, NULL, 0);
+            break;
+        case REQ_NOT_FOUND:
+            ok = send_error(conn, 404, "Not found");
+            break;
+        case REQ_METHOD_NOT_ALLOWED:
+            ok = send_error(conn, 405, "Method not allowed");
+            break;
+        case REQ_LENGTH_REQUIRED:
+            ok = send_error(conn, 411, "Content-Length required");
+            break;
+        case REQ_TOO_LARGE:
+            ok = send_error(conn, 413, "Request body too large");
+            break;
+        case REQ_UNAUTHORIZED:
+            ok = send_error(conn, 401, "Unauthorized");
+            break;
+        default:
+            ok = send_error(conn, 400, "Bad request");
+            break;
+    }
+
+    if (ok && conn->keep_alive) {
+        consume_request(conn);
+        conn->last_active = xTaskGetTickCount();
+        conn->state = CONN_PARSE_PENDING;
+    } else {
+        conn->state = CONN_CLOSING;
+    }
+    wake_listener(t);
+}
+
+// Run the verifier off the listener, then either return the connection for its body or answer 401
+static void authorize_request(mcp_lite_transport_t *t, lite_conn_t *conn) {
+    const char *authorization = conn->auth_len ? conn->buf + conn->auth_offset : NULL;
+    conn->auth_pending = false;
+    if (!t->config.authorize(authorization, conn->auth_len, t->config.arg)) {
+        conn->kind = REQ_UNAUTHORIZED;
+        conn->keep_alive = false;
+        conn->content_len = 0;
+        serve_request(t, conn);
+        return;
+    }
+    conn->state = CONN_PARSE_PENDING;
+    wake_listener(t);
+}
+
+static void worker_task(void *arg) {
+    mcp_lite_transport_t *t = (mcp_lite_transport_t *)arg;
+    int idx;
+
+    while (xQueueReceive(t->work_queue, &idx, portMAX_DELAY) == pdTRUE) {
+        if (idx == LITE_STOP_SENTINEL) {
+            break;
+        }
+        lite_conn_t *conn = &t->conns[idx];
+        if (conn->state == CONN_AUTHORIZING) {
+            authorize_request(t, conn);
+        } else {
+            serve_request(t, conn);
+        }
+    }
+
+    xTaskNotifyGive(t->stop_waiter);
+    vTaskDelete(NULL);
+}
+
+static int open_listen_socket(uint16_t port, int backlog) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, backlog) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int open_ctrl_socket(struct sockaddr_in *addr) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(*addr);
+    if (bind(fd, (struct sockaddr *)addr, sizeof(*addr)) < 0 ||
+        getsockname(fd, (struct sockaddr *)addr, &addr_len) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void release_transport(mcp_lite_transport_t *t) {
+    if (t->conns) {
+        for (uint16_t i = 0; i < t->config.max_connections; i++) {
+            close_conn(t, &t->conns[i]);
+            free(t->conns[i].buf);
+        }
+        free(t->conns);
+    }
+    if (t->listen_fd >= 0) {
+        close(t->listen_fd);
+    }
+    if (t->ctrl_fd >= 0) {
+        close(t->ctrl_fd);
+    }
+    if (t->work_queue) {
+        vQueueDelete(t->work_queue);
+    }
+    free(t);
+}
+
+esp_err_t mcp_lite_transport_start(const mcp_lite_transport_config_t *config, mcp_lite_transport_t **transport) {
+    if (!config || !transport || !config->dispatch || config->max_connections == 0 || config->worker_count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mcp_lite_transport_t *t = calloc(1, sizeof(mcp_lite_transport_t));
+    if (!t) {
+        return ESP_ERR_NO_MEM;
+    }
+    t->config = *config;
+    t->listen_fd = -1;
+    t->ctrl_fd = -1;
+    t->stop_waiter = NULL;
+
+    t->conns = calloc(config->max_connections, sizeof(lite_conn_t));
+    // One slot per connection plus one stop sentinel per worker
+    t->work_queue = xQueueCreate(config->max_connections + config->worker_count, sizeof(int));
+    if (!t->conns || !t->work_queue) {
+        release_transport(t);
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint16_t i = 0; i < config->max_connections; i++) {
+        t->conns[i].fd = -1;
+    }
+    if (config->reserve_buffers) {
+        // Room for the largest header block and body, plus the body terminator
+        size_t capacity = LITE_MAX_HEADER_LEN + 1 + config->max_body_size + 1;
+        for (uint16_t i = 0; i < config->max_connections; i++) {
+            t->conns[i].buf = malloc(capacity);
+            if (!t->conns[i].buf) {
+                release_transport(t);
+                return ESP_ERR_NO_MEM;
+            }
+            t->conns[i].capacity = capacity;
+        }
+    }
+
+    t->listen_fd = open_listen_socket(config->port, config->max_connections);
+    t->ctrl_fd = open_ctrl_socket(&t->ctrl_addr);
+    if (t->listen_fd < 0 || t->ctrl_fd < 0) {
+        ESP_LOGE(TAG, "Failed to open sockets on port %d: %d", config->port, errno);
+        release_transport(t);
+        return ESP_FAIL;
+    }
+
+    if (xTaskCreate(listener_task, "mcp_lite", config->listener_stack_size, t, config->task_priority, NULL) != pdPASS) {
+        release_transport(t);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint8_t started_workers = 0;
+    for (; started_workers < config->worker_count; started_workers++) {
+        if (xTaskCreate(worker_task, "mcp_lite_wrk", config->worker_stack_size, t, config->task_priority, NULL) != pdPASS) {
+            break;
+        }
+    }
+    if (started_workers < config->worker_count) {
+        t->config.worker_count = started_workers;
+        mcp_lite_transport_stop(t);
+        return ESP_ERR_NO_MEM;
+    }
+
+    *transport = t;
+    ESP_LOGI(TAG, "Lite transport listening on port %d with %d workers", config->port, config->worker_count);
+    return ESP_OK;
+}
+
+void mcp_lite_transport_stop(mcp_lite_transport_t *transport) {
+    if (!transport) {
+        return;
+    }
+    mcp_lite_transport_t *t = transport;
+
+    t->stop_waiter = xTaskGetCurrentTaskHandle();
+    t->stop_requested = true;
+    wake_listener(t);
+    ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+
+    // Workers finish the request they are serving before seeing the sentinel
+    int sentinel = LITE_STOP_SENTINEL;
+    for (uint8_t i = 0; i < t->config.worker_count; i++) {
+        xQueueSend(t->work_queue, &sentinel, portMAX_DELAY);
+    }
+    for (uint8_t i = 0; i < t->config.worker_count; i++) {
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    }
+
+    release_transport(t);
+    ESP_LOGI(TAG, "Lite transport stopped");
+}
+
+uint16_t mcp_lite_transport_open_connections(mcp_lite_transport_t *transport) {
+    return transport ? transport->open_connections : 0;
+}
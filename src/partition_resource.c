@@ -0,0 +1,242 @@
+/**
+ * @file partition_resource.c
+ * @brief Resources served from memory-mapped flash partition ranges
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_ESP_MCP_SERVER_PARTITION_RESOURCES
+
+#include <string.h>
+#include <stdlib.h>
+#include <sys/param.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "alloc_profiler.h"
+#include "content_writer.h"
+#include "partition_resource.h"
+
+static const char *TAG = "MCP_PARTITION_RESOURCE";
+
+#define PARTITION_RESOURCE_DEFAULT_MIME "application/octet-stream"
+#define PARTITION_RESOURCE_DEFAULT_CHUNK_SIZE 1024
+// Ranges are mapped one window at a time; windows follow the 64 KB MMU pages of the flash address
+#define PARTITION_RESOURCE_WINDOW_SIZE (64 * 1024)
+
+struct partition_resource {
+    const esp_partition_t *partition;
+    size_t offset;
+    size_t size;
+    char *mime_type;
+    bool text;
+    size_t chunk_size;
+};
+
+esp_err_t partition_resource_create(const esp_mcp_partition_resource_config_t *config, partition_resource_t **res) {
+    if (!config || !config->partition_label || !res) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->chunk_size != 0 && config->chunk_size < CONTENT_WRITER_MIN_SIZE) {
+        ESP_LOGE(TAG, "chunk_size must be at least %d bytes", CONTENT_WRITER_MIN_SIZE);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_ANY, ESP_PARTITION_SUBTYPE_ANY,
+                                                                config->partition_label);
+    if (!partition) {
+        ESP_LOGE(TAG, "No partition labelled '%s'", config->partition_label);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (config->offset >= partition->size ||
+        config->size > partition->size - config->offset) {
+        ESP_LOGE(TAG, "Range %u+%u does not fit in partition '%s' (%u bytes)", (unsigned)config->offset,
+                 (unsigned)config->size, config->partition_label, (unsigned)partition->size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    partition_resource_t *r = calloc(1, sizeof(*r));
+    if (!r) {
+        return ESP_ERR_NO_MEM;
+    }
+    r->partition = partition;
+    r->offset = config->offset;
+    r->size = config->size ? config->size : partition->size - config->offset;
+    r->mime_type = strdup(config->mime_type ? config->mime_type : PARTITION_RESOURCE_DEFAULT_MIME);
+    r->chunk_size = config->chunk_size ? config->chunk_size : PARTITION_RESOURCE_DEFAULT_CHUNK_SIZE;
+    if (!r->mime_type) {
+        partition_resource_destroy(r);
+        return ESP_ERR_NO_MEM;
+    }
+    r->text = content_writer_is_text_type(r->mime_type);
+
+    *res = r;
+    return ESP_OK;
+}
+
+void partition_resource_destroy(partition_resource_t *res) {
+    if (!res) {
+        return;
+    }
+    free(res->mime_type);
+    free(res);
+}
+
+// The part of the range that is currently mapped
+typedef struct {
+    const uint8_t *data;                 // NULL when nothing is mapped
+    size_t start;                        // Offset of data within the range
+    size_t len;
+    esp_partition_mmap_handle_t handle;
+} range_window_t;
+
+// Map the window starting at pos: up to the next window boundary or the end of the range,
+// cut to a multiple of unit bytes unless it is the last one
+static esp_err_t map_window(const partition_resource_t *res, size_t pos, size_t unit, range_window_t *window) {
+    size_t address = res->partition->address + res->offset + pos;
+    size_t remaining = res->size - pos;
+    size_t len = MIN(remaining, PARTITION_RESOURCE_WINDOW_SIZE - address % PARTITION_RESOURCE_WINDOW_SIZE);
+    if (len < unit && len < remaining) {
+        // Too short for one unit: take the next window along as well
+        len = MIN(remaining, len + PARTITION_RESOURCE_WINDOW_SIZE);
+    }
+    if (len < remaining) {
+        len -= len % unit;
+    }
+
+    const void *data;
+    esp_err_t ret = esp_partition_mmap(res->partition, res->offset + pos, len, ESP_PARTITION_MMAP_DATA, &data,
+                                       &window->handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot map %u bytes at %u of partition '%s': %s", (unsigned)len,
+                 (unsigned)(res->offset + pos), res->partition->label, esp_err_to_name(ret));
+        return ret;
+    }
+    window->data = data;
+    window->start = pos;
+    window->len = len;
+    return ESP_OK;
+}
+
+static void unmap_window(range_window_t *window) {
+    if (window->data) {
+        esp_partition_munmap(window->handle);
+        window->data = NULL;
+    }
+}
+
+cJSON* partition_resource_read(const partition_resource_t *res, const char *uri) {
+    // cJSON needs a terminated string, so only this path copies out of flash
+    size_t value_size = res->text ? res->size + 1 : ESP_MCP_BASE64_ENCODED_LEN(res->size) + 1;
+    char *value = MCP_MALLOC(value_size);
+    if (!value) {
+        return NULL;
+    }
+
+    // Whole 3-byte groups per window, so the encoded windows join without padding in between
+    size_t value_len = 0;
+    range_window_t window = { 0 };
+    for (size_t pos = 0; pos < res->size; pos += window.len) {
+        if (map_window(res, pos, res->text ? 1 : 3, &window) != ESP_OK) {
+            MCP_FREE(value);
+            return NULL;
+        }
+        if (res->text) {
+            memcpy(value + value_len, window.data, window.len);
+            value_len += window.len;
+        } else {
+            value_len += esp_mcp_base64_encode(window.data, window.len, value + value_len, value_size - value_len);
+        }
+        unmap_window(&window);
+    }
+    value[value_len] = '\0';
+
+    cJSON *result = cJSON_CreateObject();
+    if (result) {
+        cJSON *contents_array = cJSON_CreateArray();
+        cJSON *content = cJSON_CreateObject();
+
+        cJSON_AddStringToObject(content, "uri", uri);
+        cJSON_AddStringToObject(content, "mimeType", res->mime_type);
+        cJSON_AddStringToObject(content, res->text ? "text" : "blob", value);
+
+        cJSON_AddItemToArray(contents_array, content);
+        cJSON_AddItemToObject(result, "contents", contents_array);
+    }
+    MCP_FREE(value);
+    return result;
+}
+
+// Blob source for the content writer: copies out of one window at a time, mapping the next as it runs out
+typedef struct {
+    const partition_resource_t *res;
+    range_window_t window;
+    size_t pos;                          // Offset of the next byte within the range
+} window_reader_t;
+
+static int read_windows(void *ctx, uint8_t *buf, size_t size) {
+    window_reader_t *reader = (window_reader_t *)ctx;
+    if (reader->pos == reader->res->size) {
+        return 0;
+    }
+    if (reader->pos == reader->window.start + reader->window.len) {
+        unmap_window(&reader->window);
+        if (map_window(reader->res, reader->pos, 1, &reader->window) != ESP_OK) {
+            return -1;
+        }
+    }
+
+    size_t n = MIN(size, reader->window.start + reader->window.len - reader->pos);
+    memcpy(buf, reader->window.data + (reader->pos - reader->window.start), n);
+    reader->pos += n;
+    return (int)n;
+}
+
+esp_err_t partition_resource_stream(const partition_resource_t *res, const char *uri,
+                                    const mcp_transport_stream_t *stream, const cJSON *id, size_t *sent) {
+    *sent = 0;
+    // Map the first window before anything is sent, so a mapping failure can still be answered normally
+    window_reader_t reader = { .res = res };
+    esp_err_t ret = map_window(res, 0, 1, &reader.window);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // The staging buffer is the only RAM the response needs
+    char *buf = MCP_MALLOC(res->chunk_size);
+    if (!buf) {
+        unmap_window(&reader.window);
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_mcp_content_writer_t writer = { 0 };
+    ret = content_writer_begin_contents(&writer, stream, id, buf, res->chunk_size);
+    if (ret == ESP_OK) {
+        if (res->text) {
+            // Escaped straight from each mapped window
+            content_writer_begin_resource_text(&writer, uri, res->mime_type);
+            while (ret == ESP_OK && reader.pos < res->size) {
+                if (!reader.window.data) {
+                    ret = map_window(res, reader.pos, 1, &reader.window);
+                    if (ret != ESP_OK) {
+                        break;
+                    }
+                }
+                ret = esp_mcp_content_append_text(&writer, (const char *)reader.window.data, reader.window.len);
+                reader.pos += reader.window.len;
+                unmap_window(&reader.window);
+            }
+        } else {
+            ret = content_writer_add_resource_blob(&writer, uri, res->mime_type, NULL, 0, read_windows, &reader);
+        }
+        if (ret == ESP_OK) {
+            ret = content_writer_finish(&writer, false);
+        }
+    }
+    *sent = writer.sent;
+
+    MCP_FREE(buf);
+    unmap_window(&reader.window);
+    return ret;
+}
+
+#endif // CONFIG_ESP_MCP_SERVER_PARTITION_RESOURCES
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_mcp_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER
+
+/**
+ * @brief Install cJSON allocation hooks and reset the profile
+ */
+void alloc_profiler_init(void);
+
+/**
+ * @brief Restore default cJSON allocation hooks
+ */
+void alloc_profiler_deinit(void);
+
+/**
+ * @brief Start attributing allocations made by the calling task to a request
+ *
+ * Each dispatching task has a scope of its own, so requests served by several
+ * tasks at once are kept apart. Called by the transport before the request
+ * body is allocated.
+ */
+void alloc_profiler_request_begin(void);
+
+/**
+ * @brief Name the method the calling task's request is charged to
+ *
+ * @param method JSON-RPC method name (copied)
+ */
+void alloc_profiler_request_method(const char *method);
+
+/**
+ * @brief Stop counting a block that the request hands to its caller as live
+ *
+ * @param ptr Block allocated within the request (NULL is ignored)
+ */
+void alloc_profiler_hand_over(const void *ptr);
+
+/**
+ * @brief Finish the calling task's request and charge its counters to its method
+ *
+ * Called by the transport once the response has been sent and freed. Bytes
+ * allocated during the request and still live at this point are reported as
+ * leaked for the method and for the tool it called, if any. A request that
+ * was never named is charged to "(invalid)".
+ */
+void alloc_profiler_request_end(void);
+
+/**
+ * @brief Start attributing allocations to a tool within the current request
+ */
+void alloc_profiler_tool_begin(void);
+
+/**
+ * @brief Finish the current tool scope and charge its counters to a tool
+ *
+ * @param tool Tool name
+ */
+void alloc_profiler_tool_end(const char *tool);
+
+/**
+ * @brief Copy the current profile
+ *
+ * @param entries Output array
+ * @param max_entries Size of the output array
+ * @return Number of entries copied
+ */
+size_t alloc_profiler_snapshot(esp_mcp_alloc_profile_entry_t *entries, size_t max_entries);
+
+/**
+ * @brief Render the current profile as a JSON document
+ *
+ * @return Dynamically allocated string (must be freed by caller), or NULL on error
+ */
+char* alloc_profiler_render_json(void);
+
+// Allocation wrappers for the server's own request-path buffers
+void* alloc_profiler_malloc(size_t size);
+void alloc_profiler_free(void *ptr);
+char* alloc_profiler_strdup(const char *str);
+
+#define MCP_MALLOC(size)    alloc_profiler_malloc(size)
+#define MCP_FREE(ptr)       alloc_profiler_free(ptr)
+#define MCP_STRDUP(str)     alloc_profiler_strdup(str)
+
+#else
+
+#define alloc_profiler_init()                 ((void)0)
+#define alloc_profiler_deinit()               ((void)0)
+#define alloc_profiler_request_begin()        ((void)0)
+#define alloc_profiler_request_method(method) ((void)0)
+#define alloc_profiler_hand_over(ptr)         ((void)0)
+#define alloc_profiler_request_end()          ((void)0)
+#define alloc_profiler_tool_begin()           ((void)0)
+#define alloc_profiler_tool_end(tool)         ((void)0)
+
+#if CONFIG_ESP_MCP_SERVER_STEADY_STATE
+// Request-path buffers come from the serving task's arena
+#include "request_arena.h"
+
+#define MCP_MALLOC(size)    request_arena_malloc(size)
+#define MCP_FREE(ptr)       request_arena_free(ptr)
+#define MCP_STRDUP(str)     request_arena_strdup(str)
+#else
+#define MCP_MALLOC(size)    malloc(size)
+#define MCP_FREE(ptr)       free(ptr)
+#define MCP_STRDUP(str)     strdup(str)
+#endif
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
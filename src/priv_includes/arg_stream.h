@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "base64.h"
+#include "esp_mcp_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Decoded bytes handed to a sink per write
+#define ARG_STREAM_PIECE_SIZE 1024
+
+// Longest key or tool name the splitter keeps to locate the streamed argument
+#define ARG_STREAM_NAME_MAX 64
+
+/**
+ * @brief Called when the value of a tools/call argument starts in the body
+ *
+ * @param arg Argument given to arg_stream_begin()
+ * @param tool Tool name from params.name
+ * @param argument Key of the argument within params.arguments
+ * @param sink Output sink to divert the value to
+ * @param user_data Output argument of the sink callbacks
+ * @param base64 Output, true to base64-decode the value for the sink
+ * @return ESP_ERR_NOT_FOUND to keep the value in the body, ESP_OK to divert
+ *         it, any other error to divert and discard it
+ */
+typedef esp_err_t (*arg_stream_claim_fn_t)(void *arg, const char *tool, const char *argument,
+                                           const esp_mcp_argument_sink_t **sink, void **user_data, bool *base64);
+
+/**
+ * @brief Incremental splitter of a tools/call request body
+ *
+ * The body is scanned as it arrives. Everything is copied to the output
+ * except the value of one streamed argument, which is JSON-unescaped,
+ * optionally base64-decoded and written to its sink ARG_STREAM_PIECE_SIZE
+ * bytes at a time; the output keeps an empty string in its place. The
+ * argument is only recognized when "method" and params.name precede
+ * params.arguments in the body, as clients send them; otherwise the body is
+ * passed through unchanged. The output never grows faster than the input,
+ * so a body can be split in place.
+ */
+typedef struct {
+    char *body;                          // Output
+    size_t len;                          // Output length
+    arg_stream_claim_fn_t claim;
+    void *claim_arg;
+
+    // Lexer
+    uint16_t depth;
+    uint32_t arrays;                     // Bit d - 1 is set when the container at depth d is an array
+    bool expect_key;
+    bool in_string;
+    bool escaped;
+    char *capture;                       // Where the current string is recorded (NULL if nowhere)
+    size_t capture_len;
+    bool capture_overflow;
+
+    // Path to the streamed argument
+    char keys[3][ARG_STREAM_NAME_MAX];   // Current key at depths 1 to 3
+    char method[ARG_STREAM_NAME_MAX];
+    char tool[ARG_STREAM_NAME_MAX];
+
+    // Diverted value
+    bool diverting;                      // Inside the value
+    bool diverted;                       // A value was diverted
+    const esp_mcp_argument_sink_t *sink;
+    void *user_data;
+    bool base64;
+    base64_decoder_t decoder;
+    char escape[12];                     // Escape sequence split across feeds (\uXXXX\uXXXX at most)
+    size_t escape_len;
+    uint8_t piece[ARG_STREAM_PIECE_SIZE];
+    size_t piece_len;
+    esp_err_t error;                     // First error of the claim, the decoder or the sink
+} arg_stream_t;
+
+/**
+ * @brief Start splitting a body
+ *
+ * @param split Splitter to initialize
+ * @param body Output buffer; may be the buffer the input is received into
+ * @param claim Callback deciding whether an argument is diverted
+ * @param arg Argument passed to claim
+ */
+void arg_stream_begin(arg_stream_t *split, char *body, arg_stream_claim_fn_t claim, void *arg);
+
+/**
+ * @brief Split the next piece of the body
+ *
+ * The output is appended at body + split->len; data may start at that same
+ * address, since no byte is written ahead of the input consumed.
+ *
+ * @param split Splitter
+ * @param data Input
+ * @param len Input length
+ */
+void arg_stream_feed(arg_stream_t *split, const char *data, size_t len);
+
+/**
+ * @brief Finish splitting once the whole body was fed
+ *
+ * @param split Splitter
+ * @return ESP_OK if no value was diverted or the diverted value reached its
+ *         sink completely, error code otherwise
+ */
+esp_err_t arg_stream_end(arg_stream_t *split);
+
+/**
+ * @brief Write an already buffered argument value to a sink
+ *
+ * Used when the body was received whole. A base64 value is decoded in place.
+ *
+ * @param sink Sink
+ * @param user_data Argument of the sink callbacks
+ * @param base64 Whether the value is base64
+ * @param value Unescaped value; modified when base64 is set
+ * @param len Length of the value
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the base64 is malformed,
+ *         or the sink's error
+ */
+esp_err_t arg_stream_deliver(const esp_mcp_argument_sink_t *sink, void *user_data, bool base64, char *value, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Encode the whole 3-byte groups of a buffer, without padding
+ *
+ * Works on 32-bit words: 12 input bytes are loaded as three words and stored
+ * as four words of output whenever both pointers are word-aligned, and a byte
+ * at a time otherwise. Every group is loaded before its output is stored, so
+ * the input may sit inside the output buffer as long as it starts at least
+ * len / 3 bytes after dst, which allows encoding in place at the tail of a
+ * buffer.
+ *
+ * @param src Input bytes
+ * @param len Input length; only len - len % 3 bytes are consumed
+ * @param dst Output, receives (len / 3) * 4 characters (not NUL-terminated)
+ * @return Number of characters written
+ */
+size_t base64_encode_blocks(const uint8_t *src, size_t len, char *dst);
+
+/**
+ * @brief Encode the final 1 or 2 bytes of an input with '=' padding
+ *
+ * @param src Remaining input bytes
+ * @param len 1 or 2
+ * @param dst Output, receives 4 characters
+ * @return Number of characters written (4, or 0 if len is 0)
+ */
+size_t base64_encode_tail(const uint8_t *src, size_t len, char *dst);
+
+/**
+ * @brief State of an incremental base64 decode
+ *
+ * Zero-initialize before the first base64_decode_feed().
+ */
+typedef struct {
+    uint32_t bits;             // Pending sextets, most recent in the low bits
+    uint8_t count;             // Number of pending sextets (0-3)
+    bool padded;               // '=' seen; only padding and whitespace may follow
+} base64_decoder_t;
+
+/**
+ * @brief Decode the next piece of a base64 text
+ *
+ * Whitespace (as left by line-wrapped encoders) is skipped and the input may
+ * be split anywhere. Starting from a fresh decoder the output never overtakes
+ * the input, so dst may equal src for in-place decoding of a whole text.
+ *
+ * @param dec Decoder state
+ * @param src Input characters
+ * @param len Input length
+ * @param dst Output, receives at most (len / 4 + 1) * 3 bytes
+ * @return Number of bytes written, or -1 on a character outside the alphabet
+ */
+ssize_t base64_decode_feed(base64_decoder_t *dec, const char *src, size_t len, uint8_t *dst);
+
+/**
+ * @brief Finish a decode, writing the bytes of a final unpadded group
+ *
+ * @param dec Decoder state
+ * @param dst Output, receives at most 2 bytes
+ * @return Number of bytes written, or -1 if the text ended inside a group
+ */
+ssize_t base64_decode_finish(base64_decoder_t *dec, uint8_t *dst);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sorted prefix index over a fixed set of completion candidates
+ *
+ * All candidate strings live in a single arena allocation and are referenced
+ * from a lexicographically sorted pointer array. Every string sharing a prefix
+ * therefore forms one contiguous run, so a lookup only has to locate the run
+ * boundaries and never allocates.
+ */
+typedef struct {
+    char *arena;              // NUL-separated candidate strings
+    const char **sorted;      // Pointers into arena, sorted and de-duplicated
+    size_t count;             // Number of entries in sorted
+} completion_index_t;
+
+/**
+ * @brief Build an index from a list of candidate values
+ *
+ * The values are copied, so the caller's array may be released afterwards.
+ *
+ * @param index Index to initialize
+ * @param values Candidate values
+ * @param count Number of candidate values
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if allocation failed
+ */
+esp_err_t completion_index_build(completion_index_t *index, const char *const *values, size_t count);
+
+/**
+ * @brief Find all candidates starting with a prefix
+ *
+ * @param index Index to search
+ * @param prefix Prefix to match (NULL or "" matches every candidate)
+ * @param first Output index into index->sorted of the first match
+ * @return Number of matching candidates, stored contiguously from *first
+ */
+size_t completion_index_lookup(const completion_index_t *index, const char *prefix, size_t *first);
+
+/**
+ * @brief Release memory owned by an index
+ *
+ * @param index Index to free
+ */
+void completion_index_free(completion_index_t *index);
+
+#ifdef __cplusplus
+}
+#endif
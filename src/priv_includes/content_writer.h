@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "cJSON.h"
+#include "mcp_transport.h"
+#include "esp_mcp_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Smallest staging buffer the writer accepts, so that base64 output always makes progress
+#define CONTENT_WRITER_MIN_SIZE 64
+
+/**
+ * @brief State of a streamed tools/call or resources/read response
+ *
+ * Output is collected in a fixed buffer and sent as one transport chunk
+ * whenever the buffer fills up. The first transport error is latched, after
+ * which every write fails fast so that the tool can stop early.
+ */
+struct esp_mcp_content_writer {
+    const mcp_transport_stream_t *stream;
+    char *buf;
+    size_t size;
+    size_t len;
+    size_t sent;               // Bytes handed to the transport so far
+    size_t item_count;
+    bool in_text;              // A text item is open and accepts appended text
+    bool contents;             // resources/read contents rather than tool result content
+    esp_err_t error;
+};
+
+/**
+ * @brief Start a streamed JSON-RPC result and its content array
+ *
+ * @param writer Writer to initialize
+ * @param stream Transport stream
+ * @param id JSON-RPC request ID
+ * @param buf Staging buffer
+ * @param size Size of the staging buffer
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t content_writer_begin(esp_mcp_content_writer_t *writer, const mcp_transport_stream_t *stream,
+                               const cJSON *id, char *buf, size_t size);
+
+/**
+ * @brief Start a streamed resources/read result and its contents array
+ *
+ * @param writer Writer to initialize
+ * @param stream Transport stream
+ * @param id JSON-RPC request ID
+ * @param buf Staging buffer
+ * @param size Size of the staging buffer
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t content_writer_begin_contents(esp_mcp_content_writer_t *writer, const mcp_transport_stream_t *stream,
+                                        const cJSON *id, char *buf, size_t size);
+
+/**
+ * @brief Start a text entry of a resources/read result
+ *
+ * The text is appended with esp_mcp_content_append_text() and the entry is
+ * closed with esp_mcp_content_end_text().
+ *
+ * @param writer Writer started with content_writer_begin_contents()
+ * @param uri URI of the entry
+ * @param mime_type MIME type of the entry
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t content_writer_begin_resource_text(esp_mcp_content_writer_t *writer, const char *uri, const char *mime_type);
+
+/**
+ * @brief Emit a blob entry of a resources/read result
+ *
+ * The bytes come either from a buffer, encoded straight from where they lie
+ * (e.g. memory-mapped flash), or from a read callback when read is not NULL.
+ *
+ * @param writer Writer started with content_writer_begin_contents()
+ * @param uri URI of the entry
+ * @param mime_type MIME type of the entry
+ * @param data Raw bytes (ignored when read is set)
+ * @param len Length of data
+ * @param read Source of the raw bytes, base64-encoded as they are read (optional)
+ * @param ctx Argument passed to read
+ * @return ESP_OK on success, ESP_FAIL if read failed, error code otherwise
+ */
+esp_err_t content_writer_add_resource_blob(esp_mcp_content_writer_t *writer, const char *uri, const char *mime_type,
+                                           const void *data, size_t len, esp_mcp_content_read_fn_t read, void *ctx);
+
+/**
+ * @brief Whether resource contents of a MIME type are sent as text rather than a base64 blob
+ */
+bool content_writer_is_text_type(const char *mime_type);
+
+/**
+ * @brief Close any open item, finish the result and flush the remaining output
+ *
+ * @param writer Writer
+ * @param is_error Value of the result's isError flag (ignored for resources/read contents)
+ * @return ESP_OK if the whole response was sent, error code otherwise
+ */
+esp_err_t content_writer_finish(esp_mcp_content_writer_t *writer, bool is_error);
+
+#ifdef __cplusplus
+}
+#endif
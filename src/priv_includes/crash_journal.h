@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_ESP_MCP_SERVER_CRASH_JOURNAL
+
+/**
+ * @brief Attach the journal kept from previous boots, or start a new one
+ *
+ * The journal lives in memory that a reset does not clear: RTC_NOINIT memory,
+ * .noinit memory on chips without RTC memory, or a file mapped into memory on
+ * the Linux target. A journal whose header does not check out (first power-on,
+ * layout change) is cleared. Later calls only return.
+ */
+void crash_journal_init(void);
+
+/**
+ * @brief Record that a request is being dispatched
+ *
+ * Only copies the strings into a fixed slot and stamps it; the entry stays
+ * marked in progress until crash_journal_end(), so a request that takes the
+ * device down is left in progress for the next boot to report.
+ *
+ * @param method JSON-RPC method
+ * @param tool Tool name of a tools/call (NULL for other methods)
+ * @param id Request id (NULL for notifications)
+ * @return Sequence number to pass to crash_journal_end(), 0 if the journal is not attached
+ */
+uint32_t crash_journal_begin(const char *method, const char *tool, const cJSON *id);
+
+/**
+ * @brief Record the outcome of a request
+ *
+ * Entries overwritten in the meantime are left alone.
+ *
+ * @param seq Sequence number returned by crash_journal_begin()
+ * @param status HTTP status of the response
+ */
+void crash_journal_end(uint32_t seq, int status);
+
+/**
+ * @brief Render the journal, oldest entry first, as a JSON document
+ *
+ * @return Dynamically allocated string (must be freed by caller), or NULL on error
+ */
+char* crash_journal_render_json(void);
+
+#else
+
+#define crash_journal_init()                      ((void)0)
+#define crash_journal_begin(method, tool, id)     (0)
+#define crash_journal_end(seq, status)            ((void)(seq))
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
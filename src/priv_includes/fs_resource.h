@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "cJSON.h"
+#include "mcp_transport.h"
+#include "esp_mcp_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A VFS directory served under a URI prefix
+ *
+ * Nothing about the directory is cached: every read stats, opens and
+ * enumerates it afresh, so files written at runtime are served as they are.
+ */
+typedef struct fs_resource fs_resource_t;
+
+// Longest VFS path a URI may resolve to, including the base path
+#define FS_RESOURCE_PATH_MAX 256
+
+/**
+ * @brief Create a provider
+ *
+ * @param config Provider configuration (base_path required)
+ * @param fs Output handle
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t fs_resource_create(const esp_mcp_fs_resource_config_t *config, fs_resource_t **fs);
+
+/**
+ * @brief Destroy a provider
+ */
+void fs_resource_destroy(fs_resource_t *fs);
+
+/**
+ * @brief URI prefix the provider serves
+ */
+const char* fs_resource_uri_prefix(const fs_resource_t *fs);
+
+/**
+ * @brief Map a URI to the VFS path it names
+ *
+ * @param fs Provider
+ * @param uri Requested URI
+ * @param path Output buffer of FS_RESOURCE_PATH_MAX bytes
+ * @return true if the URI is under the provider's prefix and resolves to a
+ *         path below its base directory
+ */
+bool fs_resource_resolve(const fs_resource_t *fs, const char *uri, char *path);
+
+/**
+ * @brief MIME type of a file, chosen by extension
+ *
+ * @return MIME type, "application/octet-stream" for unknown extensions
+ */
+const char* fs_resource_mime_type(const char *path);
+
+/**
+ * @brief Read a file or directory into a resources/read result
+ *
+ * @param fs Provider
+ * @param uri Requested URI
+ * @param path Path returned by fs_resource_resolve()
+ * @return Result object, or NULL if the path does not exist or on error
+ */
+cJSON* fs_resource_read(const fs_resource_t *fs, const char *uri, const char *path);
+
+/**
+ * @brief Stream a file or directory as a resources/read response
+ *
+ * @param fs Provider
+ * @param uri Requested URI
+ * @param path Path returned by fs_resource_resolve()
+ * @param stream Transport stream
+ * @param id JSON-RPC request ID
+ * @param sent Output for the number of bytes sent
+ * @return ESP_OK if the whole response was sent, error code otherwise; if *sent
+ *         is 0 nothing reached the client and the request can still be answered
+ *         normally (e.g. with ESP_ERR_NOT_FOUND)
+ */
+esp_err_t fs_resource_stream(const fs_resource_t *fs, const char *uri, const char *path,
+                             const mcp_transport_stream_t *stream, const cJSON *id, size_t *sent);
+
+#ifdef __cplusplus
+}
+#endif
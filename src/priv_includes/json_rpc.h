@@ -2,7 +2,9 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "cJSON.h"
+#include "json_token.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,16 +28,21 @@ typedef enum {
 // JSON-RPC Message Structure
 typedef struct {
     jsonrpc_msg_type_t type;
-    char *jsonrpc;      // Must be "2.0"
-    char *method;       // For requests and notifications
-    cJSON *params;      // Parameters (optional)
-    cJSON *id;          // Request ID (null for notifications)
-    cJSON *result;      // Response result
-    cJSON *error;       // Error object
+    const char *jsonrpc;        // Must be "2.0" (points into the tokenized buffer)
+    const char *method;         // For requests and notifications (points into the tokenized buffer)
+    cJSON *params;              // Built on first use by jsonrpc_get_params()
+    cJSON *id;                  // Request ID (null for notifications)
+    cJSON *result;              // Response result
+    cJSON *error;               // Error object
+
+    // Tokenized message, which params are read from
+    const char *buf;
+    json_token_t *tokens;
+    int params_token;           // -1 if the message has no params
 } jsonrpc_msg_t;
 
 // JSON-RPC Method Handler Function Type
-typedef cJSON* (*jsonrpc_method_handler_t)(const cJSON *params, const cJSON *id, void *user_data);
+typedef cJSON* (*jsonrpc_method_handler_t)(jsonrpc_msg_t *msg, void *user_data);
 
 // JSON-RPC Method Registration Structure
 typedef struct {
@@ -44,13 +51,71 @@ typedef struct {
 } jsonrpc_method_t;
 
 /**
- * @brief Parse JSON-RPC message from string
+ * @brief Parse JSON-RPC message in place
  *
- * @param json_str JSON string to parse
+ * The buffer is tokenized and its strings are decoded in place, so it must
+ * stay valid and unmodified until the message is freed. Only the id (and the
+ * result or error of responses) is converted to cJSON; params are read from
+ * the tokens, or converted on demand with jsonrpc_get_params().
+ *
+ * @param buf Message text, overwritten by the parser
+ * @param len Message length
  * @param msg Output message structure
  * @return true if parsing successful, false otherwise
  */
-bool jsonrpc_parse_message(const char *json_str, jsonrpc_msg_t *msg);
+bool jsonrpc_parse_message(char *buf, size_t len, jsonrpc_msg_t *msg);
+
+/**
+ * @brief Params of a message as cJSON, built on first call
+ *
+ * For handlers that need the whole tree; prefer jsonrpc_get_param_string()
+ * and jsonrpc_build_param() where they suffice.
+ *
+ * @param msg Parsed message
+ * @return Params (owned by the message), or NULL if absent or on allocation failure
+ */
+const cJSON* jsonrpc_get_params(jsonrpc_msg_t *msg);
+
+/**
+ * @brief String member of the params object, read from the tokens
+ *
+ * @param msg Parsed message
+ * @param key Member name
+ * @return NUL-terminated string valid as long as the message, or NULL if absent or not a string
+ */
+const char* jsonrpc_get_param_string(const jsonrpc_msg_t *msg, const char *key);
+
+/**
+ * @brief Build a cJSON tree for one member of the params object
+ *
+ * @param msg Parsed message
+ * @param key Member name
+ * @return New cJSON item (must be freed by caller), or NULL if absent or on allocation failure
+ */
+cJSON* jsonrpc_build_param(const jsonrpc_msg_t *msg, const char *key);
+
+/**
+ * @brief Dispatch a parsed request or notification to its method handler
+ *
+ * @param msg Parsed message
+ * @param methods Array of registered methods
+ * @param method_count Number of registered methods
+ * @param user_data User data passed to method handlers
+ * @return Response JSON string (must be freed by caller, NULL for notifications)
+ */
+char* jsonrpc_dispatch(jsonrpc_msg_t *msg, const jsonrpc_method_t *methods, size_t method_count, void *user_data);
+
+/**
+ * @brief Create the response to a request from a method handler's result
+ *
+ * Results marked with "_jsonrpc_error" become error responses, and a NULL
+ * result an internal error.
+ *
+ * @param id Request ID
+ * @param result Result returned by the method handler (can be NULL)
+ * @return JSON string of response (must be freed by caller)
+ */
+char* jsonrpc_create_result(const cJSON *id, const cJSON *result);
 
 /**
  * @brief Create JSON-RPC response
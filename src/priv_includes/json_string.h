@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Longest escape sequence produced for a single byte (\u00XX)
+#define JSON_STRING_ESCAPE_MAX 6
+
+/**
+ * @brief Find the first byte that cannot appear verbatim inside a JSON string
+ *
+ * Scans a machine word at a time for quotes, backslashes and control
+ * characters, so long clean runs of text cost one load and a few ALU
+ * operations per word. Bytes of multi-byte UTF-8 sequences are clean.
+ *
+ * @param str Input (need not be NUL-terminated)
+ * @param len Input length
+ * @return Offset of the first special byte, or len if there is none
+ */
+size_t json_string_scan(const char *str, size_t len);
+
+/**
+ * @brief Write the escape sequence of a special byte
+ *
+ * @param c Byte reported by json_string_scan()
+ * @param out Output of at least JSON_STRING_ESCAPE_MAX bytes
+ * @return Length of the escape sequence
+ */
+size_t json_string_escape_char(unsigned char c, char *out);
+
+/**
+ * @brief Length of a string once escaped, excluding the quotes
+ *
+ * @param str Input
+ * @param len Input length
+ * @return Escaped length
+ */
+size_t json_string_escaped_len(const char *str, size_t len);
+
+/**
+ * @brief Decode the body of a JSON string literal
+ *
+ * Runs between escapes are located with json_string_scan() and moved with
+ * memmove, so @p out may equal @p in for in-place decoding. \\u escapes,
+ * including surrogate pairs, are converted to UTF-8.
+ *
+ * @param in Body of the literal, without the quotes
+ * @param len Body length
+ * @param out Output of at least len bytes
+ * @return Decoded length, or -1 if the literal is malformed
+ */
+ssize_t json_string_unescape(const char *in, size_t len, char *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum nesting of objects and arrays accepted by json_tokenize()
+#define JSON_TOKEN_MAX_DEPTH 32
+
+// json_tokenize() errors
+#define JSON_TOKENIZE_INVALID    (-1)
+#define JSON_TOKENIZE_NO_TOKENS  (-2)
+
+typedef enum {
+    JSON_TOKEN_OBJECT,
+    JSON_TOKEN_ARRAY,
+    JSON_TOKEN_STRING,
+    JSON_TOKEN_PRIMITIVE,          // Number, true, false or null
+} json_token_type_t;
+
+/**
+ * @brief One JSON value, located in the tokenized buffer
+ *
+ * Tokens are stored in document order. An object is followed by its members
+ * as key/value pairs and an array by its elements; `end` skips a whole
+ * subtree. Strings are decoded in place and NUL-terminated, so the text of a
+ * string token can be used directly as a C string.
+ */
+typedef struct {
+    uint8_t type;                  // json_token_type_t
+    uint32_t start;                // Offset of the value (of the decoded text for strings)
+    uint32_t len;                  // Decoded length for strings, source length otherwise
+    uint32_t size;                 // Members of an object or elements of an array
+    uint32_t end;                  // Index of the first token after this subtree
+} json_token_t;
+
+/**
+ * @brief Tokenize a JSON document in place
+ *
+ * With @p tokens set to NULL the document is only validated structurally and
+ * the tokens it needs are counted; the buffer is left untouched. Otherwise
+ * strings are unescaped in place, which overwrites the buffer.
+ *
+ * @param buf Document (need not be NUL-terminated)
+ * @param len Document length
+ * @param tokens Caller-provided token array, or NULL to count
+ * @param max_tokens Size of the token array
+ * @return Number of tokens, JSON_TOKENIZE_INVALID for malformed input, or
+ *         JSON_TOKENIZE_NO_TOKENS if the array is too small
+ */
+int json_tokenize(char *buf, size_t len, json_token_t *tokens, size_t max_tokens);
+
+/**
+ * @brief Find the value of an object member
+ *
+ * @param buf Tokenized buffer
+ * @param tokens Token array
+ * @param object Index of the object token
+ * @param key Member name
+ * @return Index of the member's value, or -1 if the object has no such member
+ */
+int json_token_find(const char *buf, const json_token_t *tokens, int object, const char *key);
+
+/**
+ * @brief Text of a string token (NUL-terminated), or NULL for other tokens
+ */
+static inline const char* json_token_string(const char *buf, const json_token_t *tokens, int index) {
+    return index >= 0 && tokens[index].type == JSON_TOKEN_STRING ? buf + tokens[index].start : NULL;
+}
+
+/**
+ * @brief Build a cJSON tree for a token and its subtree
+ *
+ * For code that needs cJSON, such as tool handlers; everything else should
+ * read the tokens directly.
+ *
+ * @param buf Tokenized buffer
+ * @param tokens Token array
+ * @param index Index of the token
+ * @return New cJSON item (must be freed by caller), or NULL on allocation failure
+ */
+cJSON* json_token_to_cjson(const char *buf, const json_token_t *tokens, int index);
+
+#ifdef __cplusplus
+}
+#endif
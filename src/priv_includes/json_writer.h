@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Compact JSON serializer
+ *
+ * Output is rendered twice by the same code: once with a NULL buffer to
+ * measure it, then into a single allocation of the exact size. Strings are
+ * escaped with json_string_scan(), so clean runs are copied with memcpy.
+ */
+typedef struct {
+    char *buf;                 // NULL while measuring
+    size_t len;
+    bool failed;               // Set on values that cannot be serialized
+} json_writer_t;
+
+/**
+ * @brief Callback that emits one document through the json_writer_* functions
+ */
+typedef void (*json_writer_render_fn_t)(json_writer_t *writer, const void *arg);
+
+/**
+ * @brief Append raw, already valid JSON text
+ */
+void json_writer_raw(json_writer_t *writer, const char *data, size_t len);
+
+// Append a string literal of raw JSON text
+#define json_writer_literal(writer, literal) json_writer_raw((writer), (literal), sizeof(literal) - 1)
+
+/**
+ * @brief Append a quoted, escaped string
+ */
+void json_writer_string(json_writer_t *writer, const char *str, size_t len);
+
+/**
+ * @brief Append a cJSON value without whitespace (NULL is written as null)
+ */
+void json_writer_value(json_writer_t *writer, const cJSON *item);
+
+/**
+ * @brief Measure and render a document into a single allocation
+ *
+ * @param render Callback emitting the document
+ * @param arg Argument passed to the callback
+ * @return NUL-terminated string (must be freed with cJSON_free), or NULL on error
+ */
+char* json_writer_render(json_writer_render_fn_t render, const void *arg);
+
+/**
+ * @brief Serialize a cJSON value without whitespace
+ *
+ * Drop-in replacement for cJSON_PrintUnformatted().
+ *
+ * @param item Value to serialize
+ * @return NUL-terminated string (must be freed with cJSON_free), or NULL on error
+ */
+char* json_writer_print(const cJSON *item);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "sdkconfig.h"
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief URI prefix of the log tail resource; the rest of the URI is the read offset
+ */
+#define LOG_TAIL_URI_PREFIX "esp32://system/log/"
+
+#if CONFIG_ESP_MCP_SERVER_LOG_TAIL
+
+/**
+ * @brief Start copying log output into the log tail ring buffer
+ *
+ * Installs a hook with esp_log_set_vprintf() that passes every message on to
+ * the previous output function and appends it to the ring. The hook stays
+ * installed for the lifetime of the process. Later calls only return.
+ */
+void log_tail_init(void);
+
+/**
+ * @brief Read the log output written since an offset
+ *
+ * Offsets count the bytes written since log_tail_init(). A read returns the
+ * bytes from the offset up to the current end, along with the offset to pass
+ * to the next read. When the ring has already overwritten the offset, the read
+ * starts at the first complete line still held and reports how many bytes
+ * were skipped; an offset past the end (the device restarted since the
+ * client's last read) starts at the oldest line.
+ *
+ * @param uri Resource URI, LOG_TAIL_URI_PREFIX followed by a decimal offset
+ *            (an empty offset reads from the oldest line)
+ * @return resources/read result, or NULL if the URI is not a log tail URI or on allocation failure
+ */
+cJSON* log_tail_read(const char *uri);
+
+#else
+
+#define log_tail_init() ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_mcp_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Bearer-token authenticator with a cache of verified tokens
+ *
+ * Only SHA-256 digests of verified tokens are kept, together with the time
+ * until which the verifier allowed them to be trusted. A cached token is
+ * accepted with one hash and a table scan instead of a full verification.
+ */
+typedef struct mcp_auth mcp_auth_t;
+
+/**
+ * @brief Outcome of a check that must not call the verifier
+ */
+typedef enum {
+    MCP_AUTH_ACCEPTED,                   // Token found in the cache
+    MCP_AUTH_REJECTED,                   // Header missing or not a bearer token
+    MCP_AUTH_UNVERIFIED,                 // Well-formed token that only the verifier can decide
+} mcp_auth_result_t;
+
+/**
+ * @brief Create an authenticator
+ *
+ * @param verifier Token verifier called on cache misses
+ * @param user_data User data passed to the verifier
+ * @param cache_entries Number of verified tokens to remember (0 disables caching)
+ * @param auth Output authenticator
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t mcp_auth_create(esp_mcp_auth_verifier_t verifier, void *user_data, size_t cache_entries, mcp_auth_t **auth);
+
+/**
+ * @brief Destroy an authenticator
+ *
+ * @param auth Authenticator (NULL is ignored)
+ */
+void mcp_auth_destroy(mcp_auth_t *auth);
+
+/**
+ * @brief Check the value of an Authorization header
+ *
+ * @param auth Authenticator
+ * @param header Header value, not necessarily NUL-terminated (NULL if absent)
+ * @param len Length of the header value
+ * @return true if the header carries a valid bearer token
+ */
+bool mcp_auth_check_header(mcp_auth_t *auth, const char *header, size_t len);
+
+/**
+ * @brief Check the value of an Authorization header against the cache only
+ *
+ * Never calls the verifier, so it is cheap enough for a task that must not
+ * block. An MCP_AUTH_UNVERIFIED header is settled with mcp_auth_check_header().
+ *
+ * @param auth Authenticator
+ * @param header Header value, not necessarily NUL-terminated (NULL if absent)
+ * @param len Length of the header value
+ * @return MCP_AUTH_ACCEPTED on a cache hit, MCP_AUTH_REJECTED for a malformed
+ *         or missing header, MCP_AUTH_UNVERIFIED otherwise
+ */
+mcp_auth_result_t mcp_auth_check_cached(mcp_auth_t *auth, const char *header, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
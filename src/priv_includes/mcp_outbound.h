@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "cJSON.h"
+#include "esp_mcp_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Table of server-initiated requests awaiting a client response
+ *
+ * Entries are keyed by the numeric JSON-RPC id assigned when the request is
+ * sent, and bound to the session (event stream socket) it was sent on. A
+ * response completes its entry only if it carries the same session; it does
+ * so from whichever task received it. A periodic esp_timer, running only
+ * while requests are pending, expires the rest. Completion callbacks are
+ * invoked without any lock held.
+ */
+typedef struct mcp_outbound mcp_outbound_t;
+
+/**
+ * @brief Transmit one serialized JSON-RPC request to the client
+ */
+typedef esp_err_t (*mcp_outbound_send_fn_t)(const char *message, size_t len, void *arg);
+
+/**
+ * @brief Create a pending-request table
+ *
+ * @param max_pending Maximum number of requests awaiting a response
+ * @param outbound Output handle
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t mcp_outbound_create(size_t max_pending, mcp_outbound_t **outbound);
+
+/**
+ * @brief Destroy the table, failing pending requests with ESP_ERR_INVALID_STATE
+ *
+ * @param outbound Handle (NULL is ignored)
+ */
+void mcp_outbound_destroy(mcp_outbound_t *outbound);
+
+/**
+ * @brief Send a request and register its completion callback
+ *
+ * @param outbound Handle
+ * @param session Session the request is sent on; only responses from it complete the request
+ * @param method Method name
+ * @param params Parameters (can be NULL)
+ * @param timeout_ms Time to wait for the response
+ * @param callback Completion callback
+ * @param user_data User data passed to the callback
+ * @param send Transmit function
+ * @param send_arg Argument passed to the transmit function
+ * @return ESP_OK once the request was sent, ESP_ERR_NO_MEM if the table is full,
+ *         or the error returned by the transmit function (the callback is then not called)
+ */
+esp_err_t mcp_outbound_send(mcp_outbound_t *outbound, int session, const char *method, const cJSON *params, uint32_t timeout_ms,
+                            esp_mcp_response_cb_t callback, void *user_data,
+                            mcp_outbound_send_fn_t send, void *send_arg);
+
+/**
+ * @brief Route a client response to its pending request
+ *
+ * @param outbound Handle
+ * @param session Session the response arrived from
+ * @param id Response id
+ * @param result Result member of the response (NULL for errors)
+ * @param error Error member of the response (NULL on success)
+ * @return true if the response matched a pending request of the same session
+ */
+bool mcp_outbound_complete(mcp_outbound_t *outbound, int session, const cJSON *id, const cJSON *result,
+                           const cJSON *error);
+
+/**
+ * @brief Fail the pending requests of one session, e.g. when its stream is replaced or lost
+ *
+ * @param outbound Handle
+ * @param session Session whose requests can no longer be answered
+ * @param reason Status passed to the callbacks
+ */
+void mcp_outbound_fail_session(mcp_outbound_t *outbound, int session, esp_err_t reason);
+
+/**
+ * @brief Fail every pending request, e.g. when the client stream is lost
+ *
+ * @param outbound Handle
+ * @param reason Status passed to the callbacks
+ */
+void mcp_outbound_fail_all(mcp_outbound_t *outbound, esp_err_t reason);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Outcome of processing one /mcp request body
+ */
+typedef struct {
+    int status;                // HTTP status code (200 on success)
+    char *body;                // JSON response, NULL for notifications (free with cJSON_free)
+    const char *error;         // Static error text when status != 200
+    bool streamed;             // Response was already sent through the stream; the transport
+                               // terminates it if status is 200 and drops the connection otherwise
+    size_t streamed_len;       // Body bytes sent through the stream
+} mcp_transport_response_t;
+
+/**
+ * @brief Chunked response channel offered by a transport to the dispatcher
+ *
+ * The first chunk sends a 200 response header with chunked transfer encoding,
+ * so it must only be written once the response is known to succeed.
+ */
+typedef struct {
+    esp_err_t (*send_chunk)(void *ctx, const char *data, size_t len); // Send one non-empty chunk
+    void *ctx;
+    int sockfd;                                                      // Client socket, -1 if there is none
+} mcp_transport_stream_t;
+
+/**
+ * @brief Transport-independent request dispatch callback
+ *
+ * @param body NUL-terminated request body (may be modified in place)
+ * @param len Body length in bytes
+ * @param arg User argument given to the transport
+ * @param stream Channel for responses that are streamed instead of returned in resp->body
+ * @param resp Output response
+ */
+typedef void (*mcp_transport_dispatch_fn_t)(char *body, size_t len, void *arg,
+                                            const mcp_transport_stream_t *stream,
+                                            mcp_transport_response_t *resp);
+
+/**
+ * @brief Request completion callback, run once the response has been sent and freed
+ *
+ * @param arg User argument given to the transport
+ */
+typedef void (*mcp_transport_complete_fn_t)(void *arg);
+
+/**
+ * @brief Request authorization callback, run once the request headers are known
+ *
+ * @param authorization Authorization header value, not NUL-terminated (NULL if absent)
+ * @param len Length of the header value
+ * @param arg User argument given to the transport
+ * @return true to accept the request, false to answer 401 without reading the body
+ */
+typedef bool (*mcp_transport_authorize_fn_t)(const char *authorization, size_t len, void *arg);
+
+/**
+ * @brief Outcome of an authorization pre-check
+ */
+typedef enum {
+    MCP_TRANSPORT_AUTH_ACCEPT,
+    MCP_TRANSPORT_AUTH_REJECT,
+    MCP_TRANSPORT_AUTH_VERIFY,           // Undecided; the authorize callback must run
+} mcp_transport_auth_t;
+
+/**
+ * @brief Authorization pre-check that must decide without blocking
+ *
+ * @param authorization Authorization header value, not NUL-terminated (NULL if absent)
+ * @param len Length of the header value
+ * @param arg User argument given to the transport
+ * @return Decision, or MCP_TRANSPORT_AUTH_VERIFY to defer to the authorize callback
+ */
+typedef mcp_transport_auth_t (*mcp_transport_precheck_fn_t)(const char *authorization, size_t len, void *arg);
+
+/**
+ * @brief Lightweight select()-based HTTP/1.1 transport configuration
+ */
+typedef struct {
+    uint16_t port;                       // Listening port
+    uint16_t max_connections;            // Maximum open client sockets
+    uint8_t worker_count;                // Number of dispatch worker tasks
+    size_t max_body_size;                // Largest accepted request body
+    uint32_t listener_stack_size;        // Stack size of the listener task
+    uint32_t worker_stack_size;          // Stack size of each worker task, which runs dispatch
+    unsigned task_priority;              // Priority of listener and worker tasks
+    bool reserve_buffers;                // Allocate every connection's buffer at start and keep it
+    mcp_transport_dispatch_fn_t dispatch;
+    mcp_transport_complete_fn_t complete;   // Optional, runs in the worker after each dispatch
+    mcp_transport_authorize_fn_t authorize; // Optional, runs in a worker before the body is read
+    mcp_transport_precheck_fn_t precheck;   // Optional, runs in the listener task ahead of authorize
+    void *arg;
+} mcp_lite_transport_config_t;
+
+typedef struct mcp_lite_transport mcp_lite_transport_t;
+
+/**
+ * @brief Start the lightweight transport
+ *
+ * One listener task multiplexes all sockets with select() and scans request
+ * headers in place; complete requests are handed to a pool of worker tasks
+ * that run the dispatch callback and write the response.
+ *
+ * @param config Transport configuration
+ * @param transport Output transport handle
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t mcp_lite_transport_start(const mcp_lite_transport_config_t *config, mcp_lite_transport_t **transport);
+
+/**
+ * @brief Stop the transport, close all sockets and free its resources
+ *
+ * @param transport Transport handle (NULL is ignored)
+ */
+void mcp_lite_transport_stop(mcp_lite_transport_t *transport);
+
+/**
+ * @brief Get the number of open client connections
+ *
+ * @param transport Transport handle
+ * @return Number of open client sockets
+ */
+uint16_t mcp_lite_transport_open_connections(mcp_lite_transport_t *transport);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stddef.h>
+#include "esp_err.h"
+#include "cJSON.h"
+#include "mcp_transport.h"
+#include "esp_mcp_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A range of a flash partition served as one resource
+ *
+ * Only the partition and the bounds of the range are kept; a read maps the
+ * range into the data address space one window at a time and unmaps each
+ * window before mapping the next, so an idle resource holds no MMU pages.
+ */
+typedef struct partition_resource partition_resource_t;
+
+/**
+ * @brief Look up the partition and check the range
+ *
+ * @param config Resource configuration (partition_label required)
+ * @param res Output handle
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no partition has the label,
+ *         ESP_ERR_INVALID_SIZE if the range does not fit in it, error code otherwise
+ */
+esp_err_t partition_resource_create(const esp_mcp_partition_resource_config_t *config, partition_resource_t **res);
+
+/**
+ * @brief Destroy a resource
+ */
+void partition_resource_destroy(partition_resource_t *res);
+
+/**
+ * @brief Read the range into a resources/read result
+ *
+ * @param res Resource
+ * @param uri Requested URI
+ * @return Result object, or NULL if the range cannot be mapped or on error
+ */
+cJSON* partition_resource_read(const partition_resource_t *res, const char *uri);
+
+/**
+ * @brief Stream the range as a resources/read response from the mapped flash windows
+ *
+ * @param res Resource
+ * @param uri Requested URI
+ * @param stream Transport stream
+ * @param id JSON-RPC request ID
+ * @param sent Output for the number of bytes sent
+ * @return ESP_OK if the whole response was sent, error code otherwise; if *sent
+ *         is 0 nothing reached the client and the request can still be answered
+ *         normally
+ */
+esp_err_t partition_resource_stream(const partition_resource_t *res, const char *uri,
+                                    const mcp_transport_stream_t *stream, const cJSON *id, size_t *sent);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_ESP_MCP_SERVER_STEADY_STATE
+
+/**
+ * @brief Per-task bump allocators for the request path
+ *
+ * A fixed pool of arenas is reserved when the server starts, one for each
+ * task that dispatches requests. Each request resets the arena of the task
+ * serving it, so everything the request allocates through MCP_MALLOC or cJSON
+ * (receive buffer, tokens, cJSON trees, response) comes out of memory that
+ * was reserved up front, and frees are no-ops. Tasks without an arena, and
+ * requests that outgrow theirs, fall back to the heap; the latter are counted
+ * so that a configuration that is not allocation-free shows up in the stats.
+ */
+
+/**
+ * @brief Reserve the arenas and route cJSON allocations through them
+ *
+ * @param count Number of arenas (tasks dispatching requests concurrently)
+ * @param size Size of each arena in bytes
+ * @return ESP_OK, ESP_ERR_NO_MEM, or ESP_ERR_INVALID_STATE if already reserved
+ */
+esp_err_t request_arena_init(size_t count, size_t size);
+
+/**
+ * @brief Restore the default cJSON hooks and release the arenas
+ *
+ * Nothing allocated from an arena may be used or freed afterwards.
+ */
+void request_arena_deinit(void);
+
+/**
+ * @brief Start a request on the calling task, resetting its arena
+ *
+ * The first call from a task binds a free arena to it for good. Memory from
+ * the task's previous request is reused, so its response must have been sent.
+ * If no arena is left for the task, its requests use the heap and the miss is
+ * counted as an overflow.
+ */
+void request_arena_begin(void);
+
+/**
+ * @brief Request-path allocations that were served by the heap
+ */
+uint32_t request_arena_overflows(void);
+
+/**
+ * @brief Largest number of bytes a single request used from its arena
+ */
+uint32_t request_arena_high_water(void);
+
+// Allocation functions behind MCP_MALLOC and the cJSON hooks
+void* request_arena_malloc(size_t size);
+void request_arena_free(void *ptr);
+char* request_arena_strdup(const char *str);
+
+#else
+
+#define request_arena_begin()        do { } while (0)
+#define request_arena_overflows()    (0)
+#define request_arena_high_water()   (0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
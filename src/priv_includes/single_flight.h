@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief In-flight deduplication of identical concurrent calls
+ *
+ * The first caller with a given key runs the work and becomes the leader of
+ * that flight; callers arriving with the same key while it runs block until
+ * it finishes and receive the same result instead of running the work again.
+ * The leader keeps ownership of the result and, in single_flight_done(), waits
+ * for every follower to finish with it before freeing it, so the result may
+ * live in any allocator, including a request arena. All slots and semaphores
+ * are created up front; nothing is allocated per call.
+ */
+typedef struct single_flight single_flight_t;
+
+/**
+ * @brief One caller's participation in a flight, released with single_flight_done()
+ */
+typedef struct single_flight_call single_flight_call_t;
+
+/**
+ * @brief Work run by the leader of a flight
+ *
+ * @param arg Argument passed to single_flight_do()
+ * @return Result shared with the followers (may be NULL)
+ */
+typedef void* (*single_flight_fn_t)(void *arg);
+
+/**
+ * @brief Create a flight table
+ *
+ * @param max_flights Maximum number of distinct keys in flight at once
+ * @param sf Output handle
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t single_flight_create(size_t max_flights, single_flight_t **sf);
+
+/**
+ * @brief Destroy the table; no call may be in flight
+ */
+void single_flight_destroy(single_flight_t *sf);
+
+/**
+ * @brief Run fn, or wait for an identical call already in flight and share its result
+ *
+ * When every slot is busy the work runs without deduplication.
+ *
+ * @param sf Flight table
+ * @param key Identity of the call; must stay valid until single_flight_done()
+ * @param fn Work to run if no identical call is in flight
+ * @param arg Argument passed to fn
+ * @param call Output participation handle, to pass to single_flight_done()
+ * @return Result of fn, from this caller or from the leader
+ */
+void* single_flight_do(single_flight_t *sf, const char *key, single_flight_fn_t fn, void *arg,
+                       single_flight_call_t **call);
+
+/**
+ * @brief Finish with the result of single_flight_do()
+ *
+ * A follower only signals the leader. The leader waits until all of its
+ * followers are done, then frees the slot.
+ *
+ * @param sf Flight table
+ * @param call Handle returned by single_flight_do()
+ * @return true if the caller owns the result and must free it
+ */
+bool single_flight_done(single_flight_t *sf, single_flight_call_t *call);
+
+/**
+ * @brief Read the counters
+ *
+ * @param sf Flight table
+ * @param runs Output for calls that ran their work
+ * @param shared Output for calls that were given another call's result
+ */
+void single_flight_get_counters(const single_flight_t *sf, uint32_t *runs, uint32_t *shared);
+
+#ifdef __cplusplus
+}
+#endif
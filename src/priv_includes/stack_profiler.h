@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_mcp_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_ESP_MCP_SERVER_STACK_PROFILER
+
+/**
+ * @brief Reset the profile
+ */
+void stack_profiler_init(void);
+
+/**
+ * @brief Start measuring the stack used by a request on the calling task
+ *
+ * Repaints the task's unused stack with the FreeRTOS fill pattern, so that
+ * the high-water mark read afterwards reflects this request alone rather than
+ * the deepest call since the task was created.
+ */
+void stack_profiler_request_begin(void);
+
+/**
+ * @brief Charge the stack high-water mark of the current request to a method
+ *
+ * @param method JSON-RPC method name (NULL if the request did not parse)
+ */
+void stack_profiler_request_end(const char *method);
+
+/**
+ * @brief Charge the stack high-water mark reached so far to a tool
+ *
+ * Called right after the tool handler returns, so the figure covers argument
+ * validation and the handler itself.
+ *
+ * @param tool Tool name
+ */
+void stack_profiler_tool_end(const char *tool);
+
+/**
+ * @brief Least free stack left by any profiled request, in bytes (0 before the first)
+ */
+uint32_t stack_profiler_min_free(void);
+
+/**
+ * @brief Copy the current profile
+ *
+ * @param entries Output array
+ * @param max_entries Size of the output array
+ * @return Number of entries copied
+ */
+size_t stack_profiler_snapshot(esp_mcp_stack_profile_entry_t *entries, size_t max_entries);
+
+/**
+ * @brief Render the current profile as a JSON document
+ *
+ * @return Dynamically allocated string (must be freed by caller), or NULL on error
+ */
+char* stack_profiler_render_json(void);
+
+#else
+
+#define stack_profiler_init()                 ((void)0)
+#define stack_profiler_request_begin()        ((void)0)
+#define stack_profiler_request_end(method)    ((void)0)
+#define stack_profiler_tool_end(tool)         ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Rendered text buffer sizes for the built-in system tool and resource
+#define TELEMETRY_SYSTEM_INFO_LEN    512
+#define TELEMETRY_SYSTEM_STATUS_LEN  1024
+
+/**
+ * @brief Server-side counters captured alongside system metrics
+ */
+typedef struct {
+    uint16_t active_sessions;
+    uint16_t open_sockets;
+    uint32_t total_requests;
+    uint32_t failed_requests;
+} telemetry_server_counters_t;
+
+/**
+ * @brief Callback used to read server counters while sampling
+ *
+ * @param counters Output counters
+ * @param arg User argument given to the sampler
+ */
+typedef void (*telemetry_counters_fn_t)(telemetry_server_counters_t *counters, void *arg);
+
+/**
+ * @brief Pre-rendered views of a telemetry sample
+ */
+typedef enum {
+    TELEMETRY_VIEW_SYSTEM_INFO,      // Text of the get_system_info tool
+    TELEMETRY_VIEW_SYSTEM_STATUS,    // Text of the esp32://system/status resource
+} telemetry_view_t;
+
+typedef struct telemetry_sampler telemetry_sampler_t;
+
+/**
+ * @brief Start a low-priority task that periodically samples and renders telemetry
+ *
+ * Each sample is rendered into the back half of a double buffer, which is then
+ * swapped in, so readers only ever copy an already formatted snapshot.
+ *
+ * @param interval_ms Sampling interval in milliseconds (must be > 0)
+ * @param stack_size Stack size of the sampler task, 0 for the default
+ * @param counters_fn Callback reading server counters (optional)
+ * @param arg Argument passed to counters_fn
+ * @param sampler Output sampler handle
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t telemetry_sampler_start(uint32_t interval_ms, uint32_t stack_size,
+                                  telemetry_counters_fn_t counters_fn, void *arg,
+                                  telemetry_sampler_t **sampler);
+
+/**
+ * @brief Stop the sampler task and free its buffers
+ *
+ * @param sampler Sampler handle (NULL is ignored)
+ */
+void telemetry_sampler_stop(telemetry_sampler_t *sampler);
+
+/**
+ * @brief Copy the latest rendered snapshot of a view
+ *
+ * @param sampler Sampler handle
+ * @param view View to copy
+ * @param buf Output buffer
+ * @param buf_len Output buffer size
+ * @return Number of bytes copied excluding the terminator, 0 if no sample is available yet
+ */
+size_t telemetry_sampler_copy(telemetry_sampler_t *sampler, telemetry_view_t view, char *buf, size_t buf_len);
+
+/**
+ * @brief Sample and render a view synchronously (used when no sampler is running)
+ *
+ * @param view View to render
+ * @param counters_fn Callback reading server counters (optional)
+ * @param arg Argument passed to counters_fn
+ * @param buf Output buffer
+ * @param buf_len Output buffer size
+ * @return Number of bytes written excluding the terminator
+ */
+size_t telemetry_render_now(telemetry_view_t view, telemetry_counters_fn_t counters_fn, void *arg,
+                            char *buf, size_t buf_len);
+
+#ifdef __cplusplus
+}
+#endif
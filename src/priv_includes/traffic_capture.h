@@ -0,0 +1,125 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_mcp_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Text format written by traffic_capture_export()
+ *
+ * A header line followed by one record per request. Each record is a line
+ * "<offset_us> <duration_us> <status> <response_len> <original_len> <body_len>"
+ * followed by body_len bytes of request body and a newline. Offsets are
+ * relative to the oldest exported record.
+ */
+#define TRAFFIC_CAPTURE_HEADER "# esp-mcp-server capture v1\n"
+
+#if CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+
+typedef struct traffic_capture traffic_capture_t;
+
+/**
+ * @brief Create a capture ring buffer
+ *
+ * @param size Size of the ring buffer in bytes
+ * @param capture Output capture handle
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t traffic_capture_create(size_t size, traffic_capture_t **capture);
+
+/**
+ * @brief Destroy a capture ring buffer
+ *
+ * @param capture Capture handle (NULL is ignored)
+ */
+void traffic_capture_destroy(traffic_capture_t *capture);
+
+/**
+ * @brief Record a request body before it is processed
+ *
+ * The body is copied at once, since request processing may modify it. The
+ * oldest records are discarded to make room.
+ *
+ * @param capture Capture handle
+ * @param body Request body
+ * @param len Body length in bytes
+ * @return Sequence number to pass to traffic_capture_end()
+ */
+uint32_t traffic_capture_begin(traffic_capture_t *capture, const char *body, size_t len);
+
+/**
+ * @brief Complete a record with the outcome of the request
+ *
+ * Records evicted in the meantime are ignored.
+ *
+ * @param capture Capture handle
+ * @param seq Sequence number returned by traffic_capture_begin()
+ * @param duration_us Processing time
+ * @param status HTTP status of the response
+ * @param response_len Size of the response body
+ */
+void traffic_capture_end(traffic_capture_t *capture, uint32_t seq, uint32_t duration_us, int status, size_t response_len);
+
+/**
+ * @brief Output callback of traffic_capture_export()
+ */
+typedef esp_err_t (*traffic_capture_write_fn_t)(const char *data, size_t len, void *arg);
+
+/**
+ * @brief Write all completed records in the capture text format
+ *
+ * Recording is blocked while the export runs.
+ *
+ * @param capture Capture handle
+ * @param write Output callback
+ * @param arg Argument passed to the output callback
+ * @return ESP_OK on success, the first error returned by the callback otherwise
+ */
+esp_err_t traffic_capture_export(traffic_capture_t *capture, traffic_capture_write_fn_t write, void *arg);
+
+/**
+ * @brief Render the capture text format into a single string
+ *
+ * @param capture Capture handle
+ * @return Allocated string (free with MCP_FREE), or NULL on error
+ */
+char* traffic_capture_render(traffic_capture_t *capture);
+
+#endif // CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+
+/**
+ * @brief Request processing callback used by traffic_capture_replay()
+ *
+ * @param body NUL-terminated request body (may be modified in place)
+ * @param len Body length in bytes
+ * @param arg User argument
+ * @param status Output HTTP status of the response
+ * @param response_len Output size of the response body
+ */
+typedef void (*traffic_replay_fn_t)(char *body, size_t len, void *arg, int *status, size_t *response_len);
+
+/**
+ * @brief Feed a capture file through a request processing callback
+ *
+ * @param fp Capture file opened for reading
+ * @param realtime true to keep the captured inter-arrival timing, false to replay as fast as possible
+ * @param replay Request processing callback
+ * @param arg Argument passed to the callback
+ * @param stats Output replay statistics
+ * @return ESP_OK on success, ESP_ERR_INVALID_RESPONSE if the file is not a capture,
+ *         ESP_ERR_NO_MEM on allocation failure
+ */
+esp_err_t traffic_capture_replay(FILE *fp, bool realtime, traffic_replay_fn_t replay, void *arg,
+                                 esp_mcp_replay_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
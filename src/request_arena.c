@@ -0,0 +1,167 @@
+/**
+ * @file request_arena.c
+ * @brief Per-task request arenas for allocation-free steady-state operation
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_ESP_MCP_SERVER_STEADY_STATE
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "request_arena.h"
+
+static const char *TAG = "MCP_ARENA";
+
+// Allocation granularity, enough for any type cJSON or the server stores
+#define ARENA_ALIGN 8
+
+typedef struct {
+    TaskHandle_t owner;                  // Task bound to this arena, NULL while unused
+    char *base;
+    size_t used;
+} request_arena_t;
+
+static struct {
+    portMUX_TYPE lock;
+    request_arena_t *arenas;
+    size_t count;
+    size_t size;                         // Bytes per arena
+    char *memory;                        // Backing store of all arenas, contiguous
+    uint32_t overflows;
+    uint32_t high_water;
+} s_arena = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+// Arenas are only ever bound by their own task, so lookups need no lock
+static request_arena_t* current_arena(void) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (size_t i = 0; i < s_arena.count; i++) {
+        if (s_arena.arenas[i].owner == self) {
+            return &s_arena.arenas[i];
+        }
+    }
+    return NULL;
+}
+
+static void count_overflow(void) {
+    portENTER_CRITICAL(&s_arena.lock);
+    s_arena.overflows++;
+    portEXIT_CRITICAL(&s_arena.lock);
+}
+
+void* request_arena_malloc(size_t size) {
+    request_arena_t *arena = current_arena();
+    if (arena) {
+        size_t aligned = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+        if (aligned <= s_arena.size - arena->used) {
+            void *ptr = arena->base + arena->used;
+            arena->used += aligned;
+            if (arena->used > s_arena.high_water) {
+                s_arena.high_water = arena->used;
+            }
+            return ptr;
+        }
+        count_overflow();
+    }
+    return malloc(size);
+}
+
+void request_arena_free(void *ptr) {
+    // Arena memory is reclaimed as a whole when its task starts the next request
+    if ((char *)ptr >= s_arena.memory && (char *)ptr < s_arena.memory + s_arena.count * s_arena.size) {
+        return;
+    }
+    free(ptr);
+}
+
+char* request_arena_strdup(const char *str) {
+    size_t len = strlen(str) + 1;
+    char *copy = request_arena_malloc(len);
+    if (copy) {
+        memcpy(copy, str, len);
+    }
+    return copy;
+}
+
+esp_err_t request_arena_init(size_t count, size_t size) {
+    if (s_arena.memory) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    request_arena_t *arenas = calloc(count, sizeof(request_arena_t));
+    char *memory = malloc(count * size);
+    if (!arenas || !memory) {
+        free(arenas);
+        free(memory);
+        return ESP_ERR_NO_MEM;
+    }
+    for (size_t i = 0; i < count; i++) {
+        arenas[i].base = memory + i * size;
+    }
+
+    s_arena.arenas = arenas;
+    s_arena.memory = memory;
+    s_arena.size = size;
+    s_arena.overflows = 0;
+    s_arena.high_water = 0;
+    s_arena.count = count;
+
+    cJSON_Hooks hooks = {
+        .malloc_fn = request_arena_malloc,
+        .free_fn = request_arena_free,
+    };
+    cJSON_InitHooks(&hooks);
+    ESP_LOGI(TAG, "Reserved %u request arenas of %u bytes", (unsigned)count, (unsigned)size);
+    return ESP_OK;
+}
+
+void request_arena_deinit(void) {
+    if (!s_arena.memory) {
+        return;
+    }
+
+    cJSON_InitHooks(NULL);
+    s_arena.count = 0;
+    free(s_arena.arenas);
+    free(s_arena.memory);
+    s_arena.arenas = NULL;
+    s_arena.memory = NULL;
+}
+
+void request_arena_begin(void) {
+    if (!s_arena.memory) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_arena.lock);
+    request_arena_t *arena = current_arena();
+    for (size_t i = 0; !arena && i < s_arena.count; i++) {
+        if (!s_arena.arenas[i].owner) {
+            arena = &s_arena.arenas[i];
+            arena->owner = xTaskGetCurrentTaskHandle();
+        }
+    }
+    if (arena) {
+        arena->used = 0;
+    } else {
+        s_arena.overflows++;
+    }
+    portEXIT_CRITICAL(&s_arena.lock);
+}
+
+uint32_t request_arena_overflows(void) {
+    return s_arena.overflows;
+}
+
+uint32_t request_arena_high_water(void) {
+    return s_arena.high_water;
+}
+
+#endif // CONFIG_ESP_MCP_SERVER_STEADY_STATE
@@ -0,0 +1,193 @@
+/**
+ * @file single_flight.c
+ * @brief Deduplication of identical concurrent resource reads and tool calls
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "single_flight.h"
+
+struct single_flight_call {
+    const char *key;                     // NULL marks a free slot
+    uint32_t hash;
+    TaskHandle_t leader;
+    void *result;
+    bool finished;                       // Result published; late arrivals start a new flight
+    uint32_t followers;                  // Followers that joined this flight
+    uint32_t pending;                    // Followers not yet done with the result
+    bool leader_waiting;                 // Leader is blocked on drained
+    SemaphoreHandle_t ready;             // Given once per follower when the result is published
+    SemaphoreHandle_t drained;           // Given by the last follower while the leader waits
+};
+
+struct single_flight {
+    SemaphoreHandle_t lock;
+    uint32_t runs;
+    uint32_t shared;
+    size_t max_flights;
+    single_flight_call_t flights[];
+};
+
+// FNV-1a, to skip most string comparisons
+static uint32_t hash_key(const char *key) {
+    uint32_t hash = 2166136261u;
+    while (*key) {
+        hash = (hash ^ (uint8_t)*key++) * 16777619u;
+    }
+    return hash;
+}
+
+esp_err_t single_flight_create(size_t max_flights, single_flight_t **sf) {
+    if (!sf || max_flights == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    single_flight_t *s = calloc(1, sizeof(*s) + max_flights * sizeof(s->flights[0]));
+    if (!s) {
+        return ESP_ERR_NO_MEM;
+    }
+    s->max_flights = max_flights;
+    s->lock = xSemaphoreCreateMutex();
+    bool ok = s->lock != NULL;
+    for (size_t i = 0; ok && i < max_flights; i++) {
+        // Any caller other than the leader can be a follower
+        s->flights[i].ready = xSemaphoreCreateCounting(UINT16_MAX, 0);
+        s->flights[i].drained = xSemaphoreCreateBinary();
+        ok = s->flights[i].ready && s->flights[i].drained;
+    }
+    if (!ok) {
+        single_flight_destroy(s);
+        return ESP_ERR_NO_MEM;
+    }
+
+    *sf = s;
+    return ESP_OK;
+}
+
+void single_flight_destroy(single_flight_t *sf) {
+    if (!sf) {
+        return;
+    }
+    for (size_t i = 0; i < sf->max_flights; i++) {
+        if (sf->flights[i].ready) {
+            vSemaphoreDelete(sf->flights[i].ready);
+        }
+        if (sf->flights[i].drained) {
+            vSemaphoreDelete(sf->flights[i].drained);
+        }
+    }
+    if (sf->lock) {
+        vSemaphoreDelete(sf->lock);
+    }
+    free(sf);
+}
+
+void* single_flight_do(single_flight_t *sf, const char *key, single_flight_fn_t fn, void *arg,
+                       single_flight_call_t **call) {
+    *call = NULL;
+    if (!sf || !key) {
+        return fn(arg);
+    }
+
+    uint32_t hash = hash_key(key);
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    single_flight_call_t *flight = NULL;
+    single_flight_call_t *free_slot = NULL;
+
+    xSemaphoreTake(sf->lock, portMAX_DELAY);
+    for (size_t i = 0; i < sf->max_flights; i++) {
+        single_flight_call_t *f = &sf->flights[i];
+        if (!f->key) {
+            if (!free_slot) {
+                free_slot = f;
+            }
+        } else if (!f->finished && f->leader != self && f->hash == hash && strcmp(f->key, key) == 0) {
+            // A handler repeating its own call runs it rather than waiting on itself
+            flight = f;
+            break;
+        }
+    }
+
+    if (flight) {
+        // Follow the flight in progress
+        flight->followers++;
+        flight->pending++;
+        sf->shared++;
+        xSemaphoreGive(sf->lock);
+
+        xSemaphoreTake(flight->ready, portMAX_DELAY);
+        *call = flight;
+        return flight->result;
+    }
+
+    sf->runs++;
+    if (!free_slot) {
+        // Every slot is busy; run without deduplication
+        xSemaphoreGive(sf->lock);
+        return fn(arg);
+    }
+
+    flight = free_slot;
+    flight->key = key;
+    flight->hash = hash;
+    flight->leader = self;
+    flight->result = NULL;
+    flight->finished = false;
+    flight->followers = 0;
+    flight->pending = 0;
+    flight->leader_waiting = false;
+    xSemaphoreGive(sf->lock);
+
+    void *result = fn(arg);
+
+    xSemaphoreTake(sf->lock, portMAX_DELAY);
+    flight->result = result;
+    flight->finished = true;
+    uint32_t followers = flight->followers;
+    xSemaphoreGive(sf->lock);
+
+    for (uint32_t i = 0; i < followers; i++) {
+        xSemaphoreGive(flight->ready);
+    }
+    *call = flight;
+    return result;
+}
+
+bool single_flight_done(single_flight_t *sf, single_flight_call_t *call) {
+    if (!call) {
+        return true;
+    }
+
+    if (call->leader != xTaskGetCurrentTaskHandle()) {
+        xSemaphoreTake(sf->lock, portMAX_DELAY);
+        bool wake_leader = --call->pending == 0 && call->leader_waiting;
+        xSemaphoreGive(sf->lock);
+        if (wake_leader) {
+            xSemaphoreGive(call->drained);
+        }
+        return false;
+    }
+
+    // Leader: the result may only be freed once every follower has used it
+    xSemaphoreTake(sf->lock, portMAX_DELAY);
+    call->leader_waiting = call->pending > 0;
+    bool wait = call->leader_waiting;
+    xSemaphoreGive(sf->lock);
+    if (wait) {
+        xSemaphoreTake(call->drained, portMAX_DELAY);
+    }
+
+    xSemaphoreTake(sf->lock, portMAX_DELAY);
+    call->key = NULL;
+    call->leader = NULL;
+    xSemaphoreGive(sf->lock);
+    return true;
+}
+
+void single_flight_get_counters(const single_flight_t *sf, uint32_t *runs, uint32_t *shared) {
+    *runs = sf ? sf->runs : 0;
+    *shared = sf ? sf->shared : 0;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file stack_profiler.c
+ * @brief Stack high-water profiler attributing stack depth to methods and tools
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_ESP_MCP_SERVER_STACK_PROFILER
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "stack_profiler.h"
+
+static const char *TAG = "MCP_STACK_PROF";
+
+// Value FreeRTOS fills new stacks with, scanned by uxTaskGetStackHighWaterMark
+#define STACK_FILL_BYTE 0xa5
+
+// Stack below the caller's frame that the repaint leaves alone, for memset's
+// own frame and for interrupt context saved on the task stack meanwhile
+#define STACK_REPAINT_MARGIN 512
+
+static struct {
+    portMUX_TYPE lock;
+    uint32_t min_free;
+    esp_mcp_stack_profile_entry_t entries[CONFIG_ESP_MCP_SERVER_STACK_PROFILER_ENTRIES];
+    size_t entry_count;
+} s_profiler = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+    .min_free = UINT32_MAX,
+};
+
+// Must be called with the lock held
+static int find_or_add_entry(const char *name, bool is_tool) {
+    for (size_t i = 0; i < s_profiler.entry_count; i++) {
+        if (s_profiler.entries[i].is_tool == is_tool &&
+            strncmp(s_profiler.entries[i].name, name, sizeof(s_profiler.entries[i].name) - 1) == 0) {
+            return (int)i;
+        }
+    }
+    if (s_profiler.entry_count >= CONFIG_ESP_MCP_SERVER_STACK_PROFILER_ENTRIES) {
+        return -1;
+    }
+
+    esp_mcp_stack_profile_entry_t *entry = &s_profiler.entries[s_profiler.entry_count];
+    memset(entry, 0, sizeof(*entry));
+    strncpy(entry->name, name, sizeof(entry->name) - 1);
+    entry->is_tool = is_tool;
+    entry->min_free_bytes = UINT32_MAX;
+    return (int)s_profiler.entry_count++;
+}
+
+static void record(const char *name, bool is_tool) {
+    // Bytes on ESP-IDF, where StackType_t is a byte
+    uint32_t free_bytes = uxTaskGetStackHighWaterMark(NULL);
+
+    portENTER_CRITICAL(&s_profiler.lock);
+    int idx = find_or_add_entry(name, is_tool);
+    if (idx >= 0) {
+        esp_mcp_stack_profile_entry_t *entry = &s_profiler.entries[idx];
+        entry->calls++;
+        if (free_bytes < entry->min_free_bytes) {
+            entry->min_free_bytes = free_bytes;
+        }
+    }
+    if (free_bytes < s_profiler.min_free) {
+        s_profiler.min_free = free_bytes;
+    }
+    portEXIT_CRITICAL(&s_profiler.lock);
+}
+
+void stack_profiler_init(void) {
+    portENTER_CRITICAL(&s_profiler.lock);
+    memset(s_profiler.entries, 0, sizeof(s_profiler.entries));
+    s_profiler.entry_count = 0;
+    s_profiler.min_free = UINT32_MAX;
+    portEXIT_CRITICAL(&s_profiler.lock);
+    ESP_LOGI(TAG, "Stack profiler enabled");
+}
+
+void __attribute__((noinline)) stack_profiler_request_begin(void) {
+    // Stacks grow down from the end of the block pxTaskGetStackStart points to
+    uint8_t *start = (uint8_t *)pxTaskGetStackStart(NULL);
+    uint8_t *limit = (uint8_t *)__builtin_frame_address(0) - STACK_REPAINT_MARGIN;
+    if (start && limit > start) {
+        memset(start, STACK_FILL_BYTE, limit - start);
+    }
+}
+
+void stack_profiler_request_end(const char *method) {
+    record(method ? method : "(invalid)", false);
+}
+
+void stack_profiler_tool_end(const char *tool) {
+    if (tool) {
+        record(tool, true);
+    }
+}
+
+uint32_t stack_profiler_min_free(void) {
+    return s_profiler.min_free == UINT32_MAX ? 0 : s_profiler.min_free;
+}
+
+size_t stack_profiler_snapshot(esp_mcp_stack_profile_entry_t *entries, size_t max_entries) {
+    portENTER_CRITICAL(&s_profiler.lock);
+    size_t count = s_profiler.entry_count < max_entries ? s_profiler.entry_count : max_entries;
+    memcpy(entries, s_profiler.entries, count * sizeof(entries[0]));
+    portEXIT_CRITICAL(&s_profiler.lock);
+    return count;
+}
+
+char* stack_profiler_render_json(void) {
+    esp_mcp_stack_profile_entry_t *entries = malloc(sizeof(s_profiler.entries));
+    if (!entries) {
+        return NULL;
+    }
+    size_t count = stack_profiler_snapshot(entries, CONFIG_ESP_MCP_SERVER_STACK_PROFILER_ENTRIES);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "minFreeBytes", stack_profiler_min_free());
+    cJSON *methods = cJSON_AddArrayToObject(root, "methods");
+    cJSON *tools = cJSON_AddArrayToObject(root, "tools");
+    for (size_t i = 0; i < count; i++) {
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", entries[i].name);
+        cJSON_AddNumberToObject(item, "calls", entries[i].calls);
+        cJSON_AddNumberToObject(item, "minFreeBytes", entries[i].min_free_bytes);
+        cJSON_AddItemToArray(entries[i].is_tool ? tools : methods, item);
+    }
+    free(entries);
+
+    char *text = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return text;
+}
+
+#endif // CONFIG_ESP_MCP_SERVER_STACK_PROFILER
@@ -0,0 +1,319 @@
+/**
+ * @file telemetry.c
+ * @brief Background telemetry sampler for the built-in system tool and resource
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_chip_info.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "telemetry.h"
+
+static const char *TAG = "MCP_TELEMETRY";
+
+#define TELEMETRY_TASK_STACK_SIZE   3072
+#define TELEMETRY_TASK_PRIORITY     (tskIDLE_PRIORITY + 1)
+#define TELEMETRY_TOP_TASKS         3
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+#define TELEMETRY_HAS_RUNTIME_STATS 1
+#else
+#define TELEMETRY_HAS_RUNTIME_STATS 0
+#endif
+
+// One captured sample, before rendering
+typedef struct {
+    uint32_t free_heap;
+    uint32_t min_free_heap;
+    size_t internal_free;
+    size_t internal_largest_block;
+    size_t dma_free;
+    size_t spiram_free;
+    int64_t uptime_ms;
+    UBaseType_t task_count;
+    esp_chip_info_t chip_info;
+    telemetry_server_counters_t counters;
+#if TELEMETRY_HAS_RUNTIME_STATS
+    struct {
+        char name[16];
+        uint32_t percent;
+    } top_tasks[TELEMETRY_TOP_TASKS];
+    size_t top_task_count;
+#endif
+} telemetry_sample_t;
+
+// Rendered text of one sample
+typedef struct {
+    char info[TELEMETRY_SYSTEM_INFO_LEN];
+    size_t info_len;
+    char status[TELEMETRY_SYSTEM_STATUS_LEN];
+    size_t status_len;
+} telemetry_snapshot_t;
+
+struct telemetry_sampler {
+    TaskHandle_t task;
+    TaskHandle_t stop_waiter;
+    SemaphoreHandle_t lock;              // Guards front swaps and reader copies
+    uint32_t interval_ms;
+    telemetry_counters_fn_t counters_fn;
+    void *arg;
+    volatile bool stop_requested;
+
+    telemetry_snapshot_t snapshots[2];   // Double buffer, snapshots[front] is published
+    uint8_t front;
+    bool ready;
+
+#if TELEMETRY_HAS_RUNTIME_STATS
+    TaskStatus_t *task_status;           // Scratch array reused across samples
+    UBaseType_t task_status_len;
+#endif
+};
+
+#if TELEMETRY_HAS_RUNTIME_STATS
+static void collect_task_stats(telemetry_sample_t *sample, TaskStatus_t **scratch, UBaseType_t *scratch_len) {
+    // Leave headroom for tasks created between the count and the snapshot
+    UBaseType_t wanted = sample->task_count + 4;
+    if (*scratch_len < wanted) {
+        TaskStatus_t *grown = realloc(*scratch, wanted * sizeof(TaskStatus_t));
+        if (!grown) {
+            return;
+        }
+        *scratch = grown;
+        *scratch_len = wanted;
+    }
+
+    uint32_t total_runtime = 0;
+    UBaseType_t n = uxTaskGetSystemState(*scratch, *scratch_len, &total_runtime);
+    total_runtime /= 100;
+    if (n == 0 || total_runtime == 0) {
+        return;
+    }
+
+    // Keep the busiest tasks, ordered by run time
+    for (UBaseType_t i = 0; i < n; i++) {
+        uint32_t percent = (*scratch)[i].ulRunTimeCounter / total_runtime;
+        size_t pos = sample->top_task_count;
+        while (pos > 0 && sample->top_tasks[pos - 1].percent < percent) {
+            pos--;
+        }
+        if (pos >= TELEMETRY_TOP_TASKS) {
+            continue;
+        }
+        size_t last = sample->top_task_count < TELEMETRY_TOP_TASKS ? sample->top_task_count : TELEMETRY_TOP_TASKS - 1;
+        memmove(&sample->top_tasks[pos + 1], &sample->top_tasks[pos], (last - pos) * sizeof(sample->top_tasks[0]));
+        strncpy(sample->top_tasks[pos].name, (*scratch)[i].pcTaskName, sizeof(sample->top_tasks[pos].name) - 1);
+        sample->top_tasks[pos].name[sizeof(sample->top_tasks[pos].name) - 1] = '\0';
+        sample->top_tasks[pos].percent = percent;
+        if (sample->top_task_count < TELEMETRY_TOP_TASKS) {
+            sample->top_task_count++;
+        }
+    }
+}
+#endif
+
+static void collect_sample(telemetry_sample_t *sample, telemetry_counters_fn_t counters_fn, void *arg) {
+    memset(sample, 0, sizeof(*sample));
+
+    sample->free_heap = esp_get_free_heap_size();
+    sample->min_free_heap = esp_get_minimum_free_heap_size();
+    sample->internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    sample->internal_largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    sample->dma_free = heap_caps_get_free_size(MALLOC_CAP_DMA);
+    sample->spiram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    sample->uptime_ms = esp_timer_get_time() / 1000;
+    sample->task_count = uxTaskGetNumberOfTasks();
+    esp_chip_info(&sample->chip_info);
+
+    if (counters_fn) {
+        counters_fn(&sample->counters, arg);
+    }
+}
+
+static size_t render_view(telemetry_view_t view, const telemetry_sample_t *sample, char *buf, size_t buf_len) {
+    if (!buf || buf_len == 0) {
+        return 0;
+    }
+
+    int len = 0;
+    if (view == TELEMETRY_VIEW_SYSTEM_INFO) {
+        len = snprintf(buf, buf_len,
+                "ESP32 System Information:\n"
+                "- Free heap: %" PRIu32 " bytes\n"
+                "- Minimum free heap: %" PRIu32 " bytes\n"
+                "- Uptime: %" PRId64 " ms\n"
+                "- IDF Version: %s\n",
+                sample->free_heap,
+                sample->min_free_heap,
+                sample->uptime_ms,
+                esp_get_idf_version());
+    } else {
+        len = snprintf(buf, buf_len,
+                "ESP32 System Status Report\n"
+                "==========================\n"
+                "Free Heap: %" PRIu32 " bytes\n"
+                "Min Free Heap: %" PRIu32 " bytes\n"
+                "Internal Free Heap: %u bytes (largest block %u)\n"
+                "DMA Free Heap: %u bytes\n"
+                "PSRAM Free Heap: %u bytes\n"
+                "Uptime: %" PRId64 " ms\n"
+                "IDF Version: %s\n"
+                "Active Sessions: %d\n"
+                "Open Sockets: %d\n"
+                "Total Requests: %" PRIu32 "\n"
+                "Failed Requests: %" PRIu32 "\n"
+                "Tasks: %u\n"
+                "Chip Model: %s\n"
+                "Chip Revision: %d\n",
+                sample->free_heap,
+                sample->min_free_heap,
+                (unsigned)sample->internal_free,
+                (unsigned)sample->internal_largest_block,
+                (unsigned)sample->dma_free,
+                (unsigned)sample->spiram_free,
+                sample->uptime_ms,
+                esp_get_idf_version(),
+                sample->counters.active_sessions,
+                sample->counters.open_sockets,
+                sample->counters.total_requests,
+                sample->counters.failed_requests,
+                (unsigned)sample->task_count,
+                CONFIG_IDF_TARGET,
+                sample->chip_info.revision);
+
+#if TELEMETRY_HAS_RUNTIME_STATS
+        for (size_t i = 0; i < sample->top_task_count && len > 0 && (size_t)len < buf_len; i++) {
+            len += snprintf(buf + len, buf_len - len, "Task %s: %" PRIu32 "%% CPU\n",
+                            sample->top_tasks[i].name, sample->top_tasks[i].percent);
+        }
+#endif
+    }
+
+    if (len < 0) {
+        buf[0] = '\0';
+        return 0;
+    }
+    return (size_t)len < buf_len ? (size_t)len : buf_len - 1;
+}
+
+static void sampler_task(void *arg) {
+    telemetry_sampler_t *sampler = (telemetry_sampler_t *)arg;
+    telemetry_sample_t sample;
+
+    while (!sampler->stop_requested) {
+        collect_sample(&sample, sampler->counters_fn, sampler->arg);
+#if TELEMETRY_HAS_RUNTIME_STATS
+        collect_task_stats(&sample, &sampler->task_status, &sampler->task_status_len);
+#endif
+
+        // Render into the back buffer; readers only ever touch the front one
+        telemetry_snapshot_t *back = &sampler->snapshots[sampler->front ^ 1];
+        back->info_len = render_view(TELEMETRY_VIEW_SYSTEM_INFO, &sample, back->info, sizeof(back->info));
+        back->status_len = render_view(TELEMETRY_VIEW_SYSTEM_STATUS, &sample, back->status, sizeof(back->status));
+
+        xSemaphoreTake(sampler->lock, portMAX_DELAY);
+        sampler->front ^= 1;
+        sampler->ready = true;
+        xSemaphoreGive(sampler->lock);
+
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sampler->interval_ms));
+    }
+
+    xTaskNotifyGive(sampler->stop_waiter);
+    vTaskDelete(NULL);
+}
+
+esp_err_t telemetry_sampler_start(uint32_t interval_ms, uint32_t stack_size,
+                                  telemetry_counters_fn_t counters_fn, void *arg,
+                                  telemetry_sampler_t **sampler) {
+    if (!sampler || interval_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    telemetry_sampler_t *s = calloc(1, sizeof(telemetry_sampler_t));
+    if (!s) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    s->interval_ms = interval_ms;
+    s->counters_fn = counters_fn;
+    s->arg = arg;
+    s->lock = xSemaphoreCreateMutex();
+    if (!s->lock) {
+        free(s);
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(sampler_task, "mcp_telemetry", stack_size ? stack_size : TELEMETRY_TASK_STACK_SIZE, s,
+                    TELEMETRY_TASK_PRIORITY, &s->task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create sampler task");
+        vSemaphoreDelete(s->lock);
+        free(s);
+        return ESP_ERR_NO_MEM;
+    }
+
+    *sampler = s;
+    ESP_LOGI(TAG, "Telemetry sampler started (interval %" PRIu32 " ms)", interval_ms);
+    return ESP_OK;
+}
+
+void telemetry_sampler_stop(telemetry_sampler_t *sampler) {
+    if (!sampler) {
+        return;
+    }
+
+    sampler->stop_waiter = xTaskGetCurrentTaskHandle();
+    sampler->stop_requested = true;
+    xTaskNotifyGive(sampler->task);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    vSemaphoreDelete(sampler->lock);
+#if TELEMETRY_HAS_RUNTIME_STATS
+    free(sampler->task_status);
+#endif
+    free(sampler);
+}
+
+size_t telemetry_sampler_copy(telemetry_sampler_t *sampler, telemetry_view_t view, char *buf, size_t buf_len) {
+    if (!sampler || !buf || buf_len == 0) {
+        return 0;
+    }
+
+    size_t len = 0;
+    xSemaphoreTake(sampler->lock, portMAX_DELAY);
+    if (sampler->ready) {
+        const telemetry_snapshot_t *front = &sampler->snapshots[sampler->front];
+        const char *src = view == TELEMETRY_VIEW_SYSTEM_INFO ? front->info : front->status;
+        len = view == TELEMETRY_VIEW_SYSTEM_INFO ? front->info_len : front->status_len;
+        if (len >= buf_len) {
+            len = buf_len - 1;
+        }
+        memcpy(buf, src, len);
+    }
+    xSemaphoreGive(sampler->lock);
+
+    buf[len] = '\0';
+    return len;
+}
+
+size_t telemetry_render_now(telemetry_view_t view, telemetry_counters_fn_t counters_fn, void *arg,
+                            char *buf, size_t buf_len) {
+    telemetry_sample_t sample;
+    collect_sample(&sample, counters_fn, arg);
+#if TELEMETRY_HAS_RUNTIME_STATS
+    if (view == TELEMETRY_VIEW_SYSTEM_STATUS) {
+        TaskStatus_t *scratch = NULL;
+        UBaseType_t scratch_len = 0;
+        collect_task_stats(&sample, &scratch, &scratch_len);
+        free(scratch);
+    }
+#endif
+    return render_view(view, &sample, buf, buf_len);
+}
@@ -0,0 +1,314 @@
+/**
+ * @file traffic_capture.c
+ * @brief Bounded capture of /mcp traffic and host-side replay of captures
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "alloc_profiler.h"
+#include "traffic_capture.h"
+
+static const char *TAG = "MCP_CAPTURE";
+
+// Longest record line: six numbers and their separators
+#define CAPTURE_LINE_MAX 96
+
+#if CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+
+// Record header, stored in the ring immediately before the (possibly truncated) body
+typedef struct {
+    uint32_t seq;
+    int64_t timestamp_us;                // Arrival time of the request
+    uint32_t duration_us;
+    uint32_t response_len;
+    uint32_t original_len;               // Length of the request body as received
+    uint32_t body_len;                   // Bytes of the body stored in the ring
+    int16_t status;                      // 0 while the request is still being processed
+} capture_record_t;
+
+struct traffic_capture {
+    SemaphoreHandle_t lock;
+    uint8_t *buf;
+    size_t size;
+    size_t head;                         // Next write position
+    size_t tail;                         // Position of the oldest record
+    size_t used;
+    size_t record_count;
+    uint32_t next_seq;
+};
+
+esp_err_t traffic_capture_create(size_t size, traffic_capture_t **capture) {
+    if (!capture || size < 4 * sizeof(capture_record_t)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    traffic_capture_t *c = calloc(1, sizeof(*c));
+    if (!c) {
+        return ESP_ERR_NO_MEM;
+    }
+    c->buf = malloc(size);
+    c->lock = xSemaphoreCreateMutex();
+    if (!c->buf || !c->lock) {
+        traffic_capture_destroy(c);
+        return ESP_ERR_NO_MEM;
+    }
+    c->size = size;
+
+    *capture = c;
+    return ESP_OK;
+}
+
+void traffic_capture_destroy(traffic_capture_t *capture) {
+    if (!capture) {
+        return;
+    }
+    if (capture->lock) {
+        vSemaphoreDelete(capture->lock);
+    }
+    free(capture->buf);
+    free(capture);
+}
+
+static size_t ring_write(traffic_capture_t *c, size_t pos, const void *data, size_t len) {
+    size_t first = c->size - pos < len ? c->size - pos : len;
+    memcpy(c->buf + pos, data, first);
+    memcpy(c->buf, (const uint8_t *)data + first, len - first);
+    return (pos + len) % c->size;
+}
+
+static size_t ring_read(const traffic_capture_t *c, size_t pos, void *data, size_t len) {
+    size_t first = c->size - pos < len ? c->size - pos : len;
+    memcpy(data, c->buf + pos, first);
+    memcpy((uint8_t *)data + first, c->buf, len - first);
+    return (pos + len) % c->size;
+}
+
+static void evict_oldest(traffic_capture_t *c) {
+    capture_record_t record;
+    ring_read(c, c->tail, &record, sizeof(record));
+    size_t record_size = sizeof(record) + record.body_len;
+    c->tail = (c->tail + record_size) % c->size;
+    c->used -= record_size;
+    c->record_count--;
+}
+
+uint32_t traffic_capture_begin(traffic_capture_t *capture, const char *body, size_t len) {
+    capture_record_t record = {
+        .timestamp_us = esp_timer_get_time(),
+        .original_len = len,
+        .body_len = len,
+    };
+
+    // Keep at least four records worth of history even with large bodies
+    size_t max_body = capture->size / 4 - sizeof(record);
+    if (record.body_len > max_body) {
+        record.body_len = max_body;
+    }
+    size_t record_size = sizeof(record) + record.body_len;
+
+    xSemaphoreTake(capture->lock, portMAX_DELAY);
+    while (capture->size - capture->used < record_size) {
+        evict_oldest(capture);
+    }
+    record.seq = capture->next_seq++;
+
+    capture->head = ring_write(capture, capture->head, &record, sizeof(record));
+    capture->head = ring_write(capture, capture->head, body, record.body_len);
+    capture->used += record_size;
+    capture->record_count++;
+    xSemaphoreGive(capture->lock);
+
+    return record.seq;
+}
+
+void traffic_capture_end(traffic_capture_t *capture, uint32_t seq, uint32_t duration_us, int status, size_t response_len) {
+    xSemaphoreTake(capture->lock, portMAX_DELAY);
+    // Walk from the oldest record; records of concurrent requests may follow this one
+    size_t pos = capture->tail;
+    for (size_t i = 0; i < capture->record_count; i++) {
+        capture_record_t record;
+        ring_read(capture, pos, &record, sizeof(record));
+        if (record.seq == seq) {
+            record.duration_us = duration_us;
+            record.status = status;
+            record.response_len = response_len;
+            ring_write(capture, pos, &record, sizeof(record));
+            break;
+        }
+        pos = (pos + sizeof(record) + record.body_len) % capture->size;
+    }
+    xSemaphoreGive(capture->lock);
+}
+
+// Must be called with the lock held
+static esp_err_t export_locked(traffic_capture_t *capture, traffic_capture_write_fn_t write, void *arg) {
+    esp_err_t ret = write(TRAFFIC_CAPTURE_HEADER, strlen(TRAFFIC_CAPTURE_HEADER), arg);
+
+    int64_t origin_us = -1;
+    size_t pos = capture->tail;
+    for (size_t i = 0; i < capture->record_count && ret == ESP_OK; i++) {
+        capture_record_t record;
+        size_t body_pos = ring_read(capture, pos, &record, sizeof(record));
+        pos = (body_pos + record.body_len) % capture->size;
+        if (record.status == 0) {
+            continue;
+        }
+        if (origin_us < 0) {
+            origin_us = record.timestamp_us;
+        }
+
+        char line[CAPTURE_LINE_MAX];
+        int line_len = snprintf(line, sizeof(line), "%" PRId64 " %" PRIu32 " %d %" PRIu32 " %" PRIu32 " %" PRIu32 "\n",
+                                record.timestamp_us - origin_us, record.duration_us, record.status,
+                                record.response_len, record.original_len, record.body_len);
+        ret = write(line, line_len, arg);
+
+        // The body may wrap around the end of the ring
+        size_t first = capture->size - body_pos < record.body_len ? capture->size - body_pos : record.body_len;
+        if (ret == ESP_OK && first > 0) {
+            ret = write((const char *)capture->buf + body_pos, first, arg);
+        }
+        if (ret == ESP_OK && record.body_len > first) {
+            ret = write((const char *)capture->buf, record.body_len - first, arg);
+        }
+        if (ret == ESP_OK) {
+            ret = write("\n", 1, arg);
+        }
+    }
+    return ret;
+}
+
+esp_err_t traffic_capture_export(traffic_capture_t *capture, traffic_capture_write_fn_t write, void *arg) {
+    if (!capture || !write) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(capture->lock, portMAX_DELAY);
+    esp_err_t ret = export_locked(capture, write, arg);
+    xSemaphoreGive(capture->lock);
+    return ret;
+}
+
+typedef struct {
+    char *buf;
+    size_t len;
+} render_buffer_t;
+
+static esp_err_t count_output(const char *data, size_t len, void *arg) {
+    ((render_buffer_t *)arg)->len += len;
+    return ESP_OK;
+}
+
+static esp_err_t append_output(const char *data, size_t len, void *arg) {
+    render_buffer_t *out = (render_buffer_t *)arg;
+    memcpy(out->buf + out->len, data, len);
+    out->len += len;
+    return ESP_OK;
+}
+
+char* traffic_capture_render(traffic_capture_t *capture) {
+    if (!capture) {
+        return NULL;
+    }
+
+    render_buffer_t out = { 0 };
+    xSemaphoreTake(capture->lock, portMAX_DELAY);
+    // Size the output first so that it is rendered in a single allocation
+    export_locked(capture, count_output, &out);
+    out.buf = MCP_MALLOC(out.len + 1);
+    if (out.buf) {
+        out.len = 0;
+        export_locked(capture, append_output, &out);
+        out.buf[out.len] = '\0';
+    }
+    xSemaphoreGive(capture->lock);
+    return out.buf;
+}
+
+#endif // CONFIG_ESP_MCP_SERVER_TRAFFIC_CAPTURE
+
+esp_err_t traffic_capture_replay(FILE *fp, bool realtime, traffic_replay_fn_t replay, void *arg,
+                                 esp_mcp_replay_stats_t *stats) {
+    if (!fp || !replay || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    char line[CAPTURE_LINE_MAX];
+    if (!fgets(line, sizeof(line), fp) || strcmp(line, TRAFFIC_CAPTURE_HEADER) != 0) {
+        ESP_LOGE(TAG, "Not a capture file");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    char *body = NULL;
+    size_t body_capacity = 0;
+    int64_t start_us = esp_timer_get_time();
+
+    while (fgets(line, sizeof(line), fp)) {
+        int64_t offset_us;
+        uint32_t duration_us, response_len, original_len, body_len;
+        int status;
+        if (sscanf(line, "%" SCNd64 " %" SCNu32 " %d %" SCNu32 " %" SCNu32 " %" SCNu32,
+                   &offset_us, &duration_us, &status, &response_len, &original_len, &body_len) != 6) {
+            ESP_LOGE(TAG, "Malformed capture record");
+            ret = ESP_ERR_INVALID_RESPONSE;
+            break;
+        }
+
+        if (body_len + 1 > body_capacity) {
+            char *new_body = realloc(body, body_len + 1);
+            if (!new_body) {
+                ret = ESP_ERR_NO_MEM;
+                break;
+            }
+            body = new_body;
+            body_capacity = body_len + 1;
+        }
+        // Body followed by its record separator
+        if (fread(body, 1, body_len, fp) != body_len || fgetc(fp) != '\n') {
+            ESP_LOGE(TAG, "Truncated capture record");
+            ret = ESP_ERR_INVALID_RESPONSE;
+            break;
+        }
+        body[body_len] = '\0';
+
+        if (body_len < original_len) {
+            stats->skipped++;
+            continue;
+        }
+
+        if (realtime) {
+            int64_t wait_us = start_us + offset_us - esp_timer_get_time();
+            if (wait_us > 0) {
+                vTaskDelay(pdMS_TO_TICKS(wait_us / 1000));
+            }
+        }
+
+        int replay_status = 0;
+        size_t replay_response_len = 0;
+        int64_t t0 = esp_timer_get_time();
+        replay(body, body_len, arg, &replay_status, &replay_response_len);
+        uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - t0);
+
+        stats->requests++;
+        stats->total_us += elapsed_us;
+        stats->captured_total_us += duration_us;
+        stats->response_bytes += replay_response_len;
+        if (elapsed_us > stats->max_us) {
+            stats->max_us = elapsed_us;
+        }
+        if (replay_status != status || replay_response_len != response_len) {
+            stats->mismatches++;
+        }
+    }
+
+    free(body);
+    return ret;
+}
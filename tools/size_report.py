@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""
+Footprint of the esp_mcp_server Kconfig options.
+
+Builds an example project once per configuration variant and reports, relative
+to the default configuration:
+
+  - flash and static RAM of the whole image and of libesp_mcp_server.a
+    (from `idf.py size` / `idf.py size-components`)
+  - heap allocated per request, when a traffic capture is given: the capture is
+    replayed on the linux target by examples/replay with the allocation profiler
+    enabled, and the bytes allocated by all methods are divided by the calls
+
+Usage (from an ESP-IDF environment):
+
+  python tools/size_report.py [--target esp32] [--capture capture.txt] [variant ...]
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+COMPONENT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SIZE_PROJECT = os.path.join(COMPONENT_DIR, 'examples', 'simple')
+REPLAY_PROJECT = os.path.join(COMPONENT_DIR, 'examples', 'replay')
+COMPONENT_ARCHIVE = 'libesp_mcp_server.a'
+
+ALL_FEATURES_OFF = [
+    'CONFIG_ESP_MCP_SERVER_BUILTINS=n',
+    'CONFIG_ESP_MCP_SERVER_SCHEMA_VALIDATION=n',
+    'CONFIG_ESP_MCP_SERVER_URI_TEMPLATES=n',
+    'CONFIG_ESP_MCP_SERVER_COMPLETIONS=n',
+    'CONFIG_ESP_MCP_SERVER_CORS=n',
+    'CONFIG_ESP_MCP_SERVER_VERBOSE_LOG=n',
+]
+
+STATIC_REGISTRY = [
+    'CONFIG_ESP_MCP_SERVER_STATIC_REGISTRY=y',
+    'CONFIG_ESP_MCP_SERVER_MAX_TOOLS=8',
+    'CONFIG_ESP_MCP_SERVER_MAX_RESOURCES=8',
+]
+
+# Variant name -> sdkconfig lines applied on top of the project's sdkconfig.defaults
+VARIANTS = {
+    'default': [],
+    'no_builtins': ['CONFIG_ESP_MCP_SERVER_BUILTINS=n'],
+    'no_schema_validation': ['CONFIG_ESP_MCP_SERVER_SCHEMA_VALIDATION=n'],
+    'no_uri_templates': ['CONFIG_ESP_MCP_SERVER_URI_TEMPLATES=n'],
+    'no_completions': ['CONFIG_ESP_MCP_SERVER_COMPLETIONS=n'],
+    'no_cors': ['CONFIG_ESP_MCP_SERVER_CORS=n'],
+    'no_verbose_log': ['CONFIG_ESP_MCP_SERVER_VERBOSE_LOG=n'],
+    'static_registry': STATIC_REGISTRY,
+    'minimal': ALL_FEATURES_OFF + STATIC_REGISTRY,
+}
+
+# Profiler lines printed by examples/replay
+PROFILE_LINE = re.compile(r'^rpc\s+\S+\s+calls=(\d+)\s+allocs=(\d+)\s+bytes=(\d+)\s+peak=(\d+)')
+
+
+def idf(project, build_dir, variant_lines, args, target=None):
+    os.makedirs(build_dir, exist_ok=True)
+    variant_file = os.path.join(build_dir, 'sdkconfig.variant')
+    with open(variant_file, 'w') as f:
+        f.write('\n'.join(variant_lines) + '\n')
+
+    defaults = [os.path.join(project, 'sdkconfig.defaults'), variant_file]
+    cmd = ['idf.py', '-C', project, '-B', build_dir,
+           '-D', 'SDKCONFIG=' + os.path.join(build_dir, 'sdkconfig'),
+           '-D', 'SDKCONFIG_DEFAULTS=' + ';'.join(d for d in defaults if os.path.exists(d))]
+    if target:
+        cmd += ['-D', 'IDF_TARGET=' + target]
+    cmd += args
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+    if result.returncode != 0:
+        sys.stderr.write(result.stderr or '')
+        raise RuntimeError('{} failed'.format(' '.join(cmd)))
+    return result.stdout
+
+
+def parse_json(output):
+    # idf.py may print progress lines before the JSON document
+    return json.loads(output[output.index('{'):])
+
+
+def flash_and_ram(sizes):
+    flash = sum(v for k, v in sizes.items() if k.startswith('flash') and isinstance(v, int))
+    ram = sum(v for k, v in sizes.items()
+              if re.match(r'^(dram|diram)_(data|bss)$', k) and isinstance(v, int))
+    return flash, ram
+
+
+def measure_image(name, target, work_dir):
+    build_dir = os.path.join(work_dir, target, name)
+    idf(SIZE_PROJECT, build_dir, VARIANTS[name], ['build'], target=target)
+
+    image = parse_json(idf(SIZE_PROJECT, build_dir, VARIANTS[name], ['size', '--format', 'json']))
+    components = parse_json(idf(SIZE_PROJECT, build_dir, VARIANTS[name], ['size-components', '--format', 'json']))
+    component = next((v for k, v in components.items() if k.endswith(COMPONENT_ARCHIVE)), {})
+
+    image_flash, image_ram = flash_and_ram(image)
+    component_flash, component_ram = flash_and_ram(component)
+    return {
+        'image_flash': image_flash,
+        'image_ram': image_ram,
+        'component_flash': component_flash,
+        'component_ram': component_ram,
+    }
+
+
+def measure_heap(name, capture, work_dir):
+    build_dir = os.path.join(work_dir, 'linux', name)
+    lines = VARIANTS[name] + ['CONFIG_ESP_MCP_SERVER_ALLOC_PROFILER=y']
+    idf(REPLAY_PROJECT, build_dir, lines, ['build'], target='linux')
+
+    elf = os.path.join(build_dir, 'mcp_example_replay.elf')
+    env = dict(os.environ, MCP_CAPTURE=os.path.abspath(capture))
+    output = subprocess.run([elf], stdout=subprocess.PIPE, env=env, universal_newlines=True, check=True).stdout
+
+    calls = total_bytes = peak = 0
+    for line in output.splitlines():
+        match = PROFILE_LINE.match(line)
+        if match:
+            calls += int(match.group(1))
+            total_bytes += int(match.group(3))
+            peak = max(peak, int(match.group(4)))
+    return {
+        'heap_per_request': total_bytes // calls if calls else 0,
+        'heap_peak': peak,
+    }
+
+
+def delta(value, base):
+    diff = value - base
+    return '{} ({:+d})'.format(value, diff) if diff else str(value)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('variants', nargs='*', metavar='variant',
+                        help='variants to measure (default: all): ' + ', '.join(VARIANTS))
+    parser.add_argument('--target', default='esp32', help='chip target for the size builds (default: esp32)')
+    parser.add_argument('--capture', help='traffic capture to replay for the per-request heap columns')
+    parser.add_argument('--work-dir', default=os.path.join(COMPONENT_DIR, 'build_size_report'),
+                        help='where the variant builds are kept (default: build_size_report)')
+    args = parser.parse_args()
+
+    unknown = [name for name in args.variants if name not in VARIANTS]
+    if unknown:
+        parser.error('unknown variant(s): ' + ', '.join(unknown))
+
+    names = args.variants or list(VARIANTS)
+    if 'default' not in names:
+        names.insert(0, 'default')
+
+    results = {}
+    for name in names:
+        sys.stderr.write('Measuring {}...\n'.format(name))
+        results[name] = measure_image(name, args.target, args.work_dir)
+        if args.capture:
+            results[name].update(measure_heap(name, args.capture, args.work_dir))
+
+    columns = [('image_flash', 'Image flash'), ('image_ram', 'Image static RAM'),
+               ('component_flash', 'Component flash'), ('component_ram', 'Component static RAM')]
+    if args.capture:
+        columns += [('heap_per_request', 'Heap / request'), ('heap_peak', 'Peak heap')]
+
+    base = results['default']
+    print('| Variant | ' + ' | '.join(title for _, title in columns) + ' |')
+    print('|---' * (len(columns) + 1) + '|')
+    for name in names:
+        cells = [delta(results[name][key], base[key]) for key, _ in columns]
+        print('| {} | {} |'.format(name, ' | '.join(cells)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())